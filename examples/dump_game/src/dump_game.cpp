@@ -15,7 +15,8 @@ int main(int argc, char** argv)
 {
     if (argc < 2)
     {
-        std::cerr << "Missing pid"
+        std::cerr << "Usage: " << argv[0]
+                  << " <pid> [--compress] [--threads <count>]"
                   << "\n";
         return error_code::INVALID_ARGS;
     }
@@ -24,77 +25,50 @@ int main(int argc, char** argv)
     {
         std::string game_pid(argv[1]);
 
-        const auto process = Asura::Process(std::stoi(game_pid));
-        const auto& mmap   = process.mmap();
+        Asura::MemoryDumper::Options options;
+        options.force_readable = true;
 
-        const std::string dump_folder = "./dumps/" + game_pid + "/";
-
-        if (!std::filesystem::create_directories(dump_folder))
-        {
-            throw Asura::Exception("Couldn't create directory at "
-                                   + dump_folder);
-        }
-
-        for (auto&& area : mmap.areas())
+        for (int i = 2; i < argc; i++)
         {
-            std::cout << std::hex << "[ 0x" << area->begin() << " - 0x"
-                      << area->end() << " ]"
-                      << " -> " << area->name() << "\n";
+            const std::string arg(argv[i]);
 
-            if (area->isDeniedByOS())
+            if (arg == "--compress")
             {
-                continue;
+                options.compress = true;
             }
-
-            std::stringstream ss;
-            ss << std::hex << area->begin() << "_" << area->end();
-
-            auto area_name = area->name();
-
-            for (auto&& c : area_name)
+            else if (arg == "--threads" and i + 1 < argc)
             {
-                if (c == '/')
-                {
-                    c = '_';
-                }
+                options.thread_count = std::stoul(argv[++i]);
             }
-
-            const auto file_name = dump_folder + area_name + "_"
-                                   + ss.str() + "_"
-                                   + std::to_string(area->protectionFlags()
-                                                      .cachedValue());
-
-            std::ofstream dump_file(file_name,
-                                    std::ios::binary | std::ios::out);
-
-            if (!dump_file.is_open())
+            else
             {
-                throw Asura::Exception("Could not open file" + file_name);
+                std::cerr << "Unknown argument: " << arg << "\n";
+                return error_code::INVALID_ARGS;
             }
+        }
 
-            const auto old_flags = area->protectionFlags().cachedValue();
+        auto process = Asura::Process(std::stoi(game_pid));
 
-            area->protectionFlags().change(
-              old_flags | Asura::MemoryArea::ProtectionFlags::READ);
+        const std::string dump_folder = "./dumps/" + game_pid + "/";
 
-            try
-            {
-                const auto read_area = area->read(area->size());
+        Asura::MemoryDumper dumper(process, options);
+        dumper.dump(dump_folder);
 
-                area->protectionFlags().change(old_flags);
+        for (auto&& entry : dumper.entries())
+        {
+            std::cout << std::hex << "[ 0x" << entry.address << " - 0x"
+                      << entry.address + entry.size << " ]"
+                      << " -> " << entry.name
+                      << (entry.dumped ? "" : " (failed)") << "\n";
+        }
 
-                dump_file.write(Asura::view_as<const char*>(
-                                  read_area.data()),
-                                read_area.size());
+        const auto& stats = dumper.stats();
 
-                dump_file.close();
-            }
-            catch (Asura::Exception& e)
-            {
-                std::cerr << e.msg() << "\n";
-                std::cerr << strerror(errno) << "\n";
-            }
-        }
+        std::cout << std::dec << "Dumped " << stats.total_bytes
+                  << " bytes (" << stats.written_bytes << " written, "
+                  << stats.zero_bytes << " zeroes) in "
+                  << stats.elapsed_ns / 1000000 << "ms to "
+                  << dump_folder << "\n";
     }
     catch (Asura::Exception& e)
     {
@@ -0,0 +1,618 @@
+#include "pch.h"
+
+#include "agent.h"
+#include "exception.h"
+
+using namespace Asura;
+
+/**
+ * The bootstrap opens the ring through /proc/<our pid>/fd/<fd>, maps it
+ * and calls the loop. The loop is also called directly by serve().
+ *
+ * .intel_syntax noprefix
+ * bootstrap:
+ *   and rsp, -16
+ *   lea rdi, [rip + params_path]
+ *   mov esi, 0x80002
+ *   xor edx, edx
+ *   mov eax, 2
+ *   syscall
+ *   test rax, rax
+ *   js .fail
+ *   mov r8, rax
+ *   xor edi, edi
+ *   mov rsi, [rip + params_size]
+ *   mov edx, 3
+ *   mov r10d, 1
+ *   xor r9d, r9d
+ *   mov eax, 9
+ *   syscall
+ *   mov r14, rax
+ *   mov rdi, r8
+ *   mov eax, 3
+ *   syscall
+ *   cmp r14, -4096
+ *   ja .fail
+ *   mov rdi, r14
+ *   call agent_loop
+ *   mov rdi, r14
+ *   mov rsi, [rip + params_size]
+ *   mov eax, 11
+ *   syscall
+ * .fail:
+ *   xor edi, edi
+ *   mov eax, 60
+ *   syscall
+ * agent_loop:
+ *   push rbx
+ *   push r12
+ *   push r13
+ *   push r14
+ *   push r15
+ *   mov rbx, rdi
+ *   mov r13d, [rbx + 132]
+ *   dec r13d
+ *   mov r12d, [rbx + 64]
+ *   mov dword ptr [rbx + 128], 1
+ * .check:
+ *   mov eax, [rbx]
+ *   cmp eax, r12d
+ *   jne .process
+ *   mov dword ptr [rbx + 136], 1
+ *   mfence
+ *   mov eax, [rbx]
+ *   cmp eax, r12d
+ *   jne .awake
+ *   mov rdi, rbx
+ *   xor esi, esi
+ *   mov edx, r12d
+ *   xor r10d, r10d
+ *   mov eax, 202
+ *   syscall
+ * .awake:
+ *   mov dword ptr [rbx + 136], 0
+ *   jmp .check
+ * .process:
+ *   mov eax, r12d
+ *   and eax, r13d
+ *   imul rax, rax, 80
+ *   lea r14, [rbx + rax + 192]
+ *   mov rax, [r14]
+ *   cmp rax, 2
+ *   je .exit
+ *   mov rdi, [r14 + 16]
+ *   mov rsi, [r14 + 24]
+ *   mov rdx, [r14 + 32]
+ *   mov r8, [r14 + 48]
+ *   mov r9, [r14 + 56]
+ *   cmp rax, 1
+ *   je .call
+ *   mov r10, [r14 + 40]
+ *   mov rax, [r14 + 8]
+ *   syscall
+ *   jmp .done
+ * .call:
+ *   mov rcx, [r14 + 40]
+ *   xor eax, eax
+ *   call qword ptr [r14 + 8]
+ * .done:
+ *   mov [r14 + 64], rax
+ *   inc r12d
+ *   mov [rbx + 64], r12d
+ *   mfence
+ *   cmp dword ptr [rbx + 140], 0
+ *   je .check
+ *   lea rdi, [rbx + 64]
+ *   mov esi, 1
+ *   mov edx, 0x7fffffff
+ *   mov eax, 202
+ *   syscall
+ *   jmp .check
+ * .exit:
+ *   mov qword ptr [r14 + 64], 0
+ *   inc r12d
+ *   mov [rbx + 64], r12d
+ *   mov dword ptr [rbx + 128], 2
+ *   lea rdi, [rbx + 64]
+ *   mov esi, 1
+ *   mov edx, 0x7fffffff
+ *   mov eax, 202
+ *   syscall
+ *   pop r15
+ *   pop r14
+ *   pop r13
+ *   pop r12
+ *   pop rbx
+ *   ret
+ * .balign 8
+ * params_size:
+ *   .quad 0
+ * params_path:
+ *   .zero 64
+ */
+static constexpr byte_t stub_code[] {
+    0x48, 0x83, 0xe4, 0xf0, 0x48, 0x8d, 0x3d, 0x8d,
+    0x01, 0x00, 0x00, 0xbe, 0x02, 0x00, 0x08, 0x00,
+    0x31, 0xd2, 0xb8, 0x02, 0x00, 0x00, 0x00, 0x0f,
+    0x05, 0x48, 0x85, 0xc0, 0x78, 0x50, 0x49, 0x89,
+    0xc0, 0x31, 0xff, 0x48, 0x8b, 0x35, 0x66, 0x01,
+    0x00, 0x00, 0xba, 0x03, 0x00, 0x00, 0x00, 0x41,
+    0xba, 0x01, 0x00, 0x00, 0x00, 0x45, 0x31, 0xc9,
+    0xb8, 0x09, 0x00, 0x00, 0x00, 0x0f, 0x05, 0x49,
+    0x89, 0xc6, 0x4c, 0x89, 0xc7, 0xb8, 0x03, 0x00,
+    0x00, 0x00, 0x0f, 0x05, 0x49, 0x81, 0xfe, 0x00,
+    0xf0, 0xff, 0xff, 0x77, 0x19, 0x4c, 0x89, 0xf7,
+    0xe8, 0x1a, 0x00, 0x00, 0x00, 0x4c, 0x89, 0xf7,
+    0x48, 0x8b, 0x35, 0x29, 0x01, 0x00, 0x00, 0xb8,
+    0x0b, 0x00, 0x00, 0x00, 0x0f, 0x05, 0x31, 0xff,
+    0xb8, 0x3c, 0x00, 0x00, 0x00, 0x0f, 0x05, 0x53,
+    0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57,
+    0x48, 0x89, 0xfb, 0x44, 0x8b, 0xab, 0x84, 0x00,
+    0x00, 0x00, 0x41, 0xff, 0xcd, 0x44, 0x8b, 0x63,
+    0x40, 0xc7, 0x83, 0x80, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x8b, 0x03, 0x44, 0x39, 0xe0,
+    0x75, 0x32, 0xc7, 0x83, 0x88, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x0f, 0xae, 0xf0, 0x8b,
+    0x03, 0x44, 0x39, 0xe0, 0x75, 0x12, 0x48, 0x89,
+    0xdf, 0x31, 0xf6, 0x44, 0x89, 0xe2, 0x45, 0x31,
+    0xd2, 0xb8, 0xca, 0x00, 0x00, 0x00, 0x0f, 0x05,
+    0xc7, 0x83, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0xeb, 0xc7, 0x44, 0x89, 0xe0, 0x44,
+    0x21, 0xe8, 0x48, 0x6b, 0xc0, 0x50, 0x4c, 0x8d,
+    0xb4, 0x03, 0xc0, 0x00, 0x00, 0x00, 0x49, 0x8b,
+    0x06, 0x48, 0x83, 0xf8, 0x02, 0x74, 0x65, 0x49,
+    0x8b, 0x7e, 0x10, 0x49, 0x8b, 0x76, 0x18, 0x49,
+    0x8b, 0x56, 0x20, 0x4d, 0x8b, 0x46, 0x30, 0x4d,
+    0x8b, 0x4e, 0x38, 0x48, 0x83, 0xf8, 0x01, 0x74,
+    0x0c, 0x4d, 0x8b, 0x56, 0x28, 0x49, 0x8b, 0x46,
+    0x08, 0x0f, 0x05, 0xeb, 0x0a, 0x49, 0x8b, 0x4e,
+    0x28, 0x31, 0xc0, 0x41, 0xff, 0x56, 0x08, 0x49,
+    0x89, 0x46, 0x40, 0x41, 0xff, 0xc4, 0x44, 0x89,
+    0x63, 0x40, 0x0f, 0xae, 0xf0, 0x83, 0xbb, 0x8c,
+    0x00, 0x00, 0x00, 0x00, 0x0f, 0x84, 0x61, 0xff,
+    0xff, 0xff, 0x48, 0x8d, 0x7b, 0x40, 0xbe, 0x01,
+    0x00, 0x00, 0x00, 0xba, 0xff, 0xff, 0xff, 0x7f,
+    0xb8, 0xca, 0x00, 0x00, 0x00, 0x0f, 0x05, 0xe9,
+    0x47, 0xff, 0xff, 0xff, 0x49, 0xc7, 0x46, 0x40,
+    0x00, 0x00, 0x00, 0x00, 0x41, 0xff, 0xc4, 0x44,
+    0x89, 0x63, 0x40, 0xc7, 0x83, 0x80, 0x00, 0x00,
+    0x00, 0x02, 0x00, 0x00, 0x00, 0x48, 0x8d, 0x7b,
+    0x40, 0xbe, 0x01, 0x00, 0x00, 0x00, 0xba, 0xff,
+    0xff, 0xff, 0x7f, 0xb8, 0xca, 0x00, 0x00, 0x00,
+    0x0f, 0x05, 0x41, 0x5f, 0x41, 0x5e, 0x41, 0x5d,
+    0x41, 0x5c, 0x5b, 0xc3, 0x0f, 0x1f, 0x40, 0x00,
+};
+
+auto Agent::IsSyscallError(const std::uint64_t result) -> bool
+{
+    return result > view_as<std::uint64_t>(-4096);
+}
+
+Agent::Agent(const std::size_t capacity)
+{
+#if defined(WINDOWS) or not defined(__x86_64__)
+    static_cast<void>(capacity);
+    ASURA_EXCEPTION("Agent isn't supported on this platform");
+#else
+    if (capacity == 0 or (capacity & (capacity - 1)) != 0)
+    {
+        ASURA_EXCEPTION("Capacity must be a power of two: "
+                        + std::to_string(capacity));
+    }
+
+    _ring_size = MemoryUtils::AlignToPageSize(
+      sizeof(RingHeader) + capacity * sizeof(Command),
+      MemoryUtils::GetPageSize());
+
+    _fd = memfd_create("asura_agent", MFD_CLOEXEC);
+
+    if (_fd < 0)
+    {
+        ASURA_EXCEPTION("memfd_create failed with: "
+                        + std::to_string(errno));
+    }
+
+    if (ftruncate(_fd, view_as<off_t>(_ring_size)) < 0)
+    {
+        releaseRing();
+        ASURA_EXCEPTION("ftruncate failed with size: "
+                        + std::to_string(_ring_size));
+    }
+
+    const auto ring = mmap(nullptr,
+                           _ring_size,
+                           PROT_READ | PROT_WRITE,
+                           MAP_SHARED,
+                           _fd,
+                           0);
+
+    if (ring == MAP_FAILED)
+    {
+        releaseRing();
+        ASURA_EXCEPTION("mmap failed with size: "
+                        + std::to_string(_ring_size));
+    }
+
+    /* Zeroed by ftruncate */
+    _ring           = view_as<RingHeader*>(ring);
+    _ring->capacity = view_as<std::uint32_t>(capacity);
+#endif
+}
+
+Agent::~Agent()
+{
+    try
+    {
+        stop();
+    }
+    catch (Exception&)
+    {
+    }
+
+    releaseRing();
+}
+
+auto Agent::state() const -> State
+{
+    return _ring->state.load(std::memory_order_acquire);
+}
+
+auto Agent::capacity() const -> std::size_t
+{
+    return _ring->capacity;
+}
+
+auto Agent::inject(Process& process) -> void
+{
+    if (state() != State::Starting or _process_id != Process::INVALID_PID)
+    {
+        ASURA_EXCEPTION("Agent was already started");
+    }
+
+    static_assert(sizeof(stub_code) == STUB_PARAMS_OFFSET);
+
+    bytes_t stub(STUB_SIZE);
+    std::copy(std::begin(stub_code),
+              std::end(stub_code),
+              stub.begin());
+
+    const std::uint64_t ring_size = _ring_size;
+    std::memcpy(stub.data() + STUB_PARAMS_OFFSET,
+                &ring_size,
+                sizeof(ring_size));
+
+    /* Our memfd, as seen from the target */
+    const auto path = "/proc/" + std::to_string(getpid()) + "/fd/"
+                      + std::to_string(_fd);
+
+    if (path.size() >= STUB_PATH_SIZE)
+    {
+        ASURA_EXCEPTION("Path too long for the stub: " + path);
+    }
+
+    std::copy(path.begin(), path.end(), stub.begin() + STUB_PATH_OFFSET);
+
+    _stub       = process.allocArea(nullptr,
+                                    stub.size(),
+                                    MemoryArea::ProtectionFlags::RW);
+    _process_id = process.id();
+
+    try
+    {
+        process.write(_stub, stub);
+        process.protectMemoryArea(_stub,
+                                  stub.size(),
+                                  MemoryArea::ProtectionFlags::RX);
+
+        _task.emplace(process, _stub);
+        _task->run<true>();
+    }
+    catch (...)
+    {
+        releaseInjected();
+        throw;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now()
+                          + START_TIMEOUT;
+
+    while (state() == State::Starting)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            _task->kill();
+            releaseInjected();
+
+            ASURA_EXCEPTION("Agent did not start in process "
+                            + std::to_string(process.id()));
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+auto Agent::serve() -> void
+{
+#if not defined(WINDOWS) and defined(__x86_64__)
+    const auto page_size = MemoryUtils::GetPageSize();
+
+    const auto code = mmap(nullptr,
+                           page_size,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1,
+                           0);
+
+    if (code == MAP_FAILED)
+    {
+        ASURA_EXCEPTION("Could not map the agent code");
+    }
+
+    std::copy(std::begin(stub_code),
+              std::end(stub_code),
+              view_as<byte_t*>(code));
+
+    if (mprotect(code, page_size, PROT_READ | PROT_EXEC) < 0)
+    {
+        munmap(code, page_size);
+        ASURA_EXCEPTION("Could not make the agent code executable");
+    }
+
+    view_as<void (*)(RingHeader*)>(view_as<byte_t*>(code)
+                                   + STUB_LOOP_OFFSET)(_ring);
+
+    munmap(code, page_size);
+#endif
+}
+
+auto Agent::stop() -> void
+{
+    if (_ring == nullptr)
+    {
+        return;
+    }
+
+    if (state() == State::Running)
+    {
+        result(push(Operation::Exit, 0, {}));
+    }
+
+    if (_task)
+    {
+        /* The bootstrap exits right after the loop */
+        _task->wait();
+        releaseInjected();
+    }
+}
+
+auto Agent::pushSyscall(const std::uint64_t number, const args_t& args)
+  -> ticket_t
+{
+    return push(Operation::Syscall, number, args);
+}
+
+auto Agent::pushCall(const std::uintptr_t function, const args_t& args)
+  -> ticket_t
+{
+    return push(Operation::Call, function, args);
+}
+
+auto Agent::allocArea(const std::uintptr_t address,
+                      const std::size_t size,
+                      const mapf_t flags) -> ticket_t
+{
+#ifndef WINDOWS
+    return pushSyscall(
+      SYS_mmap,
+      { address,
+        size,
+        view_as<std::uint64_t>(MemoryArea::ProtectionFlags::ToOS(flags)),
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        view_as<std::uint64_t>(-1),
+        0 });
+#else
+    static_cast<void>(address);
+    static_cast<void>(size);
+    static_cast<void>(flags);
+    ASURA_EXCEPTION("Agent isn't supported on this platform");
+#endif
+}
+
+auto Agent::protectMemoryArea(const std::uintptr_t address,
+                              const std::size_t size,
+                              const mapf_t flags) -> ticket_t
+{
+#ifndef WINDOWS
+    return pushSyscall(
+      SYS_mprotect,
+      { address,
+        size,
+        view_as<std::uint64_t>(MemoryArea::ProtectionFlags::ToOS(flags)),
+        0,
+        0,
+        0 });
+#else
+    static_cast<void>(address);
+    static_cast<void>(size);
+    static_cast<void>(flags);
+    ASURA_EXCEPTION("Agent isn't supported on this platform");
+#endif
+}
+
+auto Agent::freeArea(const std::uintptr_t address, const std::size_t size)
+  -> ticket_t
+{
+#ifndef WINDOWS
+    return pushSyscall(SYS_munmap, { address, size, 0, 0, 0, 0 });
+#else
+    static_cast<void>(address);
+    static_cast<void>(size);
+    ASURA_EXCEPTION("Agent isn't supported on this platform");
+#endif
+}
+
+auto Agent::commit() -> void
+{
+    if (_ring->submitted.load(std::memory_order_relaxed) == _tail)
+    {
+        return;
+    }
+
+    _ring->submitted.store(_tail, std::memory_order_seq_cst);
+
+    /* Pairs with the fence of the agent before it goes to sleep */
+    if (_ring->agent_waiting.load(std::memory_order_seq_cst))
+    {
+        FutexWake(_ring->submitted);
+    }
+}
+
+auto Agent::result(const ticket_t ticket) -> std::uint64_t
+{
+    if (view_as<ticket_t>(_tail - ticket) - 1 >= _ring->capacity)
+    {
+        ASURA_EXCEPTION("Result of ticket " + std::to_string(ticket)
+                        + " isn't available anymore");
+    }
+
+    commit();
+    waitCompleted(ticket + 1);
+
+    return commands()[ticket & (_ring->capacity - 1)].result;
+}
+
+auto Agent::push(const Operation operation,
+                 const std::uint64_t target,
+                 const args_t& args) -> ticket_t
+{
+    if (state() == State::Exited)
+    {
+        ASURA_EXCEPTION("Agent has exited");
+    }
+
+    /* Full, the oldest slot must be done before reusing it */
+    if (_tail - _ring->completed.load(std::memory_order_acquire)
+        == _ring->capacity)
+    {
+        commit();
+        waitCompleted(_tail - _ring->capacity + 1);
+    }
+
+    const auto ticket = _tail;
+
+    commands()[ticket & (_ring->capacity - 1)] = { .operation = operation,
+                                                   .target    = target,
+                                                   .args      = args,
+                                                   .result    = 0,
+                                                   .reserved  = 0 };
+
+    _tail++;
+
+    return ticket;
+}
+
+auto Agent::waitCompleted(const ticket_t count) -> void
+{
+    const auto done = [&](const std::uint32_t completed)
+    {
+        return view_as<std::int32_t>(completed - count) >= 0;
+    };
+
+    for (std::size_t spin = 0; spin < SPIN_COUNT; spin++)
+    {
+        if (done(_ring->completed.load(std::memory_order_acquire)))
+        {
+            return;
+        }
+    }
+
+    while (true)
+    {
+        _ring->client_waiting.store(1, std::memory_order_seq_cst);
+
+        const auto completed = _ring->completed.load(
+          std::memory_order_seq_cst);
+
+        if (done(completed))
+        {
+            break;
+        }
+
+        if (_process_id != Process::INVALID_PID
+            and kill(_process_id, 0) < 0)
+        {
+            _ring->client_waiting.store(0, std::memory_order_relaxed);
+
+            ASURA_EXCEPTION("Process " + std::to_string(_process_id)
+                            + " of the agent is gone");
+        }
+
+        FutexWait(_ring->completed, completed);
+    }
+
+    _ring->client_waiting.store(0, std::memory_order_relaxed);
+}
+
+auto Agent::commands() const -> Command*
+{
+    return view_as<Command*>(view_as<byte_t*>(_ring)
+                             + sizeof(RingHeader));
+}
+
+auto Agent::releaseInjected() -> void
+{
+    if (_task)
+    {
+        _task->freeStack();
+        _task.reset();
+    }
+
+    if (_stub)
+    {
+        MemoryUtils::FreeArea(_process_id, _stub, STUB_SIZE);
+        _stub = nullptr;
+    }
+
+    _process_id = Process::INVALID_PID;
+}
+
+auto Agent::releaseRing() -> void
+{
+#ifndef WINDOWS
+    if (_ring)
+    {
+        munmap(_ring, _ring_size);
+        _ring = nullptr;
+    }
+
+    if (_fd >= 0)
+    {
+        close(_fd);
+        _fd = -1;
+    }
+#endif
+}
+
+auto Agent::FutexWait(std::atomic<std::uint32_t>& word,
+                      const std::uint32_t value) -> void
+{
+#ifndef WINDOWS
+    /* Bounded, so we notice when the target dies */
+    const timespec timeout { .tv_sec = 0, .tv_nsec = 100'000'000 };
+
+    /* Shared between processes, so not FUTEX_PRIVATE_FLAG */
+    syscall(SYS_futex, &word, FUTEX_WAIT, value, &timeout, nullptr, 0);
+#else
+    static_cast<void>(word);
+    static_cast<void>(value);
+#endif
+}
+
+auto Agent::FutexWake(std::atomic<std::uint32_t>& word) -> void
+{
+#ifndef WINDOWS
+    syscall(SYS_futex, &word, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    static_cast<void>(word);
+#endif
+}
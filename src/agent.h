@@ -0,0 +1,168 @@
+#ifndef ASURA_AGENT_H
+#define ASURA_AGENT_H
+
+#include "process.h"
+
+namespace Asura
+{
+    /**
+     * Small stub living inside a target process, executing the commands
+     * we push into a ring shared with it.
+     * Memory operations (mmap, mprotect, munmap, ...) and function calls
+     * are batched: the agent only sleeps when the ring is empty, and we
+     * only wake it up when it sleeps, so a bunch of commands costs no
+     * syscall on our side besides one wake up and one wait.
+     * Commands are pushed from one thread only.
+     * Linux x86-64 only for now.
+     */
+    class Agent
+    {
+      public:
+        enum class Operation : std::uint64_t
+        {
+            Syscall,
+            Call,
+            Exit
+        };
+
+        enum class State : std::uint32_t
+        {
+            Starting,
+            Running,
+            Exited
+        };
+
+        using ticket_t = std::uint32_t;
+        using args_t   = std::array<std::uint64_t, 6>;
+
+        /* Shared with the stub, layout must not change */
+        struct Command
+        {
+            Operation operation;
+            /* Syscall number or function address */
+            std::uint64_t target;
+            args_t args;
+            std::uint64_t result;
+            std::uint64_t reserved;
+        };
+
+        static_assert(sizeof(Command) == 80);
+
+        static constexpr inline std::size_t DEFAULT_CAPACITY = 0x100;
+        static constexpr inline std::size_t STACK_SIZE       = 0x10000;
+        /* Spins before sleeping when waiting for a result */
+        static constexpr inline std::size_t SPIN_COUNT = 0x400;
+        static constexpr inline std::chrono::seconds START_TIMEOUT {
+            5
+        };
+
+      private:
+        /* Shared with the stub, layout must not change */
+        struct RingHeader
+        {
+            alignas(64) std::atomic<std::uint32_t> submitted;
+            alignas(64) std::atomic<std::uint32_t> completed;
+            alignas(64) std::atomic<State> state;
+            std::uint32_t capacity;
+            std::atomic<std::uint32_t> agent_waiting;
+            std::atomic<std::uint32_t> client_waiting;
+        };
+
+        static_assert(sizeof(RingHeader) == 192);
+
+        /* See the stub source in agent.cpp */
+        static constexpr inline std::size_t STUB_LOOP_OFFSET   = 0x77;
+        static constexpr inline std::size_t STUB_PARAMS_OFFSET = 0x190;
+        static constexpr inline std::size_t STUB_PATH_OFFSET   = 0x198;
+        static constexpr inline std::size_t STUB_PATH_SIZE     = 0x40;
+        static constexpr inline std::size_t STUB_SIZE = STUB_PATH_OFFSET
+                                                        + STUB_PATH_SIZE;
+
+      public:
+        /* Raw syscalls return -errno on failure */
+        static auto IsSyscallError(const std::uint64_t result) -> bool;
+
+      public:
+        explicit Agent(const std::size_t capacity = DEFAULT_CAPACITY);
+        ~Agent();
+
+        Agent(const Agent&)                    = delete;
+        auto operator=(const Agent&) -> Agent& = delete;
+
+      public:
+        auto state() const -> State;
+        auto capacity() const -> std::size_t;
+
+      public:
+        /**
+         * Writes the stub inside the process and starts it in a new
+         * task, returns once it is polling the ring.
+         */
+        auto inject(Process& process) -> void;
+
+        /**
+         * Runs the agent on the calling thread until stop() is called,
+         * used when the target is our own child.
+         */
+        auto serve() -> void;
+
+        /**
+         * Makes the agent exit, then frees what inject() allocated.
+         */
+        auto stop() -> void;
+
+      public:
+        /**
+         * Commands are only seen by the agent once committed.
+         * When the ring is full, waits for the agent to make room.
+         */
+        auto pushSyscall(const std::uint64_t number,
+                         const args_t& args = {}) -> ticket_t;
+        auto pushCall(const std::uintptr_t function,
+                      const args_t& args = {}) -> ticket_t;
+
+        auto allocArea(const std::uintptr_t address,
+                       const std::size_t size,
+                       const mapf_t flags) -> ticket_t;
+        auto protectMemoryArea(const std::uintptr_t address,
+                               const std::size_t size,
+                               const mapf_t flags) -> ticket_t;
+        auto freeArea(const std::uintptr_t address,
+                      const std::size_t size) -> ticket_t;
+
+        auto commit() -> void;
+
+        /**
+         * Commits and waits for the command to be done.
+         * Syscalls return -errno on failure, like the raw syscall.
+         * Must be called before capacity() more commands are pushed,
+         * after that the slot is reused.
+         */
+        auto result(const ticket_t ticket) -> std::uint64_t;
+
+      private:
+        auto push(const Operation operation,
+                  const std::uint64_t target,
+                  const args_t& args) -> ticket_t;
+        auto waitCompleted(const ticket_t count) -> void;
+        auto commands() const -> Command*;
+        auto releaseInjected() -> void;
+        auto releaseRing() -> void;
+
+        static auto FutexWait(std::atomic<std::uint32_t>& word,
+                              const std::uint32_t value) -> void;
+        static auto FutexWake(std::atomic<std::uint32_t>& word) -> void;
+
+      private:
+        int _fd { -1 };
+        std::size_t _ring_size {};
+        RingHeader* _ring {};
+        /* Pushed, but maybe not yet committed */
+        ticket_t _tail {};
+        process_id_t _process_id { Process::INVALID_PID };
+        ptr_t _stub {};
+        std::optional<RunnableTask<STACK_SIZE>> _task;
+    };
+}
+
+#endif
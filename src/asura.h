@@ -3,34 +3,54 @@
 
 #include "pch.h"
 
+#include "agent.h"
 #include "bits.h"
 #include "buffer.h"
 #include "builtins.h"
 #include "circularbuffer.h"
 #include "custom_linux_syscalls.h"
+#include "decoderx86.h"
 #include "detourx86.h"
 #include "exception.h"
+#include "hookbatch.h"
 #include "kokabiel.h"
+#include "lockfreequeue.h"
+#include "mappedfile.h"
 #include "memoryarea.h"
+#include "memoryareatable.h"
+#include "memorydumper.h"
 #include "memorymap.h"
 #include "memoryutils.h"
+#include "moduleindex.h"
 #include "networkreadbuffer.h"
 #include "networkwritebuffer.h"
 #include "offset.h"
 #include "osutils.h"
+#include "pageresidency.h"
+#include "pageruns.h"
+#include "patchset.h"
 #include "patternbyte.h"
 #include "patternscanning.h"
 #include "process.h"
 #include "processbase.h"
+#include "processindex.h"
 #include "processmemoryarea.h"
 #include "processmemorymap.h"
 #include "readbuffer.h"
+#include "remotesymbolresolver.h"
 #include "runnabletask.h"
+#include "sharedcircularbuffer.h"
+#include "sharedregion.h"
 #include "simd.h"
+#include "snapshot.h"
+#include "symbolcache.h"
+#include "symbolresolver.h"
+#include "symboltable.h"
 #include "task.h"
 #include "timer.h"
 #include "types.h"
 #include "virtualtabletools.h"
+#include "watchlist.h"
 #include "writebuffer.h"
 #include "xkc.h"
 
@@ -0,0 +1,765 @@
+#include "pch.h"
+
+#include "decoderx86.h"
+
+#include "exception.h"
+
+using namespace Asura;
+
+/**
+ * Attributes of an opcode, the first four bits being the kind of
+ * immediate that follows the ModRM/SIB/displacement.
+ */
+static constexpr std::uint16_t IMM_NONE = 0;
+/* imm8 */
+static constexpr std::uint16_t IMM_B = 1;
+/* imm16 */
+static constexpr std::uint16_t IMM_W = 2;
+/* imm16 or imm32, depending on the operand size */
+static constexpr std::uint16_t IMM_Z = 3;
+/* imm16, imm32 or imm64 with REX.W */
+static constexpr std::uint16_t IMM_V = 4;
+/* imm16 then imm8 (enter) */
+static constexpr std::uint16_t IMM_WB = 5;
+/* Far pointer, imm16/imm32 then the segment */
+static constexpr std::uint16_t IMM_P = 6;
+/* Memory offset, depending on the address size */
+static constexpr std::uint16_t IMM_O = 7;
+/* Like IMM_Z, but always 32 bits in 64 bits (branches) */
+static constexpr std::uint16_t IMM_J = 8;
+/* imm32 */
+static constexpr std::uint16_t IMM_D = 9;
+
+static constexpr std::uint16_t IMM_MASK  = 0xF;
+static constexpr std::uint16_t MODRM     = (1u << 4u);
+static constexpr std::uint16_t RELATIVE  = (1u << 5u);
+static constexpr std::uint16_t INVALID   = (1u << 6u);
+static constexpr std::uint16_t INVALID64 = (1u << 7u);
+static constexpr std::uint16_t PREFIX    = (1u << 8u);
+static constexpr std::uint16_t REX       = (1u << 9u);
+/* 0x0F, VEX, EVEX, XOP */
+static constexpr std::uint16_t ESCAPE = (1u << 10u);
+/* The ModRM changes the rest of the instruction */
+static constexpr std::uint16_t GROUP = (1u << 11u);
+
+/* Short names, so the tables can be read as opcode maps */
+static constexpr std::uint16_t NN = IMM_NONE;
+static constexpr std::uint16_t IB = IMM_B;
+static constexpr std::uint16_t IW = IMM_W;
+static constexpr std::uint16_t IZ = IMM_Z;
+static constexpr std::uint16_t IV = IMM_V;
+static constexpr std::uint16_t WB = IMM_WB;
+static constexpr std::uint16_t AP = IMM_P | INVALID64;
+static constexpr std::uint16_t MO = IMM_O;
+static constexpr std::uint16_t M_ = MODRM;
+static constexpr std::uint16_t MB = MODRM | IMM_B;
+static constexpr std::uint16_t MZ = MODRM | IMM_Z;
+static constexpr std::uint16_t MD = MODRM | IMM_D;
+static constexpr std::uint16_t RB = RELATIVE | IMM_B;
+static constexpr std::uint16_t RZ = RELATIVE | IMM_J;
+static constexpr std::uint16_t PF = PREFIX;
+static constexpr std::uint16_t XX = INVALID;
+static constexpr std::uint16_t I6 = INVALID64;
+static constexpr std::uint16_t B6 = IMM_B | INVALID64;
+static constexpr std::uint16_t K6 = MODRM | IMM_B | INVALID64;
+static constexpr std::uint16_t ES = ESCAPE;
+static constexpr std::uint16_t EM = ESCAPE | MODRM;
+static constexpr std::uint16_t G_ = GROUP | MODRM;
+static constexpr std::uint16_t GZ = GROUP | MODRM | IMM_Z;
+
+using table_t = std::array<std::uint16_t, 256>;
+
+static constexpr table_t TABLE_ONE_BYTE {
+    /*      0   1   2   3   4   5   6   7   8   9   A   B   C   D   E   F */
+    /* 0 */ M_, M_, M_, M_, IB, IZ, I6, I6, M_, M_, M_, M_, IB, IZ, I6, ES,
+    /* 1 */ M_, M_, M_, M_, IB, IZ, I6, I6, M_, M_, M_, M_, IB, IZ, I6, I6,
+    /* 2 */ M_, M_, M_, M_, IB, IZ, PF, I6, M_, M_, M_, M_, IB, IZ, PF, I6,
+    /* 3 */ M_, M_, M_, M_, IB, IZ, PF, I6, M_, M_, M_, M_, IB, IZ, PF, I6,
+    /* 4 */ NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN,
+    /* 5 */ NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, NN,
+    /* 6 */ I6, I6, EM, M_, PF, PF, PF, PF, IZ, MZ, IB, MB, NN, NN, NN, NN,
+    /* 7 */ RB, RB, RB, RB, RB, RB, RB, RB, RB, RB, RB, RB, RB, RB, RB, RB,
+    /* 8 */ MB, MZ, K6, MB, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, EM,
+    /* 9 */ NN, NN, NN, NN, NN, NN, NN, NN, NN, NN, AP, NN, NN, NN, NN, NN,
+    /* A */ MO, MO, MO, MO, NN, NN, NN, NN, IB, IZ, NN, NN, NN, NN, NN, NN,
+    /* B */ IB, IB, IB, IB, IB, IB, IB, IB, IV, IV, IV, IV, IV, IV, IV, IV,
+    /* C */ MB, MB, IW, NN, EM, EM, MB, GZ, WB, NN, IW, NN, NN, IB, I6, NN,
+    /* D */ M_, M_, M_, M_, B6, B6, I6, NN, M_, M_, M_, M_, M_, M_, M_, M_,
+    /* E */ RB, RB, RB, RB, IB, IB, IB, IB, RZ, RZ, AP, RB, NN, NN, NN, NN,
+    /* F */ PF, NN, PF, PF, NN, NN, G_, G_, NN, NN, NN, NN, NN, NN, M_, M_
+};
+
+static constexpr table_t TABLE_0F {
+    /*      0   1   2   3   4   5   6   7   8   9   A   B   C   D   E   F */
+    /* 0 */ M_, M_, M_, M_, XX, NN, NN, NN, NN, NN, XX, NN, XX, M_, NN, MB,
+    /* 1 */ M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_,
+    /* 2 */ G_, G_, G_, G_, XX, XX, XX, XX, M_, M_, M_, M_, M_, M_, M_, M_,
+    /* 3 */ NN, NN, NN, NN, NN, NN, XX, NN, ES, XX, ES, XX, XX, XX, XX, XX,
+    /* 4 */ M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_,
+    /* 5 */ M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_,
+    /* 6 */ M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_,
+    /* 7 */ MB, MB, MB, MB, M_, M_, M_, NN, M_, M_, XX, XX, M_, M_, M_, M_,
+    /* 8 */ RZ, RZ, RZ, RZ, RZ, RZ, RZ, RZ, RZ, RZ, RZ, RZ, RZ, RZ, RZ, RZ,
+    /* 9 */ M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_,
+    /* A */ NN, NN, NN, M_, MB, M_, XX, XX, NN, NN, NN, M_, MB, M_, M_, M_,
+    /* B */ M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, MB, M_, M_, M_, M_, M_,
+    /* C */ M_, M_, MB, M_, MB, MB, MB, M_, NN, NN, NN, NN, NN, NN, NN, NN,
+    /* D */ M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_,
+    /* E */ M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_,
+    /* F */ M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_, M_
+};
+
+static constexpr auto UniformTable(const std::uint16_t attributes)
+  -> table_t
+{
+    table_t table {};
+    table.fill(attributes);
+    return table;
+}
+
+using mode_table_t = std::array<std::uint16_t, 512>;
+
+/**
+ * The one byte map followed by the 0x0F one, so the most common
+ * opcodes are found with a single lookup.
+ * What's invalid in 64 bits becomes invalid and 0x40-0x4F are REX
+ * there, so the mode doesn't need to be checked for each byte.
+ */
+static constexpr auto ModeTable(const bool is64) -> mode_table_t
+{
+    mode_table_t table {};
+
+    for (std::size_t opcode = 0; opcode < 256; opcode++)
+    {
+        table[opcode]       = TABLE_ONE_BYTE[opcode];
+        table[opcode + 256] = TABLE_0F[opcode];
+
+        if (is64 and (table[opcode] & INVALID64))
+        {
+            table[opcode] = INVALID;
+        }
+        else if (is64 and (opcode & 0xF0) == 0x40)
+        {
+            table[opcode] = REX;
+        }
+
+        table[opcode] &= view_as<std::uint16_t>(~INVALID64);
+    }
+
+    return table;
+}
+
+static constexpr auto TABLE_MODE_32 = ModeTable(false);
+static constexpr auto TABLE_MODE_64 = ModeTable(true);
+
+/* Every other maps have the same layout for all their opcodes */
+static constexpr auto TABLE_MODRM     = UniformTable(M_);
+static constexpr auto TABLE_MODRM_IB  = UniformTable(MB);
+static constexpr auto TABLE_MODRM_I32 = UniformTable(MD);
+
+/* Indexed by DecoderX86::Map, the first two being per mode */
+static constexpr const table_t* TABLES[] {
+    nullptr,         nullptr,      &TABLE_MODRM,    &TABLE_MODRM_IB,
+    &TABLE_MODRM,    &TABLE_MODRM, &TABLE_MODRM_IB, &TABLE_MODRM,
+    &TABLE_MODRM_I32
+};
+
+static_assert(std::size(TABLES) == DecoderX86::MAP_XOPA + 1);
+
+/**
+ * What a ModRM implies with 32/64 bits addressing, the first three bits
+ * being the displacement size.
+ */
+static constexpr std::uint8_t MODRM_SIB = (1u << 3u);
+/* disp32 alone, relative to RIP in 64 bits */
+static constexpr std::uint8_t MODRM_DISP32_ONLY = (1u << 4u);
+
+static constexpr auto ModRMTable() -> std::array<std::uint8_t, 256>
+{
+    std::array<std::uint8_t, 256> table {};
+
+    for (std::size_t modrm = 0; modrm < table.size(); modrm++)
+    {
+        const auto mod = modrm >> 6;
+        const auto rm  = modrm & 7;
+
+        if (mod == 3)
+        {
+            continue;
+        }
+
+        if (mod == 1)
+        {
+            table[modrm] = 1;
+        }
+        else if (mod == 2)
+        {
+            table[modrm] = 4;
+        }
+        else if (rm == 5)
+        {
+            table[modrm] = 4 | MODRM_DISP32_ONLY;
+        }
+
+        if (rm == 4)
+        {
+            table[modrm] |= MODRM_SIB;
+        }
+    }
+
+    return table;
+}
+
+static constexpr auto TABLE_MODRM_ADDRESSING = ModRMTable();
+
+/**
+ * Immediate sizes are looked up with the kind of immediate and the
+ * prefixes state.
+ */
+static constexpr std::size_t STATE_OPERAND_16 = (1u << 0u);
+static constexpr std::size_t STATE_REX_W      = (1u << 1u);
+static constexpr std::size_t STATE_ADDRESS    = (1u << 2u);
+static constexpr std::size_t STATE_64         = (1u << 3u);
+static constexpr std::size_t STATE_COUNT      = 16;
+
+static constexpr auto ImmediateSize(const std::size_t kind,
+                                    const std::size_t state)
+  -> std::uint8_t
+{
+    const bool operand_size_16 = state & STATE_OPERAND_16;
+    const bool rex_w           = state & STATE_REX_W;
+    const bool address         = state & STATE_ADDRESS;
+    const bool is_64           = state & STATE_64;
+
+    switch (kind)
+    {
+        case IMM_B:
+            return 1;
+        case IMM_W:
+            return 2;
+        /* REX.W wins over the operand size prefix */
+        case IMM_Z:
+            return (operand_size_16 and not rex_w) ? 2 : 4;
+        case IMM_V:
+            return rex_w ? 8 : (operand_size_16 ? 2 : 4);
+        case IMM_WB:
+            return 3;
+        case IMM_P:
+            return operand_size_16 ? 4 : 6;
+        case IMM_O:
+            return is_64 ? (address ? 4 : 8) : (address ? 2 : 4);
+        case IMM_J:
+            return (operand_size_16 and not is_64) ? 2 : 4;
+        case IMM_D:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+static constexpr auto ImmediateSizeTable()
+  -> std::array<std::uint8_t, (IMM_MASK + 1) * STATE_COUNT>
+{
+    std::array<std::uint8_t, (IMM_MASK + 1) * STATE_COUNT> table {};
+
+    for (std::size_t state = 0; state < STATE_COUNT; state++)
+    {
+        for (std::size_t kind = 0; kind <= IMM_MASK; kind++)
+        {
+            table[state * (IMM_MASK + 1) + kind] = ImmediateSize(kind,
+                                                                 state);
+        }
+    }
+
+    return table;
+}
+
+static constexpr auto TABLE_IMMEDIATE_SIZE = ImmediateSizeTable();
+
+/**
+ * What Length() needs of the common opcodes, one or two bytes after at
+ * most a REX: the bytes of the opcode and its immediate without any
+ * prefixes, the first four bits.
+ * Everything else (prefixes, escapes, groups, invalid) goes through
+ * Decode().
+ */
+static constexpr std::uint8_t FAST_MODRM = (1u << 4u);
+/* imm32 becomes imm64 with REX.W (mov r64, imm64) */
+static constexpr std::uint8_t FAST_REX_W_IMM = (1u << 5u);
+static constexpr std::uint8_t FAST_SLOW      = (1u << 6u);
+
+static constexpr auto FastTable(const mode_table_t& modeTable,
+                                const bool is64)
+  -> std::array<std::uint8_t, 512>
+{
+    std::array<std::uint8_t, 512> table {};
+
+    for (std::size_t index = 0; index < table.size(); index++)
+    {
+        const auto attributes = modeTable[index];
+
+        if (attributes & (PREFIX | REX | ESCAPE | GROUP | INVALID))
+        {
+            table[index] = FAST_SLOW;
+            continue;
+        }
+
+        const auto opcode_size    = index < 256 ? 1 : 2;
+        const auto immediate_size = ImmediateSize(attributes & IMM_MASK,
+                                                  is64 ? STATE_64 : 0);
+
+        table[index] = view_as<std::uint8_t>(opcode_size + immediate_size);
+        table[index] |= (attributes & MODRM) ? FAST_MODRM : 0;
+        table[index] |= (attributes & IMM_MASK) == IMM_V ? FAST_REX_W_IMM :
+                                                           0;
+    }
+
+    return table;
+}
+
+static constexpr auto TABLE_FAST_32 = FastTable(TABLE_MODE_32, false);
+static constexpr auto TABLE_FAST_64 = FastTable(TABLE_MODE_64, true);
+
+/**
+ * Invalid instructions are one byte long, so anyone walking the code
+ * can just move on.
+ */
+static constexpr auto Invalid() -> DecoderX86::Instruction
+{
+    DecoderX86::Instruction instruction {};
+
+    instruction.length = 1;
+    instruction.flags  = DecoderX86::Instruction::INVALID;
+
+    return instruction;
+}
+
+auto DecoderX86::Instruction::isValid() const -> bool
+{
+    return not(flags & INVALID);
+}
+
+auto DecoderX86::Instruction::isRelative() const -> bool
+{
+    return flags & (RIP_RELATIVE | RELATIVE_BRANCH);
+}
+
+auto DecoderX86::Instruction::relativeTarget(
+  const byte_t* code,
+  const std::uintptr_t address) const -> std::uintptr_t
+{
+    std::int64_t relative;
+
+    if (flags & RIP_RELATIVE)
+    {
+        relative = *view_as<const std::int32_t*>(code
+                                                 + displacement_offset);
+    }
+    else if (flags & RELATIVE_BRANCH)
+    {
+        switch (immediate_size)
+        {
+            case 1:
+                relative = *view_as<const std::int8_t*>(code
+                                                        + immediate_offset);
+                break;
+            case 2:
+                relative = *view_as<const std::int16_t*>(
+                  code + immediate_offset);
+                break;
+            default:
+                relative = *view_as<const std::int32_t*>(
+                  code + immediate_offset);
+                break;
+        }
+    }
+    else
+    {
+        ASURA_EXCEPTION("Instruction isn't relative");
+    }
+
+    return address + length + view_as<std::uintptr_t>(relative);
+}
+
+auto DecoderX86::Decode(const byte_t* code,
+                        const std::size_t size,
+                        const Mode mode) -> Instruction
+{
+    /**
+     * Most of it is done without branching, bytes that might not be
+     * part of the instruction are read clamped to the end, and the
+     * length is checked at the end.
+     * Branches are left for what's rare, prefixes other than REX,
+     * 0x0F 0x38/0x3A, VEX/EVEX/XOP, groups and 16 bits addressing.
+     */
+    Instruction instruction {};
+
+    const auto is_64 = mode == Mode::BITS64;
+    const auto end   = std::min(size, MAX_LENGTH);
+
+    const auto& table = is_64 ? TABLE_MODE_64 : TABLE_MODE_32;
+
+    if (end == 0)
+    {
+        return Invalid();
+    }
+
+    const auto last = end - 1;
+
+    std::size_t offset = 0;
+    std::size_t state  = is_64 ? STATE_64 : 0;
+    auto attributes    = table[code[0]];
+
+    /* Legacy prefixes, then REX which only counts when it's the last */
+    for (;;)
+    {
+        while (attributes & PREFIX)
+        {
+            const auto byte = code[offset];
+
+            state |= (byte == 0x66) ? STATE_OPERAND_16 : 0;
+            state |= (byte == 0x67) ? STATE_ADDRESS : 0;
+
+            if (++offset >= end)
+            {
+                return Invalid();
+            }
+
+            attributes = table[code[offset]];
+        }
+
+        const std::size_t is_rex = (attributes & REX) ? 1 : 0;
+
+        state &= ~STATE_REX_W;
+        state |= (is_rex & (code[offset] >> 3)) ? STATE_REX_W : 0;
+        offset += is_rex;
+
+        if (offset >= end)
+        {
+            return Invalid();
+        }
+
+        attributes = table[code[offset]];
+
+        if (not(attributes & (PREFIX | REX)))
+        {
+            break;
+        }
+    }
+
+    /**
+     * 0x0F is just the second half of the table, the lookup is always
+     * done so the compiler doesn't branch on it.
+     */
+    const std::size_t is_0f = code[offset] == 0x0F ? 1 : 0;
+    const std::size_t index = is_0f ?
+                                256 + code[std::min(offset + 1, last)] :
+                                code[offset];
+
+    attributes = table[index];
+    offset += is_0f;
+
+    /* 0x0F was the last byte */
+    if (offset >= end)
+    {
+        return Invalid();
+    }
+
+    auto map = view_as<Map>(is_0f * MAP_0F);
+
+    if (attributes & ESCAPE)
+    {
+        const auto byte = code[offset];
+
+        if (offset + 1 >= end)
+        {
+            return Invalid();
+        }
+
+        const auto next = code[offset + 1];
+
+        if (map == MAP_0F)
+        {
+            map = byte == 0x38 ? MAP_0F38 : MAP_0F3A;
+            offset++;
+        }
+        /**
+         * Outside of 64 bits, they're VEX/EVEX only when what would be
+         * the ModRM of LES/LDS/BOUND is a register.
+         * XOP is POP when its map would be under 8.
+         */
+        else if (byte == 0x8F ? (next & 0x1F) >= 8 :
+                                is_64 or (next & 0xC0) == 0xC0)
+        {
+            std::size_t w = 0;
+
+            switch (byte)
+            {
+                case 0xC5:
+                {
+                    map = MAP_0F;
+                    offset += 2;
+                    instruction.flags |= Instruction::VEX;
+                    break;
+                }
+                case 0xC4:
+                case 0x8F:
+                {
+                    if (offset + 2 >= end)
+                    {
+                        return Invalid();
+                    }
+
+                    const auto map_select = next & 0x1F;
+
+                    if (byte == 0xC4 and map_select >= 1 and map_select <= 3)
+                    {
+                        map = view_as<Map>(map_select);
+                    }
+                    else if (byte == 0x8F and map_select <= 0x0A)
+                    {
+                        map = view_as<Map>(MAP_XOP8 + map_select - 8);
+                    }
+                    else
+                    {
+                        return Invalid();
+                    }
+
+                    w = code[offset + 2] & 0x80;
+                    offset += 3;
+                    instruction.flags |= Instruction::VEX;
+                    break;
+                }
+                default:
+                {
+                    if (offset + 3 >= end)
+                    {
+                        return Invalid();
+                    }
+
+                    const auto map_select = next & 0x07;
+
+                    if (map_select == 0 or map_select == 4
+                        or map_select == 7)
+                    {
+                        return Invalid();
+                    }
+
+                    map = map_select <= 3 ?
+                            view_as<Map>(map_select) :
+                            view_as<Map>(MAP_5 + map_select - 5);
+                    w = code[offset + 2] & 0x80;
+                    offset += 4;
+                    instruction.flags |= Instruction::EVEX;
+                    break;
+                }
+            }
+
+            /* VEX.W takes the place of REX.W */
+            state = (state & ~STATE_REX_W) | (w ? STATE_REX_W : 0);
+        }
+        else
+        {
+            /* LES, LDS, BOUND or POP */
+            attributes &= view_as<std::uint16_t>(~ESCAPE);
+        }
+
+        if (offset >= end)
+        {
+            return Invalid();
+        }
+
+        if (attributes & ESCAPE)
+        {
+            attributes = map == MAP_0F ? table[256 + code[offset]] :
+                                         (*TABLES[map])[code[offset]];
+
+            /* 0x38/0x3A right after VEX */
+            if (attributes & ESCAPE)
+            {
+                return Invalid();
+            }
+        }
+    }
+
+    if (attributes & INVALID)
+    {
+        return Invalid();
+    }
+
+    instruction.map           = map;
+    instruction.opcode_offset = view_as<std::uint8_t>(offset);
+    instruction.opcode        = code[offset];
+    offset++;
+
+    const std::size_t has_modrm = (attributes & MODRM) ? 1 : 0;
+    const auto modrm            = code[std::min(offset, last)];
+
+    instruction.modrm_offset = view_as<std::uint8_t>(has_modrm ? offset :
+                                                                 0);
+    instruction.flags |= has_modrm ? Instruction::MODRM : 0;
+    offset += has_modrm;
+
+    std::uint8_t modrm_attributes = has_modrm ?
+                                      TABLE_MODRM_ADDRESSING[modrm] :
+                                      0;
+    bool has_memory = has_modrm and modrm < 0xC0;
+
+    if (attributes & GROUP)
+    {
+        const auto reg = (modrm >> 3) & 7;
+
+        /* mov to/from control/debug registers are always registers */
+        if (map == MAP_0F)
+        {
+            modrm_attributes = 0;
+            has_memory       = false;
+        }
+        /* test has an immediate, the rest of the group doesn't */
+        else if (instruction.opcode != 0xC7)
+        {
+            if (reg < 2)
+            {
+                attributes |= instruction.opcode == 0xF6 ? IMM_B : IMM_Z;
+            }
+        }
+        /* xbegin */
+        else if (modrm == 0xF8)
+        {
+            attributes = (attributes & ~IMM_MASK) | RELATIVE | IMM_J;
+        }
+    }
+
+    std::size_t displacement_size = modrm_attributes & 7;
+
+    /* 16 bits addressing, no SIB and its own displacements */
+    if ((state & (STATE_ADDRESS | STATE_64)) == STATE_ADDRESS
+        and has_memory)
+    {
+        const auto mod = modrm >> 6;
+
+        displacement_size = mod == 1 ?
+                              1 :
+                              ((mod == 2 or (modrm & 7) == 6) ? 2 : 0);
+        modrm_attributes  = 0;
+    }
+
+    const std::size_t has_sib = (modrm_attributes & MODRM_SIB) ? 1 : 0;
+    const auto sib            = code[std::min(offset, last)];
+
+    /* SIB with no base */
+    displacement_size |= (has_sib & (modrm < 0x40) & ((sib & 7) == 5)) * 4;
+    offset += has_sib;
+
+    instruction.flags |= view_as<std::uint8_t>(
+      (is_64 & ((modrm_attributes & MODRM_DISP32_ONLY) != 0))
+      * Instruction::RIP_RELATIVE);
+
+    instruction.displacement_offset = view_as<std::uint8_t>(
+      offset & (0 - std::size_t(displacement_size != 0)));
+    instruction.displacement_size = view_as<std::uint8_t>(
+      displacement_size);
+    offset += displacement_size;
+
+    const auto immediate_size = TABLE_IMMEDIATE_SIZE
+      [state * (IMM_MASK + 1) + (attributes & IMM_MASK)];
+
+    instruction.immediate_offset = view_as<std::uint8_t>(
+      offset & (0 - std::size_t(immediate_size != 0)));
+    instruction.immediate_size = immediate_size;
+    offset += immediate_size;
+
+    if (offset > end)
+    {
+        return Invalid();
+    }
+
+    instruction.flags |= (attributes & RELATIVE) ?
+                           Instruction::RELATIVE_BRANCH :
+                           0;
+    instruction.flags |= (state & STATE_REX_W) ? Instruction::REX_W : 0;
+
+    instruction.length = view_as<std::uint8_t>(offset);
+
+    return instruction;
+}
+
+auto DecoderX86::Length(const byte_t* code,
+                        const std::size_t size,
+                        const Mode mode) -> std::size_t
+{
+    /**
+     * With a whole instruction's worth of bytes, nothing read here can
+     * be out of the buffer, so there's no bound to check.
+     */
+    if (size < MAX_LENGTH)
+    {
+        const auto instruction = Decode(code, size, mode);
+        return instruction.isValid() ? instruction.length : 0;
+    }
+
+    const auto is_64  = mode == Mode::BITS64;
+    const auto& table = is_64 ? TABLE_FAST_64 : TABLE_FAST_32;
+
+    const std::size_t is_rex = (is_64 and (code[0] & 0xF0) == 0x40) ? 1 :
+                                                                      0;
+    const std::size_t rex_w  = is_rex & (code[0] >> 3);
+
+    const auto byte            = code[is_rex];
+    const std::size_t is_0f    = byte == 0x0F ? 1 : 0;
+    const auto fast_attributes = table[is_0f ? 256 + code[is_rex + 1] :
+                                               byte];
+
+    if (fast_attributes & FAST_SLOW)
+    {
+        const auto instruction = Decode(code, size, mode);
+        return instruction.isValid() ? instruction.length : 0;
+    }
+
+    std::size_t length = is_rex + (fast_attributes & 0xF);
+
+    length += (rex_w and (fast_attributes & FAST_REX_W_IMM)) ? 4 : 0;
+
+    if (fast_attributes & FAST_MODRM)
+    {
+        const auto modrm_offset = is_rex + 1 + is_0f;
+        const auto modrm        = code[modrm_offset];
+        const auto addressing   = TABLE_MODRM_ADDRESSING[modrm];
+
+        length += 1 + (addressing & 7);
+
+        if (addressing & MODRM_SIB)
+        {
+            const auto sib = code[modrm_offset + 1];
+
+            /* SIB with no base */
+            length += 1 + ((modrm < 0x40 and (sib & 7) == 5) ? 4 : 0);
+        }
+    }
+
+    return length;
+}
+
+auto DecoderX86::CoveringLength(const byte_t* code,
+                                const std::size_t size,
+                                const std::size_t minLength,
+                                const Mode mode) -> std::size_t
+{
+    std::size_t length = 0;
+
+    while (length < minLength)
+    {
+        const auto instruction_length = Length(code + length,
+                                               size - length,
+                                               mode);
+
+        if (instruction_length == 0)
+        {
+            return 0;
+        }
+
+        length += instruction_length;
+    }
+
+    return length;
+}
@@ -0,0 +1,107 @@
+#ifndef ASURA_DECODERX86_H
+#define ASURA_DECODERX86_H
+
+#include "types.h"
+
+namespace Asura
+{
+    /**
+     * Length decoder for x86 and x86-64 instructions.
+     * It doesn't tell what an instruction does, only where its parts
+     * are, so we can walk code, copy instructions somewhere else and fix
+     * what's relative to their address.
+     * Every opcode map is described by a table of attributes (ModRM,
+     * immediate kind, relative branch, invalid), the prefixes,
+     * REX/VEX/EVEX/XOP and ModRM/SIB being decoded around it.
+     */
+    class DecoderX86
+    {
+      public:
+        enum class Mode
+        {
+            BITS32,
+            BITS64
+        };
+
+        enum Map : std::uint8_t
+        {
+            MAP_ONE_BYTE,
+            MAP_0F,
+            MAP_0F38,
+            MAP_0F3A,
+            /* EVEX only, FP16 */
+            MAP_5,
+            MAP_6,
+            /* AMD XOP */
+            MAP_XOP8,
+            MAP_XOP9,
+            MAP_XOPA
+        };
+
+        struct Instruction
+        {
+            /**
+             * RIP_RELATIVE: the displacement is relative to the next
+             * instruction, RELATIVE_BRANCH: the immediate is.
+             * INVALID: undefined opcode, too long or truncated.
+             */
+            const inline static std::uint8_t RIP_RELATIVE    = (1u << 0u);
+            const inline static std::uint8_t RELATIVE_BRANCH = (1u << 1u);
+            const inline static std::uint8_t MODRM           = (1u << 2u);
+            const inline static std::uint8_t VEX             = (1u << 3u);
+            const inline static std::uint8_t EVEX            = (1u << 4u);
+            const inline static std::uint8_t REX_W           = (1u << 5u);
+            const inline static std::uint8_t INVALID         = (1u << 7u);
+
+            auto isValid() const -> bool;
+            auto isRelative() const -> bool;
+
+            /**
+             * Where the relative displacement or branch goes, with code
+             * being the instruction's bytes and address where it is.
+             */
+            auto relativeTarget(const byte_t* code,
+                                const std::uintptr_t address) const
+              -> std::uintptr_t;
+
+            std::uint8_t length;
+            std::uint8_t flags;
+            Map map;
+            std::uint8_t opcode;
+            /* Offsets from the start of the instruction, 0 if absent */
+            std::uint8_t opcode_offset;
+            std::uint8_t modrm_offset;
+            std::uint8_t displacement_offset;
+            std::uint8_t displacement_size;
+            std::uint8_t immediate_offset;
+            std::uint8_t immediate_size;
+        };
+
+        static constexpr inline std::size_t MAX_LENGTH = 15;
+
+      public:
+        static auto Decode(const byte_t* code,
+                           const std::size_t size,
+                           const Mode mode) -> Instruction;
+
+        /**
+         * Only the length, 0 when it can't be decoded.
+         * Plain opcodes behind at most a REX are done with a couple of
+         * lookups, the rest goes through Decode().
+         */
+        static auto Length(const byte_t* code,
+                           const std::size_t size,
+                           const Mode mode) -> std::size_t;
+
+        /**
+         * How many bytes of whole instructions are needed to cover at
+         * least minLength bytes, 0 if it can't be decoded.
+         */
+        static auto CoveringLength(const byte_t* code,
+                                   const std::size_t size,
+                                   const std::size_t minLength,
+                                   const Mode mode) -> std::size_t;
+    };
+}
+
+#endif
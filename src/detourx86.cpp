@@ -1,3 +1,299 @@
 #include "pch.h"
 
 #include "detourx86.h"
+
+using namespace Asura;
+
+auto DetourX86::IsInRel32Reach(const std::uintptr_t from,
+                               const std::uintptr_t begin,
+                               const std::uintptr_t end) -> bool
+{
+#ifdef ENVIRONMENT32
+    /* Everything is in reach, the displacement wraps around */
+    return true;
+#else
+    return (from <= begin or from - begin <= REL32_REACH)
+           and (end <= from or end - from <= REL32_REACH);
+#endif
+}
+
+DetourX86::FragmentManager::FragmentManager()
+{
+}
+
+auto DetourX86::FragmentManager::get() -> FragmentManager&
+{
+    static FragmentManager fragment_manager;
+    return fragment_manager;
+}
+
+auto DetourX86::FragmentManager::newFragment(bytes_t data,
+                                             ptr_t originalFunc)
+  -> HandleFragment_t
+{
+    if (data.size() > FRAGMENT_SIZE)
+    {
+        ASURA_EXCEPTION("Fragment is too big");
+    }
+
+    const auto address = view_as<std::uintptr_t>(originalFunc);
+
+    const std::scoped_lock lock(_mutex);
+
+    auto area_index = searchArea(address);
+
+    if (area_index == INVALID_INDEX)
+    {
+        area_index = reserveArea(address);
+    }
+
+    auto& fragments_area = *_fragments_area[area_index];
+
+    std::uintptr_t fragment_address;
+
+    if (not fragments_area.free_fragments.empty())
+    {
+        fragment_address = fragments_area.free_fragments.back();
+        fragments_area.free_fragments.pop_back();
+    }
+    else
+    {
+        fragment_address = fragments_area.next_fragment;
+        fragments_area.next_fragment += FRAGMENT_SIZE;
+    }
+
+    fragments_area.used_fragments++;
+
+    std::copy(data.begin(),
+              data.end(),
+              view_as<byte_t*>(fragment_address));
+
+    return std::make_shared<Fragment>(
+      Fragment { fragment_address, data.size(), area_index });
+}
+
+auto DetourX86::FragmentManager::wipeFragment(
+  HandleFragment_t handleFragment) -> void
+{
+    if (not handleFragment)
+    {
+        return;
+    }
+
+    const std::scoped_lock lock(_mutex);
+
+    if (handleFragment->area_index >= _fragments_area.size())
+    {
+        ASURA_EXCEPTION("Fragment doesn't belong to this manager");
+    }
+
+    auto& fragments_area = *_fragments_area[handleFragment->area_index];
+
+    /* Anything still jumping there will trap instead */
+    std::fill_n(view_as<byte_t*>(handleFragment->address),
+                FRAGMENT_SIZE,
+                FILL_BYTE);
+
+    fragments_area.free_fragments.push_back(handleFragment->address);
+    fragments_area.used_fragments--;
+
+    /* Can't be wiped twice */
+    handleFragment->size = 0;
+    handleFragment->area_index = INVALID_INDEX;
+}
+
+auto DetourX86::FragmentManager::areaCount() -> std::size_t
+{
+    const std::scoped_lock lock(_mutex);
+    return _fragments_area.size();
+}
+
+auto DetourX86::FragmentManager::searchArea(const std::uintptr_t address)
+  -> std::size_t
+{
+    for (std::size_t area_index = 0; area_index < _fragments_area.size();
+         area_index++)
+    {
+        const auto& fragments_area = *_fragments_area[area_index];
+
+        if ((not fragments_area.free_fragments.empty()
+             or fragments_area.next_fragment < fragments_area.end)
+            and IsInRel32Reach(address,
+                               fragments_area.begin,
+                               fragments_area.end))
+        {
+            return area_index;
+        }
+    }
+
+    return INVALID_INDEX;
+}
+
+auto DetourX86::FragmentManager::reserveArea(const std::uintptr_t address)
+  -> std::size_t
+{
+    /**
+     * Right next to the areas we already have first, the mapping fails
+     * if anything is there, so there's no need to parse the map.
+     */
+    std::vector<std::uintptr_t> neighbours;
+
+    for (const auto& fragments_area : _fragments_area)
+    {
+        neighbours.push_back(fragments_area->end);
+
+        if (fragments_area->begin >= AREA_SIZE * 2)
+        {
+            neighbours.push_back(fragments_area->begin - AREA_SIZE);
+        }
+    }
+
+    for (const auto& neighbour : neighbours)
+    {
+        if (IsInRel32Reach(address, neighbour, neighbour + AREA_SIZE)
+            and reserveAt(neighbour))
+        {
+            return _fragments_area.size() - 1;
+        }
+    }
+
+    /**
+     * Only parsed once we need an area, then someone else might have
+     * mapped things since the last time.
+     */
+    if (_process_memory_map.processBase().id() == Process::INVALID_PID)
+    {
+        _process_memory_map = ProcessMemoryMap(ProcessBase::self());
+    }
+    else
+    {
+        _process_memory_map.refresh();
+    }
+
+    for (const auto& gap : searchGaps(address))
+    {
+        if (reserveAt(gap))
+        {
+            return _fragments_area.size() - 1;
+        }
+    }
+
+    ASURA_EXCEPTION("Could not reserve an area near "
+                    + std::to_string(address));
+}
+
+auto DetourX86::FragmentManager::reserveAt(const std::uintptr_t address)
+  -> bool
+{
+#ifdef WINDOWS
+    const auto reserved = VirtualAlloc(
+      view_as<ptr_t>(address),
+      AREA_SIZE,
+      MEM_COMMIT | MEM_RESERVE,
+      MemoryArea::ProtectionFlags::ToOS(MemoryArea::ProtectionFlags::RWX));
+
+    if (reserved == nullptr)
+    {
+        return false;
+    }
+#else
+    const auto reserved = mmap(
+      view_as<ptr_t>(address),
+      AREA_SIZE,
+      MemoryArea::ProtectionFlags::ToOS(MemoryArea::ProtectionFlags::RWX),
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+      -1,
+      0);
+
+    if (reserved == MAP_FAILED)
+    {
+        return false;
+    }
+#endif
+    /* Older kernels take MAP_FIXED_NOREPLACE as a hint */
+    if (view_as<std::uintptr_t>(reserved) != address)
+    {
+#ifdef WINDOWS
+        VirtualFree(reserved, 0, MEM_RELEASE);
+#else
+        munmap(reserved, AREA_SIZE);
+#endif
+        return false;
+    }
+
+    std::fill_n(view_as<byte_t*>(reserved), AREA_SIZE, FILL_BYTE);
+
+    _fragments_area.push_back(std::make_shared<FragmentsArea>(
+      FragmentsArea { .begin          = address,
+                      .end            = address + AREA_SIZE,
+                      .next_fragment  = address,
+                      .free_fragments = {},
+                      .used_fragments = 0 }));
+
+    return true;
+}
+
+auto DetourX86::FragmentManager::searchGaps(
+  const std::uintptr_t address) const -> std::vector<std::uintptr_t>
+{
+    /**
+     * Free ranges are the ones between the merged areas, for each we
+     * only try the closest aligned area to our address.
+     * The first area starts above the lowest address the OS lets us
+     * map.
+     */
+    std::vector<std::pair<std::uintptr_t, std::uintptr_t>> candidates;
+
+    std::uintptr_t gap_begin = AREA_SIZE;
+
+    for (const auto& merged_area : _process_memory_map.mergedAreas())
+    {
+        const auto gap_end = merged_area.begin;
+
+        if (gap_end > gap_begin and gap_end - gap_begin >= AREA_SIZE)
+        {
+            std::uintptr_t candidate;
+
+            if (address >= gap_end)
+            {
+                candidate = MemoryUtils::Align(gap_end - AREA_SIZE,
+                                               AREA_SIZE);
+            }
+            else
+            {
+                candidate = MemoryUtils::Align(gap_begin + AREA_SIZE - 1,
+                                               AREA_SIZE);
+            }
+
+            if (candidate >= gap_begin and candidate <= gap_end - AREA_SIZE
+                and IsInRel32Reach(address,
+                                   candidate,
+                                   candidate + AREA_SIZE))
+            {
+                candidates.push_back(
+                  { candidate,
+                    address > candidate ? address - candidate :
+                                          candidate - address });
+            }
+        }
+
+        gap_begin = std::max(gap_begin, merged_area.end);
+    }
+
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [](const auto& candidate1, const auto& candidate2)
+              {
+                  return candidate1.second < candidate2.second;
+              });
+
+    std::vector<std::uintptr_t> gaps;
+    gaps.reserve(candidates.size());
+
+    for (const auto& candidate : candidates)
+    {
+        gaps.push_back(candidate.first);
+    }
+
+    return gaps;
+}
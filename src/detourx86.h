@@ -84,64 +84,125 @@ namespace Asura
         }
     };
 
-        /**
-         * TODO:
-         * here something i didn't finish yet but yea, ill use this upside
-         * instead'
-         */
-#ifdef _WIN32
-    template <CallingConventions C, typename T, typename... A>
-#else
-    template <typename T, typename... A>
-#endif
-    /**
-     * This class permits to hook any functions inside the current
-     * process. Detour is a method to hook functions. It works generally
-     * by placing a JMP instruction on the start of the function. This
-     * ones works by copying a small portion of opcodes that the JMP
-     * instruction override, disassemble them and search the closest
-     * address to the function address in order to allocate memory, so we
-     * can use a relative JMP instruction. If the disassembled
-     * instructions contains addresses that needs relocation since they're
-     * relative most of the time, it will automatically patch them by
-     * checking if it's pointing to the valid address and memory or not.
-     */
-    class TraditionalDetourX86
+    namespace DetourX86
     {
-        /**
-         * This is a manager in order to find for each detours
-         * the closest memory area possible we can use in order to jmp
-         * and callback the instructions we've overwritten.
-         */
+        /* How far a rel32 jmp/call can go, minus some room for the
+         * instructions around it */
+        constexpr std::uintptr_t REL32_REACH = 0x7FFF0000;
+
+        auto IsInRel32Reach(const std::uintptr_t from,
+                            const std::uintptr_t begin,
+                            const std::uintptr_t end) -> bool;
+
+        /* A slot of a FragmentsArea, holding the stolen instructions */
         class Fragment
         {
           public:
             std::uintptr_t address;
             std::size_t size;
+            std::size_t area_index;
         };
 
         using HandleFragment_t = std::shared_ptr<Fragment>;
 
+        /**
+         * One executable area reserved near hooked functions, cut into
+         * fragments of the same size.
+         * Fragments are handed out from the free list first, then from
+         * the part of the area that was never used.
+         */
         class FragmentsArea
         {
           public:
-            std::shared_ptr<ProcessMemoryArea> process_memory_area;
-            std::vector<std::shared_ptr<Fragment>> _fragments;
+            std::uintptr_t begin;
+            std::uintptr_t end;
+            std::uintptr_t next_fragment;
+            std::vector<std::uintptr_t> free_fragments;
+            std::size_t used_fragments;
         };
 
+        /**
+         * This is a manager in order to find for each detours
+         * the closest memory area possible we can use in order to jmp
+         * and callback the instructions we've overwritten.
+         * Areas are only reserved when none of the existing ones are in
+         * reach or has any fragment left, so thousands of hooks only
+         * cost a handful of mappings.
+         * They're kept once reserved, wiped fragments are reused, and
+         * never unmapped since hooked functions might still be called
+         * while the process exits.
+         */
         class FragmentManager
         {
+          public:
+            static constexpr std::size_t FRAGMENT_SIZE = 64;
+            /* The allocation granularity on Windows */
+            static constexpr std::size_t AREA_SIZE = 0x10000;
+            static constexpr byte_t FILL_BYTE      = 0xCC;
+
+            static constexpr inline std::size_t INVALID_INDEX = std::
+              numeric_limits<std::size_t>::max();
+
           public:
             FragmentManager();
 
+            FragmentManager(const FragmentManager&) = delete;
+            auto operator=(const FragmentManager&)
+              -> FragmentManager& = delete;
+
+            /* The one every detours of this process share */
+            static auto get() -> FragmentManager&;
+
+          public:
             auto newFragment(bytes_t data, ptr_t originalFunc)
               -> HandleFragment_t;
 
-            auto wipeFragment(HandleFragment_t HandleFragment);
+            auto wipeFragment(HandleFragment_t handleFragment) -> void;
+
+            auto areaCount() -> std::size_t;
+
+          private:
+            auto searchArea(const std::uintptr_t address) -> std::size_t;
+            auto reserveArea(const std::uintptr_t address) -> std::size_t;
+            auto reserveAt(const std::uintptr_t address) -> bool;
+            auto searchGaps(const std::uintptr_t address) const
+              -> std::vector<std::uintptr_t>;
 
           private:
+            std::mutex _mutex;
+            ProcessMemoryMap _process_memory_map;
             std::vector<std::shared_ptr<FragmentsArea>> _fragments_area;
         };
+    }
+
+        /**
+         * TODO:
+         * here something i didn't finish yet but yea, ill use this upside
+         * instead'
+         */
+#ifdef _WIN32
+    template <CallingConventions C, typename T, typename... A>
+#else
+    template <typename T, typename... A>
+#endif
+    /**
+     * This class permits to hook any functions inside the current
+     * process. Detour is a method to hook functions. It works generally
+     * by placing a JMP instruction on the start of the function. This
+     * ones works by copying a small portion of opcodes that the JMP
+     * instruction override, disassemble them and search the closest
+     * address to the function address in order to allocate memory, so we
+     * can use a relative JMP instruction. If the disassembled
+     * instructions contains addresses that needs relocation since they're
+     * relative most of the time, it will automatically patch them by
+     * checking if it's pointing to the valid address and memory or not.
+     */
+    class TraditionalDetourX86
+    {
+        using Fragment         = DetourX86::Fragment;
+        using FragmentsArea    = DetourX86::FragmentsArea;
+        using FragmentManager  = DetourX86::FragmentManager;
+        using HandleFragment_t = DetourX86::HandleFragment_t;
 
       private:
         /* This case is only for windows 32 bits program */
@@ -20,6 +20,15 @@ namespace Asura
             ELFCLASS64
         };
 
+        enum : std::uint16_t
+        {
+            ET_NONE,
+            ET_REL,
+            ET_EXEC,
+            ET_DYN,
+            ET_CORE
+        };
+
         enum : std::uint32_t
         {
             SHT_NULL,
@@ -37,7 +46,11 @@ namespace Asura
             SHT_LOPROC,
             SHT_HIPROC,
             SHT_LOUSER,
-            SHT_HIUSER
+            SHT_HIUSER,
+            SHT_GNU_HASH    = 0x6ffffff6,
+            SHT_GNU_VERDEF  = 0x6ffffffd,
+            SHT_GNU_VERNEED = 0x6ffffffe,
+            SHT_GNU_VERSYM  = 0x6fffffff
         };
 
         enum : std::uint32_t
@@ -54,6 +67,13 @@ namespace Asura
             PT_GNU_STACK
         };
 
+        enum : std::uint32_t
+        {
+            PF_X = 1,
+            PF_W = 2,
+            PF_R = 4
+        };
+
         enum : int
         {
             DT_NULL,
@@ -84,9 +104,73 @@ namespace Asura
             DT_RUNPATH,
             DT_LOPROC,
             DT_HIPROC,
-            DT_GNU_HASH = 0x6ffffef5
+            DT_RELRSZ   = 35,
+            DT_RELR     = 36,
+            DT_GNU_HASH    = 0x6ffffef5,
+            DT_VERSYM      = 0x6ffffff0,
+            DT_VERNEED     = 0x6ffffffe,
+            DT_VERNEEDNUM  = 0x6fffffff
         };
 
+        enum : std::uint8_t
+        {
+            STB_LOCAL,
+            STB_GLOBAL,
+            STB_WEAK
+        };
+
+        enum : std::uint8_t
+        {
+            STT_NOTYPE,
+            STT_OBJECT,
+            STT_FUNC,
+            STT_SECTION,
+            STT_FILE,
+            STT_COMMON,
+            STT_TLS,
+            STT_GNU_IFUNC = 10
+        };
+
+        enum : std::uint16_t
+        {
+            EM_386    = 3,
+            EM_X86_64 = 62
+        };
+
+        enum : std::uint32_t
+        {
+            R_X86_64_NONE      = 0,
+            R_X86_64_64        = 1,
+            R_X86_64_GLOB_DAT  = 6,
+            R_X86_64_JUMP_SLOT = 7,
+            R_X86_64_RELATIVE  = 8
+        };
+
+        enum : std::uint32_t
+        {
+            R_386_NONE     = 0,
+            R_386_32       = 1,
+            R_386_GLOB_DAT = 6,
+            R_386_JMP_SLOT = 7,
+            R_386_RELATIVE = 8
+        };
+
+        /* Auxiliary vector entries */
+        enum : std::uint32_t
+        {
+            AT_NULL   = 0,
+            AT_RANDOM = 25
+        };
+
+        /* Note holding the build-id, from the "GNU" owner */
+        constexpr inline std::uint32_t NT_GNU_BUILD_ID = 3;
+
+        constexpr inline std::uint16_t SHN_UNDEF = 0;
+        /* Set in DT_VERSYM for the versions that aren't the default */
+        constexpr inline std::uint16_t VERSYM_HIDDEN = 0x8000;
+        /* The rest is the index of the version */
+        constexpr inline std::uint16_t VERSYM_INDEX = 0x7fff;
+
         /* For 32 bits programs, ELF 32 bit only supported */
         template <typename T>
         concept IntType = std::is_same<std::uint32_t, T>::value or(
@@ -175,6 +259,163 @@ namespace Asura
         {
         };
 
+        constexpr inline auto GNUHash(const std::string_view name)
+          -> std::uint32_t
+        {
+            std::uint32_t hash = 5381;
+
+            for (const auto c : name)
+            {
+                hash = (hash << 5) + hash + view_as<std::uint8_t>(c);
+            }
+
+            return hash;
+        }
+
+        constexpr inline auto SysVHash(const std::string_view name)
+          -> std::uint32_t
+        {
+            std::uint32_t hash = 0;
+
+            for (const auto c : name)
+            {
+                hash = (hash << 4) + view_as<std::uint8_t>(c);
+
+                const auto high = hash & 0xf0000000;
+
+                if (high)
+                {
+                    hash ^= high >> 24;
+                }
+
+                hash &= ~high;
+            }
+
+            return hash;
+        }
+
+        /**
+         * Exact lookup of a defined symbol through DT_GNU_HASH.
+         * The bloom filter rejects most of the missing names without
+         * touching the symbols at all.
+         * When versions are given, only the default one matches.
+         */
+        template <IntType T>
+        auto LookupGNUHash(const std::uint32_t* const gnuHash,
+                           const Elf_Sym<T>* const symbolTable,
+                           const std::uintptr_t stringTable,
+                           const std::uint16_t* const versions,
+                           const std::string_view name)
+          -> const Elf_Sym<T>*
+        {
+            constexpr auto bloom_bits = sizeof(T) * CHAR_BIT;
+
+            const auto bucket_count = gnuHash[0];
+            const auto symbol_start = gnuHash[1];
+            const auto bloom_size   = gnuHash[2];
+            const auto bloom_shift  = gnuHash[3];
+
+            if (bucket_count == 0 or bloom_size == 0)
+            {
+                return nullptr;
+            }
+
+            const auto bloom = view_as<const T*>(gnuHash + 4);
+            const auto buckets = view_as<const std::uint32_t*>(
+              bloom + bloom_size);
+            const auto chains = buckets + bucket_count;
+
+            const auto hash = GNUHash(name);
+
+            const auto bloom_word = bloom[(hash / bloom_bits)
+                                          & (bloom_size - 1)];
+            const T bloom_mask    = (T(1) << (hash % bloom_bits))
+                                 | (T(1)
+                                    << ((hash >> bloom_shift) % bloom_bits));
+
+            if ((bloom_word & bloom_mask) != bloom_mask)
+            {
+                return nullptr;
+            }
+
+            auto symbol_index = buckets[hash % bucket_count];
+
+            if (symbol_index < symbol_start)
+            {
+                return nullptr;
+            }
+
+            while (true)
+            {
+                const auto chain_hash = chains[symbol_index
+                                               - symbol_start];
+
+                /* The lowest bit marks the end of the chain */
+                if ((chain_hash | 1) == (hash | 1))
+                {
+                    const auto symbol = &symbolTable[symbol_index];
+
+                    if (name
+                          == view_as<const char*>(stringTable
+                                                  + symbol->st_name)
+                        and symbol->st_shndx != SHN_UNDEF
+                        and (not versions
+                             or not(versions[symbol_index]
+                                    & VERSYM_HIDDEN)))
+                    {
+                        return symbol;
+                    }
+                }
+
+                if (chain_hash & 1)
+                {
+                    return nullptr;
+                }
+
+                symbol_index++;
+            }
+        }
+
+        /* Same, through the older DT_HASH */
+        template <IntType T>
+        auto LookupSysVHash(const std::uint32_t* const sysvHash,
+                            const Elf_Sym<T>* const symbolTable,
+                            const std::uintptr_t stringTable,
+                            const std::uint16_t* const versions,
+                            const std::string_view name)
+          -> const Elf_Sym<T>*
+        {
+            const auto bucket_count = sysvHash[0];
+
+            if (bucket_count == 0)
+            {
+                return nullptr;
+            }
+
+            const auto buckets = sysvHash + 2;
+            const auto chains  = buckets + bucket_count;
+
+            for (auto symbol_index = buckets[SysVHash(name)
+                                             % bucket_count];
+                 symbol_index != 0;
+                 symbol_index = chains[symbol_index])
+            {
+                const auto symbol = &symbolTable[symbol_index];
+
+                if (name
+                      == view_as<const char*>(stringTable
+                                              + symbol->st_name)
+                    and symbol->st_shndx != SHN_UNDEF
+                    and (not versions
+                         or not(versions[symbol_index] & VERSYM_HIDDEN)))
+                {
+                    return symbol;
+                }
+            }
+
+            return nullptr;
+        }
+
         template <IntType T>
         struct Elf_Rel
         {
@@ -190,6 +431,35 @@ namespace Asura
             typename std::make_signed<T>::type r_addend;
         };
 
+        /* r_info split, ELF32_R_SYM/ELF64_R_SYM and *_R_TYPE */
+        template <IntType T>
+        constexpr inline auto RelocationSymbol(const T info)
+          -> std::uint32_t
+        {
+            if constexpr (std::is_same<T, std::uint64_t>::value)
+            {
+                return view_as<std::uint32_t>(info >> 32);
+            }
+            else
+            {
+                return info >> 8;
+            }
+        }
+
+        template <IntType T>
+        constexpr inline auto RelocationType(const T info)
+          -> std::uint32_t
+        {
+            if constexpr (std::is_same<T, std::uint64_t>::value)
+            {
+                return view_as<std::uint32_t>(info);
+            }
+            else
+            {
+                return info & 0xff;
+            }
+        }
+
         template <IntType T>
         struct Elf_Dyn
         {
@@ -202,6 +472,46 @@ namespace Asura
             } d_un;
         };
 
+        /**
+         * Versions defined (.gnu.version_d) and needed (.gnu.version_r),
+         * the same for both classes. Each entry is followed by its
+         * auxiliary entries, all of them linked by offsets in bytes.
+         */
+        struct Elf_Verdef
+        {
+            std::uint16_t vd_version;
+            std::uint16_t vd_flags;
+            std::uint16_t vd_ndx;
+            std::uint16_t vd_cnt;
+            std::uint32_t vd_hash;
+            std::uint32_t vd_aux;
+            std::uint32_t vd_next;
+        };
+
+        struct Elf_Verdaux
+        {
+            std::uint32_t vda_name;
+            std::uint32_t vda_next;
+        };
+
+        struct Elf_Verneed
+        {
+            std::uint16_t vn_version;
+            std::uint16_t vn_cnt;
+            std::uint32_t vn_file;
+            std::uint32_t vn_aux;
+            std::uint32_t vn_next;
+        };
+
+        struct Elf_Vernaux
+        {
+            std::uint32_t vna_hash;
+            std::uint16_t vna_flags;
+            std::uint16_t vna_other;
+            std::uint32_t vna_name;
+            std::uint32_t vna_next;
+        };
+
         template <IntType T>
         struct Elf_Nhdr
         {
@@ -267,27 +577,43 @@ namespace Asura
                 const auto views = view_as<const ph_or_sec_t* const>(
                   view_as<std::uintptr_t>(this) + view_offset);
 
+                /**
+                 * Only when there's no hash table, exact names too, but
+                 * every symbol gets compared.
+                 */
                 const auto process_symbol_table =
                   [&](const auto symbol_count,
                       const auto symbol_table,
-                      const auto string_table) -> std::tuple<bool, T>
+                      const auto string_table) -> const Elf_Sym<T>*
                 {
                     for (T i = 0; i < symbol_count; i++)
                     {
                         const auto current_symbol = &symbol_table[i];
 
-                        const std::string symbol_name = view_as<
-                          const char* const>(string_table
-                                             + current_symbol->st_name);
-
-                        if (symbol_name.find(funcName)
-                            != std::string::npos)
+                        if (current_symbol->st_shndx != SHN_UNDEF
+                            and funcName
+                                  == view_as<const char* const>(
+                                    string_table
+                                    + current_symbol->st_name))
                         {
-                            return { true, current_symbol->st_value };
+                            return current_symbol;
                         }
                     }
 
-                    return { false, 0 };
+                    return nullptr;
+                };
+
+                const auto to_module_sym =
+                  [&](const Elf_Sym<T>* const symbol) -> module_sym_t
+                {
+                    if (not symbol)
+                    {
+                        return { 0, 0 };
+                    }
+
+                    return { view_as<std::uintptr_t>(baseAddress),
+                             symbol->st_value
+                               + view_as<std::uintptr_t>(baseAddress) };
                 };
 
                 for (std::uint16_t i = 0; i < view_count; i++)
@@ -308,6 +634,27 @@ namespace Asura
                         const Elf_Sym<T>* symbol_table = nullptr;
                         T symbol_count                 = 0;
                         std::uintptr_t string_table    = 0;
+                        const std::uint32_t* gnu_hash  = nullptr;
+                        const std::uint32_t* sysv_hash = nullptr;
+                        const std::uint16_t* versions  = nullptr;
+
+                        /**
+                         * The dynamic linker relocates those entries,
+                         * but not the ones of the vdso for example.
+                         */
+                        const auto dyn_address = [&](const auto dyn)
+                        {
+                            const auto address = view_as<std::uintptr_t>(
+                              dyn->d_un.d_ptr);
+
+                            if (address < view_as<std::uintptr_t>(this))
+                            {
+                                return address
+                                       + view_as<std::uintptr_t>(this);
+                            }
+
+                            return address;
+                        };
 
                         const auto process_symtab = [&](const auto dyn)
                         {
@@ -319,23 +666,7 @@ namespace Asura
                             }
 
                             symbol_table = view_as<decltype(symbol_table)>(
-                              view_as<std::uintptr_t>(dyn->d_un.d_val));
-
-                            auto current_symbol = symbol_table;
-
-                            /**
-                             * HACK:
-                             * Usually symbol table is just before string
-                             * table, so that ease our stuff.
-                             */
-                            while (view_as<std::uintptr_t>(current_symbol)
-                                   < string_table)
-                            {
-                                current_symbol++;
-                            }
-
-                            symbol_count = (current_symbol
-                                            - symbol_table);
+                              dyn_address(dyn));
                         };
 
                         const auto process_strtab = [&](const auto dyn)
@@ -347,7 +678,7 @@ namespace Asura
                                   "string table in PT_DYNAMIC");
                             }
 
-                            string_table = dyn->d_un.d_val;
+                            string_table = dyn_address(dyn);
                         };
 
                         const auto process_pt_dynamic =
@@ -371,42 +702,88 @@ namespace Asura
                                         process_strtab(dyn);
                                         break;
                                     }
+                                    case DT_GNU_HASH:
+                                    {
+                                        gnu_hash = view_as<
+                                          const std::uint32_t*>(
+                                          dyn_address(dyn));
+                                        break;
+                                    }
+                                    case DT_HASH:
+                                    {
+                                        sysv_hash = view_as<
+                                          const std::uint32_t*>(
+                                          dyn_address(dyn));
+                                        break;
+                                    }
+                                    case DT_VERSYM:
+                                    {
+                                        versions = view_as<
+                                          const std::uint16_t*>(
+                                          dyn_address(dyn));
+                                        break;
+                                    }
                                 }
                             }
 
-                            if (symbol_count and symbol_table
-                                and string_table)
-                            {
-                                const auto [found, st_value] = process_symbol_table(
-                                  symbol_count,
-                                  symbol_table,
-                                  string_table);
-
-                                if (found)
-                                {
-                                    return { view_as<std::uintptr_t>(
-                                               baseAddress),
-                                             st_value
-                                               + view_as<std::uintptr_t>(
-                                                 baseAddress) };
-                                }
-
-                                return { 0, 0 };
-                            }
-                            else
+                            if (not symbol_table or not string_table)
                             {
                                 ASURA_EXCEPTION(
                                   "Couldn't find enough information "
                                   "about "
                                   "ELF => "
-                                  "symbol_count: "
-                                  + std::to_string(symbol_count)
-                                  + " symbol_table: "
+                                  "symbol_table: "
                                   + std::to_string(
                                     view_as<std::uintptr_t>(symbol_table))
                                   + " string_table: "
                                   + std::to_string(string_table));
                             }
+
+                            if (gnu_hash)
+                            {
+                                return to_module_sym(
+                                  LookupGNUHash(gnu_hash,
+                                                symbol_table,
+                                                string_table,
+                                                versions,
+                                                funcName));
+                            }
+
+                            if (sysv_hash)
+                            {
+                                return to_module_sym(
+                                  LookupSysVHash(sysv_hash,
+                                                 symbol_table,
+                                                 string_table,
+                                                 versions,
+                                                 funcName));
+                            }
+
+                            /**
+                             * HACK:
+                             * Usually symbol table is just before string
+                             * table, so that ease our stuff.
+                             */
+                            if (string_table
+                                > view_as<std::uintptr_t>(symbol_table))
+                            {
+                                symbol_count = (string_table
+                                                - view_as<std::uintptr_t>(
+                                                  symbol_table))
+                                               / sizeof(Elf_Sym<T>);
+                            }
+
+                            if (not symbol_count)
+                            {
+                                ASURA_EXCEPTION(
+                                  "Couldn't find the symbol count of "
+                                  "ELF without hash table");
+                            }
+
+                            return to_module_sym(
+                              process_symbol_table(symbol_count,
+                                                   symbol_table,
+                                                   string_table));
                         };
 
                         return process_pt_dynamic();
@@ -436,18 +813,85 @@ namespace Asura
                                   view_as<std::uintptr_t>(this)
                                   + view->sh_offset);
 
-                                const auto [found, st_value] = process_symbol_table(
-                                  symbol_count,
-                                  symbol_table,
-                                  string_table);
+                                /**
+                                 * Hash tables and versions are linked to
+                                 * the dynamic symbol table they index.
+                                 */
+                                const std::uint32_t* gnu_hash  = nullptr;
+                                const std::uint32_t* sysv_hash = nullptr;
+                                const std::uint16_t* versions  = nullptr;
+
+                                for (std::uint16_t j = 0;
+                                     j < view_count
+                                     and view->sh_type == SHT_DYNSYM;
+                                     j++)
+                                {
+                                    const auto& linked = views[j];
+
+                                    if (linked.sh_link != i)
+                                    {
+                                        continue;
+                                    }
+
+                                    const auto data = view_as<
+                                                        std::uintptr_t>(
+                                                        this)
+                                                      + linked.sh_offset;
+
+                                    switch (linked.sh_type)
+                                    {
+                                        case SHT_GNU_HASH:
+                                        {
+                                            gnu_hash = view_as<
+                                              const std::uint32_t*>(data);
+                                            break;
+                                        }
+                                        case SHT_HASH:
+                                        {
+                                            sysv_hash = view_as<
+                                              const std::uint32_t*>(data);
+                                            break;
+                                        }
+                                        case SHT_GNU_VERSYM:
+                                        {
+                                            versions = view_as<
+                                              const std::uint16_t*>(data);
+                                            break;
+                                        }
+                                    }
+                                }
+
+                                const auto symbol = [&]()
+                                {
+                                    if (gnu_hash)
+                                    {
+                                        return LookupGNUHash(
+                                          gnu_hash,
+                                          symbol_table,
+                                          string_table,
+                                          versions,
+                                          funcName);
+                                    }
+
+                                    if (sysv_hash)
+                                    {
+                                        return LookupSysVHash(
+                                          sysv_hash,
+                                          symbol_table,
+                                          string_table,
+                                          versions,
+                                          funcName);
+                                    }
+
+                                    return process_symbol_table(
+                                      symbol_count,
+                                      symbol_table,
+                                      string_table);
+                                }();
 
-                                if (found)
+                                if (symbol)
                                 {
-                                    return { view_as<std::uintptr_t>(
-                                               baseAddress),
-                                             st_value
-                                               + view_as<std::uintptr_t>(
-                                                 baseAddress) };
+                                    return to_module_sym(symbol);
                                 }
                                 else
                                 {
@@ -0,0 +1,201 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "hookbatch.h"
+
+using namespace Asura;
+
+auto HookBatch::hooks() const -> const std::vector<Hook>&
+{
+    return _hooks;
+}
+
+auto HookBatch::isApplied() const -> bool
+{
+    return _applied;
+}
+
+auto HookBatch::originalTarget(const std::size_t hookIndex) const
+  -> std::uintptr_t
+{
+    if (not _applied)
+    {
+        ASURA_EXCEPTION("Hook batch isn't applied");
+    }
+
+    return _hooks.at(hookIndex).original_target;
+}
+
+auto HookBatch::add(const Kind kind,
+                    const std::uintptr_t address,
+                    const std::uintptr_t target) -> std::size_t
+{
+    if (_applied)
+    {
+        ASURA_EXCEPTION("Can't add a hook to an applied hook batch");
+    }
+
+    /* The displacement is relative to the end of the instruction */
+    if (kind == Kind::REL32)
+    {
+        const auto displacement = view_as<std::intptr_t>(
+          target - (address + sizeof(std::int32_t)));
+
+        if (displacement < std::numeric_limits<std::int32_t>::min()
+            or displacement > std::numeric_limits<std::int32_t>::max())
+        {
+            std::stringstream ss;
+            ss << std::hex << address;
+
+            ASURA_EXCEPTION("Hook target is out of rel32 reach at: "
+                            + ss.str());
+        }
+    }
+
+    _hooks.push_back({ .kind            = kind,
+                       .address         = address,
+                       .target          = target,
+                       .original_target = 0 });
+
+    return _hooks.size() - 1;
+}
+
+auto HookBatch::clear() -> void
+{
+    if (_applied)
+    {
+        ASURA_EXCEPTION("Can't clear an applied hook batch");
+    }
+
+    _hooks.clear();
+}
+
+auto HookBatch::apply() -> void
+{
+    if (_applied)
+    {
+        ASURA_EXCEPTION("Hook batch is already applied");
+    }
+
+    /* Only once for the whole batch */
+    const ProcessMemoryMap process_memory_map(ProcessBase::self());
+
+    _page_runs = pageRuns(process_memory_map.areaTable());
+
+    for (auto&& hook : _hooks)
+    {
+        if (hook.kind == Kind::VFUNC)
+        {
+            hook.original_target = *view_as<std::uintptr_t*>(
+              hook.address);
+        }
+        else
+        {
+            std::int32_t displacement;
+            std::memcpy(&displacement,
+                        view_as<ptr_t>(hook.address),
+                        sizeof(displacement));
+
+            hook.original_target = hook.address + sizeof(displacement)
+                                   + view_as<std::uintptr_t>(
+                                     view_as<std::intptr_t>(
+                                       displacement));
+        }
+    }
+
+    const auto self_id = ProcessBase::self().id();
+
+    _page_runs.protect(self_id, true);
+    write(false);
+
+    /* Written, even if a protection can't be restored */
+    _applied = true;
+
+    _page_runs.protect(self_id, false);
+}
+
+auto HookBatch::revert() -> void
+{
+    if (not _applied)
+    {
+        ASURA_EXCEPTION("Hook batch isn't applied");
+    }
+
+    const auto self_id = ProcessBase::self().id();
+
+    _page_runs.protect(self_id, true);
+    write(true);
+
+    _applied = false;
+
+    _page_runs.protect(self_id, false);
+}
+
+auto HookBatch::Size(const Kind kind) -> std::size_t
+{
+    return kind == Kind::VFUNC ? sizeof(ptr_t) : sizeof(std::int32_t);
+}
+
+auto HookBatch::pageRuns(const MemoryAreaTable& table) const -> PageRuns
+{
+    /* Sorted aside, the indexes given by add must stay the same */
+    std::vector<const Hook*> sorted_hooks;
+    sorted_hooks.reserve(_hooks.size());
+
+    for (const auto& hook : _hooks)
+    {
+        sorted_hooks.push_back(&hook);
+    }
+
+    std::sort(sorted_hooks.begin(),
+              sorted_hooks.end(),
+              [](const Hook* lhs, const Hook* rhs)
+              {
+                  return lhs->address < rhs->address;
+              });
+
+    for (std::size_t i = 1; i < sorted_hooks.size(); i++)
+    {
+        const auto previous = sorted_hooks[i - 1];
+
+        if (previous->address + Size(previous->kind)
+            > sorted_hooks[i]->address)
+        {
+            std::stringstream ss;
+            ss << std::hex << sorted_hooks[i]->address;
+
+            ASURA_EXCEPTION("Hooks overlap at address: " + ss.str());
+        }
+    }
+
+    PageRuns page_runs;
+
+    for (const auto hook : sorted_hooks)
+    {
+        page_runs.add(table, hook->address, Size(hook->kind));
+    }
+
+    return page_runs;
+}
+
+auto HookBatch::write(const bool original) -> void
+{
+    for (const auto& hook : _hooks)
+    {
+        const auto target = original ? hook.original_target : hook.target;
+
+        if (hook.kind == Kind::VFUNC)
+        {
+            *view_as<std::uintptr_t*>(hook.address) = target;
+        }
+        else
+        {
+            const auto displacement = view_as<std::int32_t>(
+              target - (hook.address + sizeof(std::int32_t)));
+
+            std::memcpy(view_as<ptr_t>(hook.address),
+                        &displacement,
+                        sizeof(displacement));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef ASURA_HOOKBATCH_H
+#define ASURA_HOOKBATCH_H
+
+#include "pageruns.h"
+#include "processmemorymap.h"
+
+namespace Asura
+{
+    /**
+     * Installs a bunch of hooks in our own process at once.
+     * hook_vfunc and override_rel32 parse the memory map and change the
+     * protections of the whole area for every hook, here the map is
+     * parsed once, the pages touched are made writable once per
+     * contiguous run of pages, then every slot is written directly.
+     * The original targets are kept so the whole batch can be reverted
+     * the same way.
+     */
+    class HookBatch
+    {
+      public:
+        enum class Kind
+        {
+            /* A pointer in a virtual table */
+            VFUNC,
+            /* The displacement of a jmp/call rel32 */
+            REL32
+        };
+
+        struct Hook
+        {
+            Kind kind;
+            /* Where the pointer or the displacement is */
+            std::uintptr_t address;
+            std::uintptr_t target;
+            /* Filled when applied */
+            std::uintptr_t original_target;
+        };
+
+      public:
+        auto hooks() const -> const std::vector<Hook>&;
+        auto isApplied() const -> bool;
+
+        /* What was there before the hook, once applied */
+        auto originalTarget(const std::size_t hookIndex) const
+          -> std::uintptr_t;
+
+      public:
+        /* Returns the index of the hook inside the batch */
+        auto add(const Kind kind,
+                 const std::uintptr_t address,
+                 const std::uintptr_t target) -> std::size_t;
+        auto clear() -> void;
+
+        auto apply() -> void;
+        auto revert() -> void;
+
+        auto hookVFunc(ptr_t* const vptr,
+                       const std::size_t index,
+                       const auto newFuncPtr) -> std::size_t
+        {
+            return add(Kind::VFUNC,
+                       view_as<std::uintptr_t>(&vptr[index]),
+                       view_as<std::uintptr_t>(newFuncPtr));
+        }
+
+        /* fromPtr is the jmp/call instruction itself */
+        auto hookRel32(const auto fromPtr, const auto to) -> std::size_t
+        {
+            return add(Kind::REL32,
+                       view_as<std::uintptr_t>(fromPtr) + 1,
+                       view_as<std::uintptr_t>(to));
+        }
+
+      private:
+        static auto Size(const Kind kind) -> std::size_t;
+
+        auto pageRuns(const MemoryAreaTable& table) const -> PageRuns;
+        auto write(const bool original) -> void;
+
+      private:
+        std::vector<Hook> _hooks;
+        /* Kept from apply for revert, so it doesn't parse the map */
+        PageRuns _page_runs;
+        bool _applied {};
+    };
+}
+
+#endif
@@ -2,98 +2,1317 @@
 
 #include "exception.h"
 #include "memoryutils.h"
+#include "moduleindex.h"
+#include "symbolresolver.h"
 
 #include "kokabiel.h"
 
-Asura::Kokabiel::Kokabiel(const std::string& fileName)
+using namespace Asura;
+
+/**
+ * What the resolver of an indirect function returns, called from the
+ * same file loaded inside our own process. It's the same CPU, so the
+ * same implementation gets picked.
+ * The name must be found at the same place inside both, its default
+ * version being at defaultAddress.
+ */
+static auto CallIndirectFunction(const ModuleIndex::Module& module,
+                                 const ModuleIndex& selfIndex,
+                                 SymbolResolver& symbolResolver,
+                                 const std::string& name,
+                                 const std::uintptr_t defaultAddress,
+                                 const std::uintptr_t resolverAddress)
+  -> std::uintptr_t
 {
-    if (not _elf.load(fileName))
+    const auto self_module_id = selfIndex.find(module.name);
+
+    if (self_module_id == ModuleIndex::INVALID_ID)
     {
-        ASURA_EXCEPTION("Couldn't load " + fileName);
+        ASURA_EXCEPTION("Couldn't call the resolver of " + name + ", "
+                        + module.name + " isn't loaded inside our process");
+    }
+
+    const auto& self_module = selfIndex.module(self_module_id);
+
+    /* Same file, the resolver is at the same place */
+    const auto self_resolved = symbolResolver.resolve(selfIndex,
+                                                      self_module.name,
+                                                      { name });
+
+    if (self_resolved.front().module_id == ModuleIndex::INVALID_ID
+        or self_resolved.front().address - self_module.begin
+             != defaultAddress - module.begin)
+    {
+        ASURA_EXCEPTION("Couldn't call the resolver of " + name + ", "
+                        + module.name
+                        + " isn't the same file inside our process");
+    }
+
+    using resolver_t = std::uintptr_t (*)();
+
+    const auto function = view_as<resolver_t>(
+      resolverAddress - module.begin + self_module.begin)();
+
+    return function - self_module.begin + module.begin;
+}
+
+/* A name defined with a given version inside a module's file */
+struct VersionedValue
+{
+    /* Of the version asked for, then of the default one */
+    std::optional<std::uint64_t> value;
+    std::optional<std::uint64_t> default_value;
+    SymbolTable::Type type {};
+};
+
+/**
+ * Every versions of the names wanted inside .dynsym, hidden ones
+ * included, found in one pass.
+ * Nothing is found when the file has no versions.
+ */
+template <ELF::IntType T>
+static auto FindVersionedValues(
+  const MappedFile& file,
+  const std::vector<std::pair<std::string_view, std::string_view>>& wanted)
+  -> std::vector<VersionedValue>
+{
+    std::vector<VersionedValue> values(wanted.size());
+
+    const auto elf_header = file.at<ELF::Elf_Ehdr<T>>(0);
+
+    const auto sections = elf_header ?
+                            file.at<ELF::Elf_Shdr<T>>(elf_header->e_shoff,
+                                                      elf_header->e_shnum) :
+                            nullptr;
+
+    if (not sections)
+    {
+        return values;
+    }
+
+    const ELF::Elf_Shdr<T>* dynamic_symbols_section = nullptr;
+    const ELF::Elf_Shdr<T>* versions_section        = nullptr;
+    const ELF::Elf_Shdr<T>* definitions_section     = nullptr;
+
+    for (std::size_t i = 0; i < elf_header->e_shnum; i++)
+    {
+        switch (sections[i].sh_type)
+        {
+            case ELF::SHT_DYNSYM:
+            {
+                dynamic_symbols_section = &sections[i];
+                break;
+            }
+
+            case ELF::SHT_GNU_VERSYM:
+            {
+                versions_section = &sections[i];
+                break;
+            }
+
+            case ELF::SHT_GNU_VERDEF:
+            {
+                definitions_section = &sections[i];
+                break;
+            }
+        }
+    }
+
+    /* Names of the versions must be inside the same strings */
+    if (not dynamic_symbols_section or not versions_section
+        or not definitions_section
+        or dynamic_symbols_section->sh_link >= elf_header->e_shnum
+        or definitions_section->sh_link != dynamic_symbols_section->sh_link)
+    {
+        return values;
+    }
+
+    const auto& string_section = sections[dynamic_symbols_section
+                                            ->sh_link];
+
+    const auto symbol_count = dynamic_symbols_section->sh_size
+                              / sizeof(ELF::Elf_Sym<T>);
+
+    const auto symbols  = file.at<ELF::Elf_Sym<T>>(
+      dynamic_symbols_section->sh_offset,
+      symbol_count);
+    const auto versions = file.at<std::uint16_t>(
+      versions_section->sh_offset,
+      symbol_count);
+    const auto strings  = file.at<char>(string_section.sh_offset,
+                                       string_section.sh_size);
+
+    if (not symbols or not versions or not strings)
+    {
+        return values;
+    }
+
+    const auto string_at = [&](const std::size_t offset)
+    {
+        return std::string_view(strings + offset,
+                                strnlen(strings + offset,
+                                        string_section.sh_size - offset));
+    };
+
+    std::unordered_map<std::uint16_t, std::string_view> version_names;
+
+    auto definition_offset = definitions_section->sh_offset;
+
+    for (std::size_t i = 0; i < definitions_section->sh_info; i++)
+    {
+        const auto definition = file.at<ELF::Elf_Verdef>(
+          definition_offset);
+
+        if (not definition)
+        {
+            break;
+        }
+
+        /* The first auxiliary entry is the version's own name */
+        const auto auxiliary = file.at<ELF::Elf_Verdaux>(
+          definition_offset + definition->vd_aux);
+
+        if (auxiliary and auxiliary->vda_name < string_section.sh_size)
+        {
+            version_names[definition->vd_ndx] = string_at(
+              auxiliary->vda_name);
+        }
+
+        if (definition->vd_next == 0)
+        {
+            break;
+        }
+
+        definition_offset += definition->vd_next;
+    }
+
+    std::unordered_multimap<std::string_view, std::size_t> wanted_indexes;
+
+    for (std::size_t i = 0; i < wanted.size(); i++)
+    {
+        wanted_indexes.emplace(wanted[i].first, i);
+    }
+
+    for (std::size_t i = 1; i < symbol_count; i++)
+    {
+        const auto& symbol = symbols[i];
+
+        if (symbol.st_shndx == ELF::SHN_UNDEF
+            or symbol.st_name >= string_section.sh_size)
+        {
+            continue;
+        }
+
+        const auto [first, last] = wanted_indexes.equal_range(
+          string_at(symbol.st_name));
+
+        const auto version_name = version_names.find(versions[i]
+                                                     & ELF::VERSYM_INDEX);
+
+        for (auto it = first; it != last; it++)
+        {
+            auto& value = values[it->second];
+
+            if (not(versions[i] & ELF::VERSYM_HIDDEN))
+            {
+                value.default_value = symbol.st_value;
+            }
+
+            if (version_name != version_names.end()
+                and version_name->second == wanted[it->second].second)
+            {
+                value.value = symbol.st_value;
+
+                switch (symbol.st_info & 0xf)
+                {
+                    case ELF::STT_FUNC:
+                    {
+                        value.type = SymbolTable::Type::Function;
+                        break;
+                    }
+
+                    case ELF::STT_GNU_IFUNC:
+                    {
+                        value.type = SymbolTable::Type::IndirectFunction;
+                        break;
+                    }
+
+                    case ELF::STT_OBJECT:
+                    case ELF::STT_COMMON:
+                    {
+                        value.type = SymbolTable::Type::Object;
+                        break;
+                    }
+
+                    default:
+                    {
+                        value.type = SymbolTable::Type::Other;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return values;
+}
+
+/**
+ * Names are resolved to their default version, which is what's wanted
+ * unless an import asks for another one, like an older ABI the module
+ * kept hidden. Those are looked for again inside the module's file,
+ * the default version's value giving where the file is loaded.
+ */
+static auto ResolveVersions(const ModuleIndex& moduleIndex,
+                            const std::vector<Kokabiel::Symbol>& symbols,
+                            const std::vector<std::size_t>& nameIndexes,
+                            std::vector<SymbolResolver::Resolved>& resolved)
+  -> void
+{
+    std::map<ModuleIndex::module_id_t, std::vector<std::size_t>>
+      versioned_by_module;
+
+    for (std::size_t i = 0; i < resolved.size(); i++)
+    {
+        if (resolved[i].module_id != ModuleIndex::INVALID_ID
+            and not symbols[nameIndexes[i]].version.empty())
+        {
+            versioned_by_module[resolved[i].module_id].push_back(i);
+        }
     }
 
-    loadSegments();
+    for (const auto& [module_id, indexes] : versioned_by_module)
+    {
+        std::vector<std::pair<std::string_view, std::string_view>> wanted;
+
+        for (const auto index : indexes)
+        {
+            const auto& symbol = symbols[nameIndexes[index]];
+            wanted.emplace_back(symbol.name, symbol.version);
+        }
+
+        std::vector<VersionedValue> values;
+
+        try
+        {
+            const MappedFile file(moduleIndex.module(module_id).path);
+
+            const auto elf_parent_header = file.at<ELF::Elf_Parent_Ehdr>(
+              0);
+
+            if (not elf_parent_header
+                or std::memcmp(elf_parent_header->e_ident,
+                               &ELF::MAGIC_NUMBER,
+                               sizeof(ELF::MAGIC_NUMBER))
+                     != 0)
+            {
+                continue;
+            }
+
+            values = (elf_parent_header->e_ident[ELF::EI_CLASS]
+                      == ELF::ELFCLASS32) ?
+                       FindVersionedValues<std::uint32_t>(file, wanted) :
+                       FindVersionedValues<std::uint64_t>(file, wanted);
+        }
+        catch (Exception&)
+        {
+            /* Can't be read, the default versions will do */
+            continue;
+        }
+
+        for (std::size_t i = 0; i < indexes.size(); i++)
+        {
+            const auto& value = values[i];
+
+            if (not value.value or not value.default_value)
+            {
+                continue;
+            }
+
+            auto& resolved_symbol = resolved[indexes[i]];
+
+            resolved_symbol.address = resolved_symbol.address
+                                      - *value.default_value
+                                      + *value.value;
+            resolved_symbol.type    = value.type;
+        }
+    }
 }
 
-auto Asura::Kokabiel::loadSegments() -> void
+Asura::Kokabiel::Image::Image(const std::string& fileName)
+ : _file(fileName)
 {
-    /* copy segments */
-    for (const auto& segment : _elf.segments)
+    /* Only the headers are read now, segments when they're written */
+    const auto elf_parent_header = _file.at<ELF::Elf_Parent_Ehdr>(0);
+
+    if (not elf_parent_header
+        or std::memcmp(elf_parent_header->e_ident,
+                       &ELF::MAGIC_NUMBER,
+                       sizeof(ELF::MAGIC_NUMBER))
+             != 0)
+    {
+        ASURA_EXCEPTION("Couldn't load " + fileName);
+    }
+
+    _type      = elf_parent_header->e_type;
+    _elf_class = elf_parent_header->e_ident[ELF::EI_CLASS];
+
+    switch (_elf_class)
     {
-        const auto seg_type = segment->get_type();
+        case ELF::ELFCLASS32:
+        {
+            loadSegments<std::uint32_t>();
+            break;
+        }
+
+#ifndef ENVIRONMENT32
+        case ELF::ELFCLASS64:
+        {
+            loadSegments<std::uint64_t>();
+            break;
+        }
+#endif
 
-        if (seg_type == ELFIO::PT_LOAD)
+        default:
         {
-            MemoryArea loadable_segment;
+            ASURA_EXCEPTION("Unsupported ELF Class: "
+                            + std::to_string(_elf_class));
+        }
+    }
+}
 
-            loadable_segment.start = MemoryUtils::Align(
-              segment->get_virtual_address(),
-              MemoryUtils::GetPageSize());
+template <Asura::ELF::IntType T>
+auto Asura::Kokabiel::Image::loadSegments() -> void
+{
+    const auto elf_header = _file.at<ELF::Elf_Ehdr<T>>(0);
+
+    if (not elf_header)
+    {
+        ASURA_EXCEPTION("Truncated elf header inside " + _file.path());
+    }
 
-            const auto left_over = segment->get_virtual_address()
-                                   - loadable_segment.start;
+    _entry_point = elf_header->e_entry;
 
-            const auto memory_aligned_size = MemoryUtils::AlignToPageSize(
-              segment->get_memory_size() + left_over,
-              MemoryUtils::GetPageSize());
+    const auto program_headers = _file.at<ELF::Elf_Phdr<T>>(
+      elf_header->e_phoff,
+      elf_header->e_phnum);
 
-            loadable_segment.bytes.resize(memory_aligned_size);
+    if (not program_headers)
+    {
+        ASURA_EXCEPTION("Truncated program headers inside "
+                        + _file.path());
+    }
 
-            std::copy(segment->get_data(),
-                      segment->get_data() + segment->get_file_size(),
-                      view_as<byte_t*>(loadable_segment.bytes.data()
-                                       + left_over));
+    /* describe segments */
+    for (std::size_t i = 0; i < elf_header->e_phnum; i++)
+    {
+        const auto& program_header = program_headers[i];
 
-            const auto seg_flags = segment->get_flags();
+        if (program_header.p_type != ELF::PT_LOAD)
+        {
+            continue;
+        }
 
-            loadable_segment.flags = ((seg_flags & ELFIO::PF_R) ? Asura::
-                                          MemoryArea::ProtectionFlags::R :
-                                                                  0)
-                                     | ((seg_flags & ELFIO::PF_W) ?
-                                          Asura::MemoryArea::
-                                            ProtectionFlags::W :
-                                          0)
-                                     | ((seg_flags & ELFIO::PF_X) ?
-                                          Asura::MemoryArea::
-                                            ProtectionFlags::X :
-                                          0);
+        const auto data = _file.at<byte_t>(program_header.p_offset,
+                                           program_header.p_filesz);
 
-            _loadable_segments.push_back(loadable_segment);
+        if (not data or program_header.p_filesz > program_header.p_memsz)
+        {
+            ASURA_EXCEPTION("Invalid loadable segment inside "
+                            + _file.path());
         }
+
+        Segment loadable_segment;
+
+        loadable_segment.start = MemoryUtils::Align(
+          view_as<std::uintptr_t>(program_header.p_vaddr),
+          MemoryUtils::GetPageSize());
+
+        loadable_segment.data_offset = program_header.p_vaddr
+                                       - loadable_segment.start;
+
+        loadable_segment.size = MemoryUtils::AlignToPageSize(
+          program_header.p_memsz + loadable_segment.data_offset,
+          MemoryUtils::GetPageSize());
+
+        loadable_segment.data           = { data, program_header.p_filesz };
+        loadable_segment.relocated_size = 0;
+
+        const auto seg_flags = program_header.p_flags;
+
+        loadable_segment.flags = ((seg_flags & ELF::PF_R) ?
+                                    Asura::MemoryArea::ProtectionFlags::R :
+                                    0)
+                                 | ((seg_flags & ELF::PF_W) ?
+                                      Asura::MemoryArea::ProtectionFlags::W :
+                                      0)
+                                 | ((seg_flags & ELF::PF_X) ?
+                                      Asura::MemoryArea::ProtectionFlags::X :
+                                      0);
+
+        _segments.push_back(loadable_segment);
     }
 
-    if (_loadable_segments.empty())
+    if (_segments.empty())
     {
         ASURA_EXCEPTION("No loadable segments inside the elf file");
     }
 
     /* sort segments */
-    std::sort(_loadable_segments.begin(),
-              _loadable_segments.end(),
-              [](const MemoryArea& ma1, const MemoryArea& ma2)
+    std::sort(_segments.begin(),
+              _segments.end(),
+              [](const Segment& s1, const Segment& s2)
               {
-                  return ma1.start < ma2.start;
+                  return s1.start < s2.start;
               });
 
-    const auto last = _loadable_segments.end() - 1;
+    const auto last = _segments.end() - 1;
+
+    _size = (last->start + last->size) - _segments.begin()->start;
+
+    loadRelocations<T>(*elf_header);
+}
+
+template <Asura::ELF::IntType T>
+auto Asura::Kokabiel::Image::loadRelocations(
+  const ELF::Elf_Ehdr<T>& elfHeader) -> void
+{
+    const auto program_headers = _file.at<ELF::Elf_Phdr<T>>(
+      elfHeader.e_phoff,
+      elfHeader.e_phnum);
+
+    const auto dynamic_header = std::find_if(
+      program_headers,
+      program_headers + elfHeader.e_phnum,
+      [](const ELF::Elf_Phdr<T>& programHeader)
+      {
+          return programHeader.p_type == ELF::PT_DYNAMIC;
+      });
+
+    /* Nothing to relocate */
+    if (dynamic_header == program_headers + elfHeader.e_phnum)
+    {
+        return;
+    }
+
+    const auto dynamic_count = dynamic_header->p_filesz
+                               / sizeof(ELF::Elf_Dyn<T>);
+
+    const auto dynamics = _file.at<ELF::Elf_Dyn<T>>(
+      dynamic_header->p_offset,
+      dynamic_count);
+
+    if (not dynamics)
+    {
+        ASURA_EXCEPTION("Truncated dynamic section inside "
+                        + _file.path());
+    }
+
+    const auto tag = [&](const auto dynamicTag) -> T
+    {
+        for (std::size_t i = 0; i < dynamic_count; i++)
+        {
+            if (dynamics[i].d_tag == ELF::DT_NULL)
+            {
+                break;
+            }
+
+            if (dynamics[i].d_tag == dynamicTag)
+            {
+                return dynamics[i].d_un.d_val;
+            }
+        }
+
+        return 0;
+    };
+
+    constexpr auto is_64_bits = std::is_same<T, std::uint64_t>::value;
+
+    const auto machine_supported = elfHeader.e_machine
+                                   == (is_64_bits ? ELF::EM_X86_64 :
+                                                    ELF::EM_386);
+
+    std::uint32_t last_symbol_index = 0;
+
+    /* Without an addend it's the one inside the file, REL and RELR */
+    const auto add = [&](const T offset,
+                         const std::uint32_t relocationType,
+                         const std::uint32_t symbolIndex,
+                         const std::optional<std::int64_t> addend)
+    {
+        if (relocationType == ELF::R_X86_64_NONE)
+        {
+            return;
+        }
+
+        if (not machine_supported)
+        {
+            ASURA_EXCEPTION("Relocations are only supported for x86 "
+                            "inside "
+                            + _file.path());
+        }
+
+        Relocation relocation;
+
+        /* i386 ones have the same values */
+        static_assert(
+          view_as<std::uint32_t>(ELF::R_X86_64_64) == ELF::R_386_32
+          and view_as<std::uint32_t>(ELF::R_X86_64_GLOB_DAT)
+                == ELF::R_386_GLOB_DAT
+          and view_as<std::uint32_t>(ELF::R_X86_64_JUMP_SLOT)
+                == ELF::R_386_JMP_SLOT
+          and view_as<std::uint32_t>(ELF::R_X86_64_RELATIVE)
+                == ELF::R_386_RELATIVE);
+
+        switch (relocationType)
+        {
+            case ELF::R_X86_64_RELATIVE:
+            {
+                relocation.type = Relocation::Type::Relative;
+                break;
+            }
+
+            case ELF::R_X86_64_64:
+            case ELF::R_X86_64_GLOB_DAT:
+            case ELF::R_X86_64_JUMP_SLOT:
+            {
+                relocation.type = Relocation::Type::Symbol;
+                break;
+            }
+
+            default:
+            {
+                ASURA_EXCEPTION("Unsupported relocation type "
+                                + std::to_string(relocationType)
+                                + " inside " + _file.path());
+            }
+        }
+
+        /* Segment where the whole word is */
+        auto segment = std::upper_bound(
+          _segments.begin(),
+          _segments.end(),
+          view_as<std::uintptr_t>(offset),
+          [](const std::uintptr_t address, const Segment& loadableSegment)
+          {
+              return address < loadableSegment.start;
+          });
+
+        if (segment == _segments.begin()
+            or offset + sizeof(T) > (segment - 1)->start
+                                      + (segment - 1)->size
+            or offset < (segment - 1)->start + (segment - 1)->data_offset)
+        {
+            ASURA_EXCEPTION("Relocation outside of the image inside "
+                            + _file.path());
+        }
+
+        segment--;
+
+        const auto data_offset = offset - segment->start
+                                 - segment->data_offset;
+
+        relocation.offset        = offset;
+        relocation.segment_index = view_as<std::uint32_t>(
+          segment - _segments.begin());
+        relocation.symbol_index = symbolIndex;
+
+        if (addend)
+        {
+            relocation.addend = *addend;
+        }
+        /* The lazy binding stubs aren't needed */
+        else if (relocationType == ELF::R_X86_64_GLOB_DAT
+                 or relocationType == ELF::R_X86_64_JUMP_SLOT)
+        {
+            relocation.addend = 0;
+        }
+        else
+        {
+            T implicit_addend = 0;
+
+            if (data_offset + sizeof(T) <= segment->data.size())
+            {
+                std::memcpy(&implicit_addend,
+                            segment->data.data() + data_offset,
+                            sizeof(T));
+            }
+
+            relocation.addend = view_as<
+              typename std::make_signed<T>::type>(implicit_addend);
+        }
+
+        segment->relocated_size = std::max({ segment->relocated_size,
+                                             segment->data.size(),
+                                             view_as<std::size_t>(
+                                               data_offset + sizeof(T)) });
+
+        if (relocation.type == Relocation::Type::Symbol)
+        {
+            last_symbol_index = std::max(last_symbol_index, symbolIndex);
+        }
+
+        _relocations.push_back(relocation);
+    };
+
+    const auto table = [&]<typename R>(const T address, const T size)
+      -> std::span<const R>
+    {
+        if (not address or not size)
+        {
+            return {};
+        }
+
+        const auto offset  = fileOffset<T>(elfHeader, address);
+        const auto entries = offset ?
+                               _file.at<R>(*offset, size / sizeof(R)) :
+                               nullptr;
+
+        if (not entries)
+        {
+            ASURA_EXCEPTION("Truncated relocations inside "
+                            + _file.path());
+        }
+
+        return { entries, size / sizeof(R) };
+    };
+
+    const auto add_rela = [&](const T address, const T size)
+    {
+        for (const auto& rela :
+             table.template operator()<ELF::Elf_Rela<T>>(address, size))
+        {
+            add(rela.r_offset,
+                ELF::RelocationType(rela.r_info),
+                ELF::RelocationSymbol(rela.r_info),
+                rela.r_addend);
+        }
+    };
+
+    const auto add_rel = [&](const T address, const T size)
+    {
+        for (const auto& rel :
+             table.template operator()<ELF::Elf_Rel<T>>(address, size))
+        {
+            add(rel.r_offset,
+                ELF::RelocationType(rel.r_info),
+                ELF::RelocationSymbol(rel.r_info),
+                std::nullopt);
+        }
+    };
+
+    add_rela(tag(ELF::DT_RELA), tag(ELF::DT_RELASZ));
+    add_rel(tag(ELF::DT_REL), tag(ELF::DT_RELSZ));
+
+    if (tag(ELF::DT_PLTREL) == ELF::DT_RELA)
+    {
+        add_rela(tag(ELF::DT_JMPREL), tag(ELF::DT_PLTRELSZ));
+    }
+    else
+    {
+        add_rel(tag(ELF::DT_JMPREL), tag(ELF::DT_PLTRELSZ));
+    }
+
+    /**
+     * Packed relative relocations, an address followed by bitmaps of
+     * the next words to relocate.
+     */
+    T relr_address = 0;
+
+    for (const auto entry : table.template operator()<T>(
+           tag(ELF::DT_RELR),
+           tag(ELF::DT_RELRSZ)))
+    {
+        if ((entry & 1) == 0)
+        {
+            add(entry, ELF::R_X86_64_RELATIVE, 0, std::nullopt);
+            relr_address = entry + sizeof(T);
+            continue;
+        }
+
+        auto bitmap = entry >> 1;
+
+        for (std::size_t bit = 0; bitmap != 0; bitmap >>= 1, bit++)
+        {
+            if (bitmap & 1)
+            {
+                add(relr_address + bit * sizeof(T),
+                    ELF::R_X86_64_RELATIVE,
+                    0,
+                    std::nullopt);
+            }
+        }
+
+        relr_address += (sizeof(T) * CHAR_BIT - 1) * sizeof(T);
+    }
+
+    if (last_symbol_index == 0)
+    {
+        return;
+    }
+
+    const auto symbol_table_offset = fileOffset<T>(elfHeader,
+                                                   tag(ELF::DT_SYMTAB));
+    const auto string_table_offset = fileOffset<T>(elfHeader,
+                                                   tag(ELF::DT_STRTAB));
+    const auto string_table_size = tag(ELF::DT_STRSZ);
+
+    const auto symbol_table = symbol_table_offset ?
+                                _file.at<ELF::Elf_Sym<T>>(
+                                  *symbol_table_offset,
+                                  last_symbol_index + 1) :
+                                nullptr;
+
+    const auto string_table = string_table_offset ?
+                                _file.at<char>(*string_table_offset,
+                                               string_table_size) :
+                                nullptr;
+
+    if (not symbol_table or not string_table)
+    {
+        ASURA_EXCEPTION("Truncated dynamic symbols inside "
+                        + _file.path());
+    }
+
+    _symbols.resize(last_symbol_index + 1);
+
+    for (std::size_t i = 1; i < _symbols.size(); i++)
+    {
+        const auto& symbol = symbol_table[i];
+
+        if (symbol.st_name >= string_table_size)
+        {
+            ASURA_EXCEPTION("Invalid dynamic symbol name inside "
+                            + _file.path());
+        }
+
+        const auto name = string_table + symbol.st_name;
+
+        const auto symbol_type = symbol.st_info & 0xf;
+
+        if (symbol_type == ELF::STT_TLS
+            or symbol_type == ELF::STT_GNU_IFUNC)
+        {
+            ASURA_EXCEPTION("Unsupported symbol type for "
+                            + std::string(name) + " inside "
+                            + _file.path());
+        }
+
+        _symbols[i] = {
+            .name    = { name,
+                        strnlen(name, string_table_size - symbol.st_name) },
+            .version = {},
+            .defined = symbol.st_shndx != ELF::SHN_UNDEF,
+            .weak    = (symbol.st_info >> 4) == ELF::STB_WEAK,
+            .value   = symbol.st_value
+        };
+    }
+
+    if (not tag(ELF::DT_VERSYM) or not tag(ELF::DT_VERNEED))
+    {
+        return;
+    }
+
+    const auto versions_offset = fileOffset<T>(elfHeader,
+                                               tag(ELF::DT_VERSYM));
+    const auto needed_offset   = fileOffset<T>(elfHeader,
+                                               tag(ELF::DT_VERNEED));
+
+    const auto versions = versions_offset ?
+                            _file.at<std::uint16_t>(*versions_offset,
+                                                    _symbols.size()) :
+                            nullptr;
+
+    if (not versions or not needed_offset)
+    {
+        ASURA_EXCEPTION("Truncated symbol versions inside "
+                        + _file.path());
+    }
+
+    /**
+     * Each library needed lists the versions asked for, the index of
+     * an import's version inside DT_VERSYM is one of their vna_other.
+     */
+    std::unordered_map<std::uint16_t, std::string_view> version_names;
+
+    auto needed_entry_offset = *needed_offset;
+
+    for (std::size_t i = 0; i < tag(ELF::DT_VERNEEDNUM); i++)
+    {
+        const auto needed = _file.at<ELF::Elf_Verneed>(
+          needed_entry_offset);
+
+        if (not needed)
+        {
+            ASURA_EXCEPTION("Truncated needed versions inside "
+                            + _file.path());
+        }
+
+        auto auxiliary_offset = needed_entry_offset + needed->vn_aux;
+
+        for (std::size_t j = 0; j < needed->vn_cnt; j++)
+        {
+            const auto auxiliary = _file.at<ELF::Elf_Vernaux>(
+              auxiliary_offset);
+
+            if (not auxiliary or auxiliary->vna_name >= string_table_size)
+            {
+                ASURA_EXCEPTION("Invalid needed version inside "
+                                + _file.path());
+            }
+
+            const auto name = string_table + auxiliary->vna_name;
+
+            version_names[auxiliary->vna_other] = {
+                name,
+                strnlen(name, string_table_size - auxiliary->vna_name)
+            };
+
+            auxiliary_offset += auxiliary->vna_next;
+        }
+
+        needed_entry_offset += needed->vn_next;
+    }
+
+    for (std::size_t i = 1; i < _symbols.size(); i++)
+    {
+        if (_symbols[i].defined)
+        {
+            continue;
+        }
+
+        const auto version_name = version_names.find(
+          versions[i] & ELF::VERSYM_INDEX);
+
+        if (version_name != version_names.end())
+        {
+            _symbols[i].version = version_name->second;
+        }
+    }
+}
+
+template <Asura::ELF::IntType T>
+auto Asura::Kokabiel::Image::fileOffset(const ELF::Elf_Ehdr<T>& elfHeader,
+                                        const std::uintptr_t address) const
+  -> std::optional<std::size_t>
+{
+    const auto program_headers = _file.at<ELF::Elf_Phdr<T>>(
+      elfHeader.e_phoff,
+      elfHeader.e_phnum);
+
+    for (std::size_t i = 0; i < elfHeader.e_phnum; i++)
+    {
+        const auto& program_header = program_headers[i];
+
+        if (program_header.p_type == ELF::PT_LOAD
+            and address >= program_header.p_vaddr
+            and address - program_header.p_vaddr < program_header.p_filesz)
+        {
+            return program_header.p_offset
+                   + (address - program_header.p_vaddr);
+        }
+    }
+
+    return std::nullopt;
+}
+
+auto Asura::Kokabiel::Image::file() const -> const MappedFile&
+{
+    return _file;
+}
+
+auto Asura::Kokabiel::Image::type() const -> std::uint16_t
+{
+    return _type;
+}
+
+auto Asura::Kokabiel::Image::elfClass() const -> std::uint8_t
+{
+    return _elf_class;
+}
+
+auto Asura::Kokabiel::Image::entryPoint() const -> std::uintptr_t
+{
+    return _entry_point;
+}
+
+auto Asura::Kokabiel::Image::segments() const
+  -> const std::vector<Segment>&
+{
+    return _segments;
+}
+
+auto Asura::Kokabiel::Image::relocations() const
+  -> const std::vector<Relocation>&
+{
+    return _relocations;
+}
+
+auto Asura::Kokabiel::Image::symbols() const -> const std::vector<Symbol>&
+{
+    return _symbols;
+}
+
+auto Asura::Kokabiel::Image::size() const -> std::size_t
+{
+    return _size;
+}
+
+Asura::Kokabiel::PhaseTimer::PhaseTimer(std::uint64_t& phase)
+ : _phase(phase)
+{
+    _timer.start();
+}
+
+Asura::Kokabiel::PhaseTimer::~PhaseTimer()
+{
+    _timer.end();
+    _phase += _timer.difference();
+}
+
+Asura::Kokabiel::Kokabiel(const std::string& fileName)
+ : _image(std::make_shared<const Image>(fileName))
+{
+}
+
+Asura::Kokabiel::Kokabiel(std::shared_ptr<const Image> image)
+ : _image(std::move(image))
+{
+}
+
+auto Asura::Kokabiel::image() const -> const std::shared_ptr<const Image>&
+{
+    return _image;
+}
+
+auto Asura::Kokabiel::resolveSymbols(const ModuleIndex& moduleIndex,
+                                     const std::uintptr_t offsetImage) const
+  -> std::vector<std::uintptr_t>
+{
+    const auto& symbols = _image->symbols();
+
+    std::vector<std::uintptr_t> addresses(symbols.size());
+    std::vector<std::string> names;
+    std::vector<std::size_t> name_indexes;
+
+    for (std::size_t i = 0; i < symbols.size(); i++)
+    {
+        const auto& symbol = symbols[i];
+
+        if (symbol.defined)
+        {
+            addresses[i] = symbol.value + offsetImage;
+        }
+        else if (not symbol.name.empty())
+        {
+            names.emplace_back(symbol.name);
+            name_indexes.push_back(i);
+        }
+    }
+
+    if (names.empty())
+    {
+        return addresses;
+    }
+
+    SymbolResolver symbol_resolver;
+    const auto default_resolved = symbol_resolver.resolve(moduleIndex,
+                                                          names);
+
+    auto resolved = default_resolved;
+    ResolveVersions(moduleIndex, symbols, name_indexes, resolved);
+
+    /* Only needed for indirect functions */
+    std::optional<ModuleIndex> self_index;
+
+    for (std::size_t i = 0; i < resolved.size(); i++)
+    {
+        if (resolved[i].module_id == ModuleIndex::INVALID_ID)
+        {
+            if (not symbols[name_indexes[i]].weak)
+            {
+                ASURA_EXCEPTION("Couldn't resolve symbol " + names[i]
+                                + " inside the process");
+            }
+
+            continue;
+        }
+
+        if (resolved[i].type == SymbolTable::Type::IndirectFunction)
+        {
+            if (not self_index)
+            {
+                self_index.emplace();
+                self_index->updateSelf();
+            }
+
+            addresses[name_indexes[i]] = CallIndirectFunction(
+              moduleIndex.module(resolved[i].module_id),
+              *self_index,
+              symbol_resolver,
+              names[i],
+              default_resolved[i].address,
+              resolved[i].address);
 
-    _image_size = (last->start + last->bytes.size())
-                  - _loadable_segments.begin()->start;
+            continue;
+        }
+
+        addresses[name_indexes[i]] = resolved[i].address;
+    }
+
+    return addresses;
 }
 
 auto Asura::Kokabiel::freeInjection(InjectionInfo& injectionInfo) const
   -> void
 {
-    injectionInfo.process_memory_map.freeArea(
-      injectionInfo.allocated_mem.shellcode.start,
-      injectionInfo.allocated_mem.shellcode.bytes.size());
+    auto& allocated_mem = injectionInfo.allocated_mem;
+
+    if (allocated_mem.shellcode.start)
+    {
+        injectionInfo.process_memory_map.freeArea(
+          allocated_mem.shellcode.start,
+          allocated_mem.shellcode.bytes.size());
+
+        allocated_mem.shellcode.start = 0;
+    }
+
+    if (allocated_mem.env_data.start)
+    {
+        injectionInfo.process_memory_map.freeArea(
+          allocated_mem.env_data.start,
+          allocated_mem.env_data.bytes.size()
+            + MemoryUtils::GetPageSize());
+
+        allocated_mem.env_data.start = 0;
+    }
+
+    if (injectionInfo.image_base)
+    {
+        injectionInfo.process_memory_map.freeArea(
+          injectionInfo.image_base,
+          injectionInfo.image->size());
+
+        injectionInfo.image_base = 0;
+    }
+}
+
+auto Asura::Kokabiel::mapLocal(LocalMapping& localMapping) const -> void
+{
+#ifndef WINDOWS
+    if (_image->type() != ELF::ET_DYN and _image->type() != ELF::ET_EXEC)
+    {
+        ASURA_EXCEPTION("Elf must be dynamic library or "
+                        "executable");
+    }
+
+    const auto& file     = _image->file();
+    const auto& segments = _image->segments();
+
+    const auto fd = open(file.path().c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        ASURA_EXCEPTION("Couldn't open file " + file.path());
+    }
+
+    /* Must still be what was parsed */
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) < 0 or file_stat.st_ino != file.inode()
+        or view_as<std::size_t>(file_stat.st_size) != file.size()
+        or file.isStale())
+    {
+        close(fd);
+        ASURA_EXCEPTION("File changed since it was loaded " + file.path());
+    }
+
+    const auto is_executable = _image->type() == ELF::ET_EXEC;
+
+    /**
+     * Holds the whole image range, each segment is then mapped over its
+     * part of it with MAP_FIXED, which replaces the reservation in one
+     * step so the range is never free for anyone else to take.
+     */
+    const auto reserved = mmap(
+      is_executable ? view_as<ptr_t>(segments.begin()->start) : nullptr,
+      _image->size(),
+      PROT_NONE,
+      MAP_PRIVATE | MAP_ANONYMOUS
+        | (is_executable ? MAP_FIXED_NOREPLACE : 0),
+      -1,
+      0);
+
+    if (reserved == MAP_FAILED
+        or (is_executable
+            and view_as<std::uintptr_t>(reserved)
+                  != segments.begin()->start))
+    {
+        if (reserved != MAP_FAILED)
+        {
+            munmap(reserved, _image->size());
+        }
+
+        close(fd);
+        ASURA_EXCEPTION("Could not reserve image");
+    }
+
+    localMapping.image        = _image;
+    localMapping.image_base   = view_as<std::uintptr_t>(reserved);
+    localMapping.offset_image = localMapping.image_base
+                                - segments.begin()->start;
+    localMapping.entry_point = _image->entryPoint()
+                               + localMapping.offset_image;
+
+    const auto page_size = MemoryUtils::GetPageSize();
+
+    const auto map_fixed = [&](const std::uintptr_t address,
+                               const std::size_t size,
+                               const int protection,
+                               const int flags,
+                               const int mapFd,
+                               const std::size_t offset)
+    {
+        /* Only ever inside our own reservation */
+        const auto mapped = mmap(view_as<ptr_t>(address),
+                                 size,
+                                 protection,
+                                 flags | MAP_PRIVATE | MAP_FIXED,
+                                 mapFd,
+                                 view_as<off_t>(offset));
+
+        if (mapped != view_as<ptr_t>(address))
+        {
+            munmap(reserved, _image->size());
+            close(fd);
+            ASURA_EXCEPTION("Could not map segment at "
+                            + std::to_string(address));
+        }
+    };
+
+    for (const auto& segment : segments)
+    {
+        const auto address = segment.start + localMapping.offset_image;
+
+        /* Written to while relocating, restored afterwards */
+        const auto protection = Asura::MemoryArea::ProtectionFlags::ToOS(
+          segment.flags
+          | (segment.relocated_size != 0 ?
+               Asura::MemoryArea::ProtectionFlags::W :
+               0));
+
+        const auto file_end  = segment.data_offset + segment.data.size();
+        const auto file_size = segment.data.empty() ?
+                                 0 :
+                                 MemoryUtils::AlignToPageSize(file_end,
+                                                              page_size);
+
+        if (file_size != 0)
+        {
+            map_fixed(address,
+                      file_size,
+                      protection,
+                      0,
+                      fd,
+                      view_as<std::size_t>(segment.data.data()
+                                           - file.data())
+                        - segment.data_offset);
+
+            /**
+             * The rest of the last page from the file is the start of
+             * the zero filled tail, only writable segments have one.
+             */
+            if ((segment.flags & Asura::MemoryArea::ProtectionFlags::W)
+                and file_end != file_size)
+            {
+                std::memset(view_as<ptr_t>(address + file_end),
+                            0,
+                            file_size - file_end);
+            }
+        }
+
+        if (segment.size > file_size)
+        {
+            map_fixed(address + file_size,
+                      segment.size - file_size,
+                      protection,
+                      MAP_ANONYMOUS,
+                      -1,
+                      0);
+        }
+    }
+
+    close(fd);
+
+    if (_image->relocations().empty())
+    {
+        return;
+    }
+
+    ModuleIndex module_index;
+    module_index.updateSelf();
+
+    std::vector<byte_t*> destinations(segments.size());
+
+    for (std::size_t i = 0; i < segments.size(); i++)
+    {
+        destinations[i] = view_as<byte_t*>(segments[i].start
+                                           + segments[i].data_offset
+                                           + localMapping.offset_image);
+    }
+
+    try
+    {
+        const auto symbol_addresses = resolveSymbols(
+          module_index,
+          localMapping.offset_image);
+
+        if (_image->elfClass() == ELF::ELFCLASS32)
+        {
+            applyRelocations<ELF::ELFCLASS32>(localMapping.offset_image,
+                                              symbol_addresses,
+                                              destinations);
+        }
+#ifndef ENVIRONMENT32
+        else
+        {
+            applyRelocations<ELF::ELFCLASS64>(localMapping.offset_image,
+                                              symbol_addresses,
+                                              destinations);
+        }
+#endif
+    }
+    catch (...)
+    {
+        munmap(reserved, _image->size());
+        throw;
+    }
+
+    for (const auto& segment : segments)
+    {
+        if (segment.relocated_size == 0
+            or (segment.flags & Asura::MemoryArea::ProtectionFlags::W))
+        {
+            continue;
+        }
 
-    injectionInfo.process_memory_map.freeArea(
-      injectionInfo.allocated_mem.env_data.start,
-      injectionInfo.allocated_mem.env_data.bytes.size()
-        + MemoryUtils::GetPageSize());
+        mprotect(view_as<ptr_t>(segment.start + localMapping.offset_image),
+                 segment.size,
+                 Asura::MemoryArea::ProtectionFlags::ToOS(segment.flags));
+    }
+#else
+    static_cast<void>(localMapping);
 
-    injectionInfo.process_memory_map.freeArea(
-      injectionInfo.loaded_segments.begin()->start,
-      _image_size);
+    ASURA_EXCEPTION("Local mapping is only supported on GNU/Linux");
+#endif
+}
+
+auto Asura::Kokabiel::unmapLocal(LocalMapping& localMapping) const -> void
+{
+#ifndef WINDOWS
+    munmap(view_as<ptr_t>(localMapping.image_base),
+           localMapping.image->size());
+#else
+    static_cast<void>(localMapping);
+#endif
 }
@@ -1,10 +1,14 @@
 #ifndef ASURA_KOKABIEL_H
 #define ASURA_KOKABIEL_H
 
+#include "elf.h"
+#include "mappedfile.h"
 #include "memoryarea.h"
 #include "memoryutils.h"
+#include "moduleindex.h"
 #include "process.h"
 #include "processmemoryarea.h"
+#include "timer.h"
 
 namespace Asura
 {
@@ -20,16 +24,18 @@ namespace Asura
     };
 
     template <unsigned char E>
-    concept ELFClassSupported = E == ELFIO::ELFCLASS32
+    concept ELFClassSupported = E == ELF::ELFCLASS32
 #ifndef ENVIRONMENT32
-                                or E == ELFIO::ELFCLASS64
+                                or E == ELF::ELFCLASS64
 #endif
       ;
 
     /**
-     * Manual maps a statically link ELF into a process.
+     * Manual maps an ELF into a process.
+     * Position independent ones are relocated, their imports resolved
+     * against the modules the process already has.
      * TODO:
-     * Support dynamic libs.
+     * Load the libraries needed that aren't there yet.
      */
     class Kokabiel
     {
@@ -42,6 +48,123 @@ namespace Asura
         };
 
       public:
+        /**
+         * A loadable segment, viewed inside the mapped file instead of
+         * being copied.
+         * Its pages are the file's data at start + data_offset, the rest
+         * up to size being zeroes, which the freshly allocated image
+         * already is.
+         */
+        struct Segment
+        {
+            /* Page aligned, from the file's virtual addresses */
+            std::uintptr_t start;
+            std::size_t size;
+            std::size_t data_offset;
+            std::span<const byte_t> data;
+            mapf_t flags;
+            /**
+             * Relocations write inside that many bytes from data's
+             * start, which can go past the data. 0 when none does.
+             */
+            std::size_t relocated_size;
+        };
+
+        /**
+         * What the relocations of the file become once the machine's
+         * types are known.
+         */
+        struct Relocation
+        {
+            enum class Type : std::uint8_t
+            {
+                /* Image's offset + addend */
+                Relative,
+                /* Symbol's address + addend */
+                Symbol
+            };
+
+            /* File's virtual address of the word to write */
+            std::uintptr_t offset;
+            std::uint32_t segment_index;
+            std::uint32_t symbol_index;
+            Type type;
+            /* Already read from the file for REL */
+            std::int64_t addend;
+        };
+
+        /* A dynamic symbol used by the relocations */
+        struct Symbol
+        {
+            std::string_view name;
+            /* Asked for by an import (DT_VERNEED), empty when none is */
+            std::string_view version;
+            /* Inside the image, else found inside the process */
+            bool defined;
+            /* Can stay unresolved */
+            bool weak;
+            std::uintptr_t value;
+        };
+
+        /**
+         * The file mapped once and what's parsed from it.
+         * Nothing changes after the construction, so it can be shared
+         * by any number of injections, from any threads.
+         */
+        class Image
+        {
+          public:
+            explicit Image(const std::string& fileName);
+
+            Image(const Image&)                    = delete;
+            auto operator=(const Image&) -> Image& = delete;
+
+          public:
+            auto file() const -> const MappedFile&;
+            auto type() const -> std::uint16_t;
+            auto elfClass() const -> std::uint8_t;
+            auto entryPoint() const -> std::uintptr_t;
+            /* Sorted by address */
+            auto segments() const -> const std::vector<Segment>&;
+            auto relocations() const -> const std::vector<Relocation>&;
+            /* Indexed like the dynamic symbol table, up to the last used */
+            auto symbols() const -> const std::vector<Symbol>&;
+            auto size() const -> std::size_t;
+
+          private:
+            template <ELF::IntType T>
+            auto loadSegments() -> void;
+
+            template <ELF::IntType T>
+            auto loadRelocations(const ELF::Elf_Ehdr<T>& elfHeader)
+              -> void;
+
+            /* Where a virtual address is inside the file, if it is */
+            template <ELF::IntType T>
+            auto fileOffset(const ELF::Elf_Ehdr<T>& elfHeader,
+                            const std::uintptr_t address) const
+              -> std::optional<std::size_t>;
+
+          private:
+            MappedFile _file;
+            std::uint16_t _type;
+            std::uint8_t _elf_class;
+            std::uintptr_t _entry_point {};
+            std::vector<Segment> _segments;
+            std::vector<Relocation> _relocations;
+            std::vector<Symbol> _symbols;
+            std::size_t _size {};
+        };
+
+        /* Nanoseconds spent in each phase of an injection */
+        struct Timings
+        {
+            std::uint64_t alloc;
+            std::uint64_t write;
+            std::uint64_t protect;
+            std::uint64_t start;
+        };
+
         struct InjectionInfo
         {
             struct
@@ -50,11 +173,37 @@ namespace Asura
                 MemoryArea env_data;
             } allocated_mem;
 
+            std::shared_ptr<const Image> image;
+            std::uintptr_t image_base;
             std::uintptr_t offset_image;
             std::uintptr_t entry_point;
             std::uintptr_t stack_start;
-            std::vector<MemoryArea> loaded_segments;
             ProcessMemoryMap process_memory_map;
+            Timings timings {};
+        };
+
+        /* One target of injectBatch */
+        template <std::size_t N>
+        struct Job
+        {
+            process_id_t pid;
+            InjectionInfo injection_info;
+            /**
+             * Only set once running, what a failed injection allocated
+             * inside the process is freed.
+             */
+            std::optional<RunnableTask<N>> task;
+            /* Empty when everything went fine */
+            std::string error;
+        };
+
+        /* An image mapped inside our own process, see mapLocal() */
+        struct LocalMapping
+        {
+            std::shared_ptr<const Image> image;
+            std::uintptr_t image_base;
+            std::uintptr_t offset_image;
+            std::uintptr_t entry_point;
         };
 
         enum class arch
@@ -63,6 +212,7 @@ namespace Asura
         };
 
         Kokabiel(const std::string& fileName);
+        explicit Kokabiel(std::shared_ptr<const Image> image);
 
         template <std::size_t N, arch A>
         auto inject(ProcessMemoryMap& processMemoryMap,
@@ -71,10 +221,71 @@ namespace Asura
                     RunnableTask<N>& runnableTask,
                     InjectionInfo& injectionInfo) const -> void;
 
+        /**
+         * Injects and starts the image inside every processes, spread
+         * over threadCount threads (one per core when 0).
+         * A failing process doesn't stop the others, see Job::error.
+         */
+        template <std::size_t N, arch A>
+        auto injectBatch(const std::vector<process_id_t>& pids,
+                         const std::vector<std::string>& cmdLine,
+                         const std::vector<std::string>& env,
+                         std::size_t threadCount = 0) const
+          -> std::vector<Job<N>>;
+
+        /* What wasn't allocated yet is skipped */
         auto freeInjection(InjectionInfo& injectionInfo) const -> void;
 
+        /**
+         * Maps the image inside our own process, without any custom
+         * system calls.
+         * Segments are mapped privately from the file, so pages never
+         * written stay shared with every other mappings of the file.
+         * Only the pages of writable segments and the ones relocated
+         * get copied, when they're written to.
+         * Imports are resolved against our own modules.
+         */
+        auto mapLocal(LocalMapping& localMapping) const -> void;
+        auto unmapLocal(LocalMapping& localMapping) const -> void;
+
+        auto image() const -> const std::shared_ptr<const Image>&;
+
       private:
-        auto loadSegments() -> void;
+        /* Adds the time spent inside its scope to a phase */
+        class PhaseTimer
+        {
+          public:
+            explicit PhaseTimer(std::uint64_t& phase);
+            ~PhaseTimer();
+
+          private:
+            std::uint64_t& _phase;
+            Timer _timer;
+        };
+
+      private:
+        /**
+         * Addresses of every symbols, indexed like Image::symbols(),
+         * the undefined ones found inside the modules.
+         */
+        auto resolveSymbols(const ModuleIndex& moduleIndex,
+                            const std::uintptr_t offsetImage) const
+          -> std::vector<std::uintptr_t>;
+
+        /**
+         * Writes every relocations, destinations being where each
+         * segment's data is.
+         */
+        template <unsigned char E>
+        requires(ELFClassSupported<E>) auto applyRelocations(
+          const std::uintptr_t offsetImage,
+          const std::vector<std::uintptr_t>& symbolAddresses,
+          const std::vector<byte_t*>& destinations) const -> void;
+
+        template <std::size_t N, arch A>
+        auto injectJob(const std::vector<std::string>& cmdLine,
+                       const std::vector<std::string>& env,
+                       Job<N>& job) const -> void;
 
         template <unsigned char E>
         requires(ELFClassSupported<E>) auto relocateSegments(
@@ -94,9 +305,7 @@ namespace Asura
           InjectionInfo& injectionInfo) const -> void;
 
       private:
-        ELFIO::elfio _elf;
-        std::vector<MemoryArea> _loadable_segments;
-        std::size_t _image_size;
+        std::shared_ptr<const Image> _image;
     };
 
     template <std::size_t N, Kokabiel::arch A>
@@ -106,8 +315,8 @@ namespace Asura
                           RunnableTask<N>& runnableTask,
                           InjectionInfo& injectionInfo) const -> void
     {
-        if (_elf.get_type() != ELFIO::ET_DYN
-            and _elf.get_type() != ELFIO::ET_EXEC)
+        if (_image->type() != ELF::ET_DYN
+            and _image->type() != ELF::ET_EXEC)
         {
             ASURA_EXCEPTION("Elf must be dynamic library or "
                             "executable");
@@ -115,127 +324,327 @@ namespace Asura
 
         injectionInfo.process_memory_map = processMemoryMap;
 
-        if (_elf.get_class() == ELFIO::ELFCLASS32)
+        if (_image->elfClass() == ELF::ELFCLASS32)
         {
-            relocateSegments<ELFIO::ELFCLASS32>(injectionInfo);
+            relocateSegments<ELF::ELFCLASS32>(injectionInfo);
 
-            createEnv<ELFIO::ELFCLASS32, N>(cmdLine,
-                                            env,
-                                            runnableTask,
-                                            injectionInfo);
+            createEnv<ELF::ELFCLASS32, N>(cmdLine,
+                                          env,
+                                          runnableTask,
+                                          injectionInfo);
 
-            createShellCode<ELFIO::ELFCLASS32, N, A>(cmdLine,
-                                                     runnableTask,
-                                                     injectionInfo);
+            createShellCode<ELF::ELFCLASS32, N, A>(cmdLine,
+                                                   runnableTask,
+                                                   injectionInfo);
         }
 #ifndef ENVIRONMENT32
         else
         {
-            relocateSegments<ELFIO::ELFCLASS64>(injectionInfo);
+            relocateSegments<ELF::ELFCLASS64>(injectionInfo);
 
-            createEnv<ELFIO::ELFCLASS64, N>(cmdLine,
-                                            env,
-                                            runnableTask,
-                                            injectionInfo);
+            createEnv<ELF::ELFCLASS64, N>(cmdLine,
+                                          env,
+                                          runnableTask,
+                                          injectionInfo);
 
-            createShellCode<ELFIO::ELFCLASS64, N, A>(cmdLine,
-                                                     runnableTask,
-                                                     injectionInfo);
+            createShellCode<ELF::ELFCLASS64, N, A>(cmdLine,
+                                                   runnableTask,
+                                                   injectionInfo);
         }
 #endif
     }
 
+    template <std::size_t N, Kokabiel::arch A>
+    auto Kokabiel::injectBatch(const std::vector<process_id_t>& pids,
+                               const std::vector<std::string>& cmdLine,
+                               const std::vector<std::string>& env,
+                               std::size_t threadCount) const
+      -> std::vector<Job<N>>
+    {
+        std::vector<Job<N>> jobs(pids.size());
+
+        for (std::size_t i = 0; i < pids.size(); i++)
+        {
+            jobs[i].pid = pids[i];
+        }
+
+        if (threadCount == 0)
+        {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        threadCount = std::min(threadCount, jobs.size());
+
+        /* Each job is only touched by one thread, the image by all */
+        std::atomic_size_t next_index {};
+        std::vector<std::thread> threads(threadCount);
+
+        for (auto&& thread : threads)
+        {
+            thread = std::thread(
+              [&]()
+              {
+                  for (auto index = next_index++; index < jobs.size();
+                       index      = next_index++)
+                  {
+                      injectJob<N, A>(cmdLine, env, jobs[index]);
+                  }
+              });
+        }
+
+        for (auto&& thread : threads)
+        {
+            thread.join();
+        }
+
+        return jobs;
+    }
+
+    template <std::size_t N, Kokabiel::arch A>
+    auto Kokabiel::injectJob(const std::vector<std::string>& cmdLine,
+                             const std::vector<std::string>& env,
+                             Job<N>& job) const -> void
+    {
+        std::optional<RunnableTask<N>> task;
+
+        try
+        {
+            Process process(job.pid);
+
+            auto& timings = job.injection_info.timings;
+
+            {
+                const PhaseTimer phase_timer(timings.alloc);
+                task.emplace(process.createTask<N>(nullptr));
+            }
+
+            inject<N, A>(process.mmap(),
+                         cmdLine,
+                         env,
+                         *task,
+                         job.injection_info);
+
+            {
+                const PhaseTimer phase_timer(timings.start);
+                task->template run<true>();
+            }
+
+            job.task = std::move(task);
+            return;
+        }
+        catch (const Exception& e)
+        {
+            job.error = e.msg();
+        }
+        catch (const std::exception& e)
+        {
+            job.error = e.what();
+        }
+
+        /* Best effort, the process may be gone already */
+        if (task)
+        {
+            try
+            {
+                task->freeStack();
+            }
+            catch (const Exception&)
+            {
+            }
+        }
+
+        try
+        {
+            freeInjection(job.injection_info);
+        }
+        catch (const Exception&)
+        {
+        }
+    }
+
     template <unsigned char E>
 
     requires(ELFClassSupported<E>) auto Kokabiel::relocateSegments(
       InjectionInfo& injectionInfo) const -> void
     {
-        /* Only copy previous segments for multi-threading */
-        injectionInfo.loaded_segments = _loadable_segments;
+        const auto& segments = _image->segments();
+        auto& timings        = injectionInfo.timings;
+
+        /* Only the image is shared, nothing gets copied from it */
+        injectionInfo.image = _image;
 
         std::uintptr_t image_base = 0;
 
-        if (_elf.get_type() == ELFIO::ET_EXEC)
         {
-            image_base = view_as<std::uintptr_t>(
-              injectionInfo.process_memory_map.allocArea(
-                injectionInfo.loaded_segments.begin()->start,
-                _image_size,
-                Asura::MemoryArea::ProtectionFlags::RW));
+            const PhaseTimer phase_timer(timings.alloc);
 
-            if (image_base == 0
-                or (image_base
-                    != injectionInfo.loaded_segments.begin()->start))
+            if (_image->type() == ELF::ET_EXEC)
             {
-                ASURA_EXCEPTION("Could not allocate image");
+                image_base = view_as<std::uintptr_t>(
+                  injectionInfo.process_memory_map.allocArea(
+                    segments.begin()->start,
+                    _image->size(),
+                    Asura::MemoryArea::ProtectionFlags::RW));
+
+                if (image_base == 0
+                    or image_base != segments.begin()->start)
+                {
+                    ASURA_EXCEPTION("Could not allocate image");
+                }
+            }
+            else
+            {
+                image_base = view_as<std::uintptr_t>(
+                  injectionInfo.process_memory_map.allocArea(
+                    0,
+                    _image->size(),
+                    Asura::MemoryArea::ProtectionFlags::RW));
+
+                if (image_base == 0)
+                {
+                    ASURA_EXCEPTION("Could not allocate image");
+                }
             }
         }
-        else
+
+        injectionInfo.image_base = image_base;
+
+        /* Calculate offset between base image and new image */
+        injectionInfo.offset_image = image_base - segments.begin()->start;
+
+        /* Setup entry point */
+        injectionInfo.entry_point = _image->entryPoint()
+                                    + injectionInfo.offset_image;
+
+        /**
+         * Segments having relocations are copied and relocated here,
+         * the others are written straight from the mapped file.
+         */
+        std::vector<bytes_t> relocated_data(segments.size());
+
+        if (not _image->relocations().empty())
         {
-            image_base = view_as<std::uintptr_t>(
-              injectionInfo.process_memory_map.allocArea(
-                0,
-                _image_size,
-                Asura::MemoryArea::ProtectionFlags::RW));
+            ModuleIndex module_index;
+            module_index.update(
+              injectionInfo.process_memory_map.areaTable());
+            module_index.readLoadOrder(
+              injectionInfo.process_memory_map.processBase().id());
+
+            std::vector<byte_t*> destinations(segments.size());
 
-            if (image_base == 0)
+            for (std::size_t i = 0; i < segments.size(); i++)
             {
-                ASURA_EXCEPTION("Could not allocate image");
+                const auto& segment = segments[i];
+
+                if (segment.relocated_size == 0)
+                {
+                    continue;
+                }
+
+                relocated_data[i].resize(segment.relocated_size);
+
+                std::copy(segment.data.begin(),
+                          segment.data.end(),
+                          relocated_data[i].begin());
+
+                destinations[i] = relocated_data[i].data();
             }
+
+            applyRelocations<E>(
+              injectionInfo.offset_image,
+              resolveSymbols(module_index, injectionInfo.offset_image),
+              destinations);
         }
 
-        /* Calculate offset between base image and new image */
-        injectionInfo.offset_image = image_base
-                                     - _loadable_segments.begin()->start;
+        /* In one go, the zero filled tails are already there */
+        MemoryUtils::transfers_t transfers;
+        transfers.reserve(segments.size());
 
-        for (auto&& segment : injectionInfo.loaded_segments)
+        for (std::size_t i = 0; i < segments.size(); i++)
         {
-            segment.start += injectionInfo.offset_image;
+            const auto& segment = segments[i];
+
+            const auto remote = segment.start + segment.data_offset
+                                + injectionInfo.offset_image;
+
+            if (not relocated_data[i].empty())
+            {
+                transfers.push_back(
+                  { .local  = relocated_data[i].data(),
+                    .remote = remote,
+                    .size   = relocated_data[i].size() });
+            }
+            else if (not segment.data.empty())
+            {
+                transfers.push_back(
+                  { .local  = view_as<ptr_t>(segment.data.data()),
+                    .remote = remote,
+                    .size   = segment.data.size() });
+            }
         }
 
-        /* Setup entry point */
-        injectionInfo.entry_point = _elf.get_entry()
-                                    + injectionInfo.offset_image;
+        {
+            const PhaseTimer phase_timer(timings.write);
+            injectionInfo.process_memory_map.write(transfers);
+        }
 
-        /* Relocate image if possible */
-        for (const auto& section : _elf.sections)
+        /* The map is only refreshed once every segments are protected */
         {
-            const auto sec_type = section->get_type();
+            const PhaseTimer phase_timer(timings.protect);
 
-            /**
-             * TODO: ?
-             * Dynamic executables are not supported due to the fact
-             * that a process could not have ld.so loaded. We might
-             * end up loading ourselves at the end, though it is a
-             * quite long task.
-             */
-            if (sec_type == ELFIO::SHT_DYNSYM)
+            for (const auto& segment : segments)
             {
-                /**
-                 * I don't know why (yet), but it according to ELF,
-                 * there can be one useless smybol and section
-                 * ELFIO::SHT_DYNSYM always exists
-                 * ... Does not happen with static executables though.
-                 */
-                if (ELFIO::const_symbol_section_accessor(_elf, section)
-                      .get_symbols_num()
-                    > 1)
-                {
-                    ASURA_EXCEPTION("Should not get any dynamic symbols "
-                                    "inside the elf, it is not supported "
-                                    "yet.");
-                }
+                MemoryUtils::ProtectMemoryArea(
+                  injectionInfo.process_memory_map.processBase().id(),
+                  segment.start + injectionInfo.offset_image,
+                  segment.size,
+                  segment.flags);
             }
+
+            injectionInfo.process_memory_map.refresh();
         }
+    }
 
-        for (const auto& segment : injectionInfo.loaded_segments)
+    template <unsigned char E>
+
+    requires(ELFClassSupported<E>) auto Kokabiel::applyRelocations(
+      const std::uintptr_t offsetImage,
+      const std::vector<std::uintptr_t>& symbolAddresses,
+      const std::vector<byte_t*>& destinations) const -> void
+    {
+        constexpr auto _reloc_ptr = []()
         {
-            injectionInfo.process_memory_map.write(segment.start,
-                                                   segment.bytes);
-            injectionInfo.process_memory_map.protectMemoryArea(
-              segment.start,
-              segment.bytes.size(),
-              segment.flags);
+            if constexpr (E == ELF::ELFCLASS32)
+            {
+                return type_wrapper<std::uint32_t>;
+            }
+            else if constexpr (E == ELF::ELFCLASS64)
+            {
+                return type_wrapper<std::uint64_t>;
+            }
+        }();
+
+        using reloc_ptr_t = typename decltype(_reloc_ptr)::type;
+
+        const auto& segments = _image->segments();
+
+        for (const auto& relocation : _image->relocations())
+        {
+            const auto& segment = segments[relocation.segment_index];
+
+            const auto base = (relocation.type
+                               == Relocation::Type::Relative) ?
+                                offsetImage :
+                                symbolAddresses[relocation.symbol_index];
+
+            const auto value = view_as<reloc_ptr_t>(
+              base + view_as<std::uintptr_t>(relocation.addend));
+
+            std::memcpy(destinations[relocation.segment_index]
+                          + (relocation.offset - segment.start
+                             - segment.data_offset),
+                        &value,
+                        sizeof(value));
         }
     }
 
@@ -249,11 +658,11 @@ namespace Asura
     {
         constexpr auto _reloc_ptr = []()
         {
-            if constexpr (E == ELFIO::ELFCLASS32)
+            if constexpr (E == ELF::ELFCLASS32)
             {
                 return type_wrapper<std::uint32_t>;
             }
-            else if constexpr (E == ELFIO::ELFCLASS64)
+            else if constexpr (E == ELF::ELFCLASS64)
             {
                 return type_wrapper<std::uint64_t>;
             }
@@ -299,12 +708,16 @@ namespace Asura
                                       runnableTask.baseStack())
                                     + N;
 
-        injectionInfo.allocated_mem.env_data.start = view_as<
-          std::uintptr_t>(injectionInfo.process_memory_map.allocArea(
-          nullptr,
-          injectionInfo.allocated_mem.env_data.bytes.size()
-            + MemoryUtils::GetPageSize(),
-          Asura::MemoryArea::ProtectionFlags::RW));
+        {
+            const PhaseTimer phase_timer(injectionInfo.timings.alloc);
+
+            injectionInfo.allocated_mem.env_data.start = view_as<
+              std::uintptr_t>(injectionInfo.process_memory_map.allocArea(
+              nullptr,
+              injectionInfo.allocated_mem.env_data.bytes.size()
+                + MemoryUtils::GetPageSize(),
+              Asura::MemoryArea::ProtectionFlags::RW));
+        }
 
         if (injectionInfo.allocated_mem.env_data.start == 0)
         {
@@ -312,11 +725,6 @@ namespace Asura
                             "data");
         }
 
-        /* write argv + envp */
-        injectionInfo.process_memory_map.write(
-          view_as<ptr_t>(injectionInfo.allocated_mem.env_data.start),
-          injectionInfo.allocated_mem.env_data.bytes);
-
         const auto at_random = injectionInfo.allocated_mem.env_data.start
                                + total_offset;
 
@@ -335,14 +743,10 @@ namespace Asura
             return data;
         }();
 
-        injectionInfo.process_memory_map.write(
-          *view_as<ptr_t*>(&at_random),
-          random_bytes);
-
         /* Setup auxiliary vectors */
         const Elf_auxv<reloc_ptr_t> elf_aux[2] {
-            {  ELFIO::AT_NULL,                                  { 0 }},
-            {ELFIO::AT_RANDOM, { *view_as<reloc_ptr_t*>(&at_random) }}
+            {  ELF::AT_NULL,                                  { 0 }},
+            {ELF::AT_RANDOM, { *view_as<reloc_ptr_t*>(&at_random) }}
         };
 
         /* glibc keeps fucking changing stuffs, makes me loose time.
@@ -359,26 +763,21 @@ namespace Asura
 
         injectionInfo.stack_start += 0x8 - handle_argc_push;
 
-        /* write aux vecs */
-        for (std::size_t i = 0; i < 2; i++)
-        {
-            injectionInfo.stack_start -= sizeof(Elf_auxv<reloc_ptr_t>);
+        /**
+         * Pushed from the top of the stack like they would be one by
+         * one, then reversed to be written at once.
+         */
+        std::vector<reloc_ptr_t> stack_words;
 
-            injectionInfo.process_memory_map.write(
-              view_as<ptr_t>(injectionInfo.stack_start),
-              &elf_aux[i],
-              sizeof(Elf_auxv<reloc_ptr_t>));
+        /* aux vecs */
+        for (const auto& aux : elf_aux)
+        {
+            stack_words.push_back(aux.a_un.a_val);
+            stack_words.push_back(aux.a_type);
         }
 
-        const static reloc_ptr_t null_address = 0;
-
-        /* write null address for limiting enp */
-        injectionInfo.stack_start -= sizeof(reloc_ptr_t);
-
-        injectionInfo.process_memory_map.write(
-          view_as<ptr_t>(injectionInfo.stack_start),
-          &null_address,
-          sizeof(null_address));
+        /* null address for limiting enp */
+        stack_words.push_back(0);
 
         /**
          * Env exists ? if yes we write env addresss to stack after
@@ -386,37 +785,41 @@ namespace Asura
          */
         for (const auto& env_offset : envs_offsets)
         {
-            injectionInfo.stack_start -= sizeof(reloc_ptr_t);
+            stack_words.push_back(view_as<reloc_ptr_t>(
+              injectionInfo.allocated_mem.env_data.start + env_offset));
+        }
 
-            const auto address_of_string = view_as<reloc_ptr_t>(
-              injectionInfo.allocated_mem.env_data.start + env_offset);
+        /* null address for limiting argv */
+        stack_words.push_back(0);
 
-            injectionInfo.process_memory_map.write(
-              view_as<ptr_t>(injectionInfo.stack_start),
-              &address_of_string,
-              sizeof(address_of_string));
+        for (const auto& cmd_offset : cmds_offsets)
+        {
+            stack_words.push_back(view_as<reloc_ptr_t>(
+              injectionInfo.allocated_mem.env_data.start + cmd_offset));
         }
 
-        /* write null address for limiting argv */
-        injectionInfo.stack_start -= sizeof(reloc_ptr_t);
+        std::reverse(stack_words.begin(), stack_words.end());
 
-        injectionInfo.process_memory_map.write(
-          view_as<ptr_t>(injectionInfo.stack_start),
-          &null_address,
-          sizeof(null_address));
+        injectionInfo.stack_start -= stack_words.size()
+                                     * sizeof(reloc_ptr_t);
 
-        for (const auto& cmd_offset : cmds_offsets)
-        {
-            injectionInfo.stack_start -= sizeof(reloc_ptr_t);
+        /* argv + envp, AT_RANDOM bytes and the stack */
+        auto& env_data = injectionInfo.allocated_mem.env_data;
 
-            const auto address_of_string = view_as<reloc_ptr_t>(
-              injectionInfo.allocated_mem.env_data.start + cmd_offset);
+        const MemoryUtils::transfers_t transfers {
+            { .local  = env_data.bytes.data(),
+              .remote = env_data.start,
+              .size   = env_data.bytes.size() },
+            { .local  = view_as<ptr_t>(random_bytes.data()),
+              .remote = at_random,
+              .size   = random_bytes.size() },
+            { .local  = stack_words.data(),
+              .remote = injectionInfo.stack_start,
+              .size   = stack_words.size() * sizeof(reloc_ptr_t) }
+        };
 
-            injectionInfo.process_memory_map.write(
-              view_as<ptr_t>(injectionInfo.stack_start),
-              &address_of_string,
-              sizeof(address_of_string));
-        }
+        const PhaseTimer phase_timer(injectionInfo.timings.write);
+        injectionInfo.process_memory_map.write(transfers);
     }
 
     template <unsigned char E, std::size_t N, Kokabiel::arch A>
@@ -428,11 +831,11 @@ namespace Asura
     {
         constexpr auto _reloc_ptr = []()
         {
-            if constexpr (E == ELFIO::ELFCLASS32)
+            if constexpr (E == ELF::ELFCLASS32)
             {
                 return type_wrapper<std::uint32_t>;
             }
-            else if constexpr (E == ELFIO::ELFCLASS64)
+            else if constexpr (E == ELF::ELFCLASS64)
             {
                 return type_wrapper<std::uint64_t>;
             }
@@ -442,7 +845,7 @@ namespace Asura
 
         if constexpr (A == arch::X86)
         {
-            if constexpr (E == ELFIO::ELFCLASS64)
+            if constexpr (E == ELF::ELFCLASS64)
             {
                 /**
                  * "movabs rax, 0; mov rsp, rax; movabs rax, 0; push rax;
@@ -471,7 +874,7 @@ namespace Asura
                   &injectionInfo.allocated_mem.shellcode.bytes[2])
                   = injectionInfo.stack_start;
             }
-            else if constexpr (E == ELFIO::ELFCLASS32)
+            else if constexpr (E == ELF::ELFCLASS32)
             {
                 /**
                  * "mov eax, 0; mov esp, eax; mov eax, 0; push eax; mov
@@ -515,20 +918,34 @@ namespace Asura
          * own process is 32 bits.
          */
 
-        injectionInfo.allocated_mem.shellcode.start = view_as<
-          std::uintptr_t>(injectionInfo.process_memory_map.allocArea(
-          nullptr,
-          injectionInfo.allocated_mem.shellcode.bytes.size(),
-          Asura::MemoryArea::ProtectionFlags::RW));
+        auto& timings = injectionInfo.timings;
 
-        injectionInfo.process_memory_map.write(
-          view_as<ptr_t>(injectionInfo.allocated_mem.shellcode.start),
-          injectionInfo.allocated_mem.shellcode.bytes);
+        {
+            const PhaseTimer phase_timer(timings.alloc);
+
+            injectionInfo.allocated_mem.shellcode.start = view_as<
+              std::uintptr_t>(injectionInfo.process_memory_map.allocArea(
+              nullptr,
+              injectionInfo.allocated_mem.shellcode.bytes.size(),
+              Asura::MemoryArea::ProtectionFlags::RW));
+        }
+
+        {
+            const PhaseTimer phase_timer(timings.write);
+
+            injectionInfo.process_memory_map.write(
+              view_as<ptr_t>(injectionInfo.allocated_mem.shellcode.start),
+              injectionInfo.allocated_mem.shellcode.bytes);
+        }
+
+        {
+            const PhaseTimer phase_timer(timings.protect);
 
-        injectionInfo.process_memory_map.protectMemoryArea(
-          injectionInfo.allocated_mem.shellcode.start,
-          injectionInfo.allocated_mem.shellcode.bytes.size(),
-          Asura::MemoryArea::ProtectionFlags::RX);
+            injectionInfo.process_memory_map.protectMemoryArea(
+              injectionInfo.allocated_mem.shellcode.start,
+              injectionInfo.allocated_mem.shellcode.bytes.size(),
+              Asura::MemoryArea::ProtectionFlags::RX);
+        }
 
         runnableTask.routineAddress() = view_as<ptr_t>(
           injectionInfo.allocated_mem.shellcode.start);
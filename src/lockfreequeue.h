@@ -0,0 +1,87 @@
+#ifndef ASURA_LOCKFREEQUEUE_H
+#define ASURA_LOCKFREEQUEUE_H
+
+#include "types.h"
+
+namespace Asura
+{
+    /**
+     * Bounded queue for one producer thread and one consumer thread,
+     * neither of them ever waits for the other.
+     */
+    template <typename T, std::size_t N>
+    class LockFreeQueue
+    {
+        static_assert(N > 0 and (N & (N - 1)) == 0,
+                      "N must be a power of two");
+
+        /* Keeps the producer and the consumer on their own cache lines */
+        static constexpr inline std::size_t CACHE_LINE_SIZE = 64;
+
+      public:
+        auto size() const -> std::size_t;
+        auto empty() const -> bool;
+
+      public:
+        /* Producer side, returns false when the queue is full */
+        auto push(const T& element) -> bool;
+        /* Consumer side, returns false when the queue is empty */
+        auto pop(T& element) -> bool;
+
+      private:
+        alignas(CACHE_LINE_SIZE) std::atomic_size_t _head {};
+        alignas(CACHE_LINE_SIZE) std::atomic_size_t _tail {};
+        alignas(CACHE_LINE_SIZE) std::array<T, N> _elements {};
+    };
+
+    template <typename T, std::size_t N>
+    auto LockFreeQueue<T, N>::size() const -> std::size_t
+    {
+        return _tail.load(std::memory_order_acquire)
+               - _head.load(std::memory_order_acquire);
+    }
+
+    template <typename T, std::size_t N>
+    auto LockFreeQueue<T, N>::empty() const -> bool
+    {
+        return size() == 0;
+    }
+
+    template <typename T, std::size_t N>
+    auto LockFreeQueue<T, N>::push(const T& element) -> bool
+    {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+
+        if (tail - _head.load(std::memory_order_acquire) == N)
+        {
+            return false;
+        }
+
+        _elements[tail & (N - 1)] = element;
+
+        /* Publishes the element to the consumer */
+        _tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    template <typename T, std::size_t N>
+    auto LockFreeQueue<T, N>::pop(T& element) -> bool
+    {
+        const auto head = _head.load(std::memory_order_relaxed);
+
+        if (head == _tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        element = _elements[head & (N - 1)];
+
+        /* Gives the slot back to the producer */
+        _head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+}
+
+#endif
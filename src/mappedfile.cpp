@@ -0,0 +1,214 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "mappedfile.h"
+
+using namespace Asura;
+
+MappedFile::MappedFile(const std::string& path)
+ : _path(path)
+{
+#ifndef WINDOWS
+    const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        ASURA_EXCEPTION("Couldn't open file " + path);
+    }
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) < 0)
+    {
+        close(fd);
+        ASURA_EXCEPTION("Couldn't stat file " + path);
+    }
+
+    _size              = view_as<std::size_t>(file_stat.st_size);
+    _inode             = file_stat.st_ino;
+    _modification_time = view_as<std::uint64_t>(file_stat.st_mtim.tv_sec)
+                           * 1'000'000'000
+                         + view_as<std::uint64_t>(
+                           file_stat.st_mtim.tv_nsec);
+
+    /* Can't map nothing */
+    if (_size != 0)
+    {
+        const auto data = mmap(nullptr,
+                               _size,
+                               PROT_READ,
+                               MAP_PRIVATE,
+                               fd,
+                               0);
+
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            ASURA_EXCEPTION("Couldn't map file " + path);
+        }
+
+        _data = view_as<const byte_t*>(data);
+    }
+
+    /* The mapping keeps the file */
+    close(fd);
+#else
+    _file_handle = CreateFileA(path.c_str(),
+                               GENERIC_READ,
+                               FILE_SHARE_READ,
+                               nullptr,
+                               OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL,
+                               nullptr);
+
+    if (_file_handle == INVALID_HANDLE_VALUE)
+    {
+        ASURA_EXCEPTION("Couldn't open file " + path);
+    }
+
+    BY_HANDLE_FILE_INFORMATION file_info;
+
+    if (not GetFileInformationByHandle(_file_handle, &file_info))
+    {
+        release();
+        ASURA_EXCEPTION("Couldn't get informations of file " + path);
+    }
+
+    _size = (view_as<std::size_t>(file_info.nFileSizeHigh) << 32)
+            | file_info.nFileSizeLow;
+    _inode = (view_as<std::uint64_t>(file_info.nFileIndexHigh) << 32)
+             | file_info.nFileIndexLow;
+    _modification_time = (view_as<std::uint64_t>(
+                            file_info.ftLastWriteTime.dwHighDateTime)
+                          << 32)
+                         | file_info.ftLastWriteTime.dwLowDateTime;
+
+    if (_size != 0)
+    {
+        _mapping_handle = CreateFileMappingA(_file_handle,
+                                             nullptr,
+                                             PAGE_READONLY,
+                                             0,
+                                             0,
+                                             nullptr);
+
+        if (_mapping_handle == nullptr)
+        {
+            release();
+            ASURA_EXCEPTION("Couldn't map file " + path);
+        }
+
+        _data = view_as<const byte_t*>(
+          MapViewOfFile(_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+
+        if (_data == nullptr)
+        {
+            release();
+            ASURA_EXCEPTION("Couldn't map file " + path);
+        }
+    }
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+auto MappedFile::path() const -> const std::string&
+{
+    return _path;
+}
+
+auto MappedFile::data() const -> const byte_t*
+{
+    return _data;
+}
+
+auto MappedFile::size() const -> std::size_t
+{
+    return _size;
+}
+
+auto MappedFile::modificationTime() const -> std::uint64_t
+{
+    return _modification_time;
+}
+
+auto MappedFile::inode() const -> std::uint64_t
+{
+    return _inode;
+}
+
+auto MappedFile::isStale() const -> bool
+{
+#ifndef WINDOWS
+    struct stat file_stat;
+
+    if (stat(_path.c_str(), &file_stat) < 0)
+    {
+        return true;
+    }
+
+    const auto modification_time = view_as<std::uint64_t>(
+                                     file_stat.st_mtim.tv_sec)
+                                     * 1'000'000'000
+                                   + view_as<std::uint64_t>(
+                                     file_stat.st_mtim.tv_nsec);
+
+    return view_as<std::size_t>(file_stat.st_size) != _size
+           or file_stat.st_ino != _inode
+           or modification_time != _modification_time;
+#else
+    WIN32_FILE_ATTRIBUTE_DATA file_attributes;
+
+    if (not GetFileAttributesExA(_path.c_str(),
+                                 GetFileExInfoStandard,
+                                 &file_attributes))
+    {
+        return true;
+    }
+
+    const auto size = (view_as<std::size_t>(
+                         file_attributes.nFileSizeHigh)
+                       << 32)
+                      | file_attributes.nFileSizeLow;
+    const auto modification_time = (view_as<std::uint64_t>(
+                                      file_attributes.ftLastWriteTime
+                                        .dwHighDateTime)
+                                    << 32)
+                                   | file_attributes.ftLastWriteTime
+                                       .dwLowDateTime;
+
+    return size != _size or modification_time != _modification_time;
+#endif
+}
+
+auto MappedFile::release() -> void
+{
+#ifndef WINDOWS
+    if (_data)
+    {
+        munmap(view_as<void*>(_data), _size);
+        _data = nullptr;
+    }
+#else
+    if (_data)
+    {
+        UnmapViewOfFile(_data);
+        _data = nullptr;
+    }
+
+    if (_mapping_handle)
+    {
+        CloseHandle(_mapping_handle);
+        _mapping_handle = nullptr;
+    }
+
+    if (_file_handle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_file_handle);
+        _file_handle = INVALID_HANDLE_VALUE;
+    }
+#endif
+}
@@ -0,0 +1,66 @@
+#ifndef ASURA_MAPPEDFILE_H
+#define ASURA_MAPPEDFILE_H
+
+#include "types.h"
+
+namespace Asura
+{
+    /**
+     * A whole file mapped read only, pages are only read from the disk
+     * when touched.
+     * What identifies the file (size, modification time, inode) is kept
+     * from when it was opened.
+     */
+    class MappedFile
+    {
+      public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&)                    = delete;
+        auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+      public:
+        auto path() const -> const std::string&;
+        auto data() const -> const byte_t*;
+        auto size() const -> std::size_t;
+        /* Nanoseconds since epoch */
+        auto modificationTime() const -> std::uint64_t;
+        auto inode() const -> std::uint64_t;
+
+        /**
+         * The file at the path changed since it was mapped, the mapping
+         * still has the old content.
+         */
+        auto isStale() const -> bool;
+
+        /* Null when the range goes past the end of the file */
+        template <typename T>
+        auto at(const std::size_t offset,
+                const std::size_t count = 1) const -> const T*
+        {
+            if (offset > _size or count > (_size - offset) / sizeof(T))
+            {
+                return nullptr;
+            }
+
+            return view_as<const T*>(_data + offset);
+        }
+
+      private:
+        auto release() -> void;
+
+      private:
+        std::string _path;
+        const byte_t* _data {};
+        std::size_t _size {};
+        std::uint64_t _modification_time {};
+        std::uint64_t _inode {};
+#ifdef WINDOWS
+        HANDLE _file_handle { INVALID_HANDLE_VALUE };
+        HANDLE _mapping_handle {};
+#endif
+    };
+}
+
+#endif
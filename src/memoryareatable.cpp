@@ -0,0 +1,310 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "memoryareatable.h"
+
+using namespace Asura;
+
+MemoryAreaTable::NamePool::NamePool(const NamePool& namePool)
+ : _names(namePool._names)
+{
+    /* The views must point to our own copies of the names */
+    for (std::size_t i = 0; i < _names.size(); i++)
+    {
+        _ids.emplace(_names[i], view_as<name_id_t>(i));
+    }
+}
+
+auto MemoryAreaTable::NamePool::operator=(const NamePool& namePool)
+  -> NamePool&
+{
+    if (this != &namePool)
+    {
+        *this = NamePool(namePool);
+    }
+
+    return *this;
+}
+
+auto MemoryAreaTable::NamePool::name(const name_id_t nameID) const
+  -> const std::string&
+{
+    return _names[nameID];
+}
+
+auto MemoryAreaTable::NamePool::find(const std::string_view name) const
+  -> std::optional<name_id_t>
+{
+    const auto it = _ids.find(name);
+
+    if (it == _ids.end())
+    {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+
+auto MemoryAreaTable::NamePool::size() const -> std::size_t
+{
+    return _names.size();
+}
+
+auto MemoryAreaTable::NamePool::intern(const std::string_view name)
+  -> name_id_t
+{
+    const auto it = _ids.find(name);
+
+    if (it != _ids.end())
+    {
+        return it->second;
+    }
+
+    const auto name_id = view_as<name_id_t>(_names.size());
+
+    /* std::deque never moves its elements when growing at the back */
+    _names.emplace_back(name);
+    _ids.emplace(_names.back(), name_id);
+
+    return name_id;
+}
+
+MemoryAreaTable::View::View(const MemoryAreaTable* const table,
+                            const std::size_t index)
+ : _table(table),
+   _index(index)
+{
+}
+
+auto MemoryAreaTable::View::index() const -> std::size_t
+{
+    return _index;
+}
+
+auto MemoryAreaTable::View::flags() const -> mapf_t
+{
+    return _table->_flags[_index];
+}
+
+auto MemoryAreaTable::View::nameID() const -> name_id_t
+{
+    return _table->_name_ids[_index];
+}
+
+auto MemoryAreaTable::View::name() const -> const std::string&
+{
+    return _table->_names.name(nameID());
+}
+
+auto MemoryAreaTable::View::fileOffset() const -> std::uint64_t
+{
+    return _table->_file_offsets[_index];
+}
+
+auto MemoryAreaTable::View::inode() const -> std::uint64_t
+{
+    return _table->_inodes[_index];
+}
+
+auto MemoryAreaTable::View::isDeniedByOS() const -> bool
+{
+#ifndef WIN32
+    /* [vvar] and [vvar_vclock] on recent kernels */
+    return name().starts_with("[vvar");
+#else
+    return false;
+#endif
+}
+
+auto MemoryAreaTable::View::isReadable() const -> bool
+{
+    return (flags() & MemoryArea::ProtectionFlags::R)
+           and not isDeniedByOS();
+}
+
+auto MemoryAreaTable::View::isWritable() const -> bool
+{
+    return (flags() & MemoryArea::ProtectionFlags::W)
+           and not isDeniedByOS();
+}
+
+MemoryAreaTable::Iterator::Iterator(const MemoryAreaTable* const table,
+                                    const std::size_t index)
+ : _table(table),
+   _index(index)
+{
+}
+
+auto MemoryAreaTable::Iterator::operator*() const -> View
+{
+    return View(_table, _index);
+}
+
+auto MemoryAreaTable::Iterator::operator!=(const Iterator& iterator) const
+  -> bool
+{
+    return _index != iterator._index;
+}
+
+auto MemoryAreaTable::Iterator::operator++() -> Iterator&
+{
+    _index++;
+
+    return *this;
+}
+
+auto MemoryAreaTable::size() const -> std::size_t
+{
+    return _begins.size();
+}
+
+auto MemoryAreaTable::empty() const -> bool
+{
+    return _begins.empty();
+}
+
+auto MemoryAreaTable::view(const std::size_t index) const -> View
+{
+    return View(this, index);
+}
+
+auto MemoryAreaTable::begin() const -> Iterator
+{
+    return Iterator(this, 0);
+}
+
+auto MemoryAreaTable::end() const -> Iterator
+{
+    return Iterator(this, size());
+}
+
+auto MemoryAreaTable::search(const std::uintptr_t address) const
+  -> std::size_t
+{
+    /* First area that begins after our address */
+    const auto it = std::upper_bound(_begins.begin(),
+                                     _begins.end(),
+                                     address);
+
+    if (it == _begins.begin())
+    {
+        return INVALID_INDEX;
+    }
+
+    const auto index = view_as<std::size_t>(
+      std::distance(_begins.begin(), it) - 1);
+
+    if (address >= _ends[index])
+    {
+        return INVALID_INDEX;
+    }
+
+    return index;
+}
+
+auto MemoryAreaTable::begins() const -> const std::vector<std::uintptr_t>&
+{
+    return _begins;
+}
+
+auto MemoryAreaTable::ends() const -> const std::vector<std::uintptr_t>&
+{
+    return _ends;
+}
+
+auto MemoryAreaTable::flags() const -> const std::vector<mapf_t>&
+{
+    return _flags;
+}
+
+auto MemoryAreaTable::nameIDs() const -> const std::vector<name_id_t>&
+{
+    return _name_ids;
+}
+
+auto MemoryAreaTable::fileOffsets() const
+  -> const std::vector<std::uint64_t>&
+{
+    return _file_offsets;
+}
+
+auto MemoryAreaTable::inodes() const -> const std::vector<std::uint64_t>&
+{
+    return _inodes;
+}
+
+auto MemoryAreaTable::names() const -> const NamePool&
+{
+    return _names;
+}
+
+auto MemoryAreaTable::clear() -> void
+{
+    /* Keep the names, the same ones usually come back on refresh */
+    _begins.clear();
+    _ends.clear();
+    _flags.clear();
+    _name_ids.clear();
+    _file_offsets.clear();
+    _inodes.clear();
+}
+
+auto MemoryAreaTable::reserve(const std::size_t count) -> void
+{
+    _begins.reserve(count);
+    _ends.reserve(count);
+    _flags.reserve(count);
+    _name_ids.reserve(count);
+    _file_offsets.reserve(count);
+    _inodes.reserve(count);
+}
+
+auto MemoryAreaTable::push(const std::uintptr_t begin,
+                           const std::uintptr_t end,
+                           const mapf_t flags,
+                           const std::string_view name,
+                           const std::uint64_t fileOffset,
+                           const std::uint64_t inode) -> void
+{
+    if (not _begins.empty() and begin < _begins.back())
+    {
+        ASURA_EXCEPTION("Areas must be pushed sorted by address");
+    }
+
+    _begins.push_back(begin);
+    _ends.push_back(end);
+    _flags.push_back(flags);
+    _name_ids.push_back(_names.intern(name));
+    _file_offsets.push_back(fileOffset);
+    _inodes.push_back(inode);
+}
+
+auto MemoryAreaTable::compactNames() -> void
+{
+    std::vector<bool> used(_names.size());
+    std::size_t used_count = 0;
+
+    for (const auto name_id : _name_ids)
+    {
+        if (not used[name_id])
+        {
+            used[name_id] = true;
+            used_count++;
+        }
+    }
+
+    /* Amortized, the pool is rebuilt once it doubled */
+    if (_names.size() <= used_count * 2)
+    {
+        return;
+    }
+
+    NamePool names;
+
+    for (auto& name_id : _name_ids)
+    {
+        name_id = names.intern(_names.name(name_id));
+    }
+
+    _names = std::move(names);
+}
@@ -0,0 +1,165 @@
+#ifndef ASURA_MEMORYAREATABLE_H
+#define ASURA_MEMORYAREATABLE_H
+
+#include "memoryarea.h"
+
+namespace Asura
+{
+    /**
+     * Compact representation of a memory map.
+     * Boundaries and protections are stored in contiguous arrays and
+     * names are interned, so walking tens of thousands of areas doesn't
+     * chase a pointer (and a few heap allocations) per area.
+     *
+     * ProcessMemoryMap keeps one next to its ProcessMemoryArea objects,
+     * it is a copy of them, not a view: 40 bytes per area plus each
+     * distinct name once, refilled from the areas on every refresh.
+     * Names nobody uses anymore are dropped by compactNames(), so the
+     * pool doesn't grow with the mappings a long-running process churns
+     * through.
+     * It is a snapshot of the last refresh, a protection changed
+     * through ProcessMemoryArea::protectionFlags() only shows up in it
+     * after the next one.
+     */
+    class MemoryAreaTable
+    {
+      public:
+        using name_id_t = std::uint32_t;
+
+        static constexpr inline std::size_t INVALID_INDEX = std::
+          numeric_limits<std::size_t>::max();
+
+        /**
+         * Names are kept between two refreshes, so their ids stay the
+         * same until MemoryAreaTable::compactNames() drops the unused
+         * ones.
+         */
+        class NamePool
+        {
+          public:
+            NamePool() = default;
+            NamePool(const NamePool& namePool);
+            NamePool(NamePool&& namePool) = default;
+
+            auto operator=(const NamePool& namePool) -> NamePool&;
+            auto operator=(NamePool&& namePool) -> NamePool& = default;
+
+          public:
+            auto name(const name_id_t nameID) const -> const std::string&;
+            auto find(const std::string_view name) const
+              -> std::optional<name_id_t>;
+            auto size() const -> std::size_t;
+
+          public:
+            auto intern(const std::string_view name) -> name_id_t;
+
+          private:
+            std::deque<std::string> _names;
+            std::unordered_map<std::string_view, name_id_t> _ids;
+        };
+
+        /* Lightweight view on an area of the table */
+        class View
+        {
+          public:
+            View(const MemoryAreaTable* const table,
+                 const std::size_t index);
+
+          public:
+            auto index() const -> std::size_t;
+            auto flags() const -> mapf_t;
+            auto nameID() const -> name_id_t;
+            auto name() const -> const std::string&;
+            /* Offset inside the mapped file and its inode, 0 if none */
+            auto fileOffset() const -> std::uint64_t;
+            auto inode() const -> std::uint64_t;
+            auto isDeniedByOS() const -> bool;
+            auto isReadable() const -> bool;
+            auto isWritable() const -> bool;
+
+          public:
+            template <typename T = std::uintptr_t>
+            auto begin() const -> T
+            {
+                return view_as<T>(_table->_begins[_index]);
+            }
+
+            template <typename T = std::uintptr_t>
+            auto end() const -> T
+            {
+                return view_as<T>(_table->_ends[_index]);
+            }
+
+            template <typename T = std::uintptr_t>
+            auto size() const -> T
+            {
+                return view_as<T>(_table->_ends[_index]
+                                  - _table->_begins[_index]);
+            }
+
+          private:
+            const MemoryAreaTable* _table;
+            std::size_t _index;
+        };
+
+        class Iterator
+        {
+          public:
+            Iterator(const MemoryAreaTable* const table,
+                     const std::size_t index);
+
+          public:
+            auto operator*() const -> View;
+            auto operator!=(const Iterator& iterator) const -> bool;
+
+          public:
+            auto operator++() -> Iterator&;
+
+          private:
+            const MemoryAreaTable* _table;
+            std::size_t _index;
+        };
+
+      public:
+        auto size() const -> std::size_t;
+        auto empty() const -> bool;
+        auto view(const std::size_t index) const -> View;
+        auto begin() const -> Iterator;
+        auto end() const -> Iterator;
+        auto search(const std::uintptr_t address) const -> std::size_t;
+        auto begins() const -> const std::vector<std::uintptr_t>&;
+        auto ends() const -> const std::vector<std::uintptr_t>&;
+        auto flags() const -> const std::vector<mapf_t>&;
+        auto nameIDs() const -> const std::vector<name_id_t>&;
+        auto fileOffsets() const -> const std::vector<std::uint64_t>&;
+        auto inodes() const -> const std::vector<std::uint64_t>&;
+        auto names() const -> const NamePool&;
+
+      public:
+        auto clear() -> void;
+        auto reserve(const std::size_t count) -> void;
+        auto push(const std::uintptr_t begin,
+                  const std::uintptr_t end,
+                  const mapf_t flags,
+                  const std::string_view name,
+                  const std::uint64_t fileOffset = 0,
+                  const std::uint64_t inode      = 0) -> void;
+        /**
+         * Rebuilds the name pool with only the names of the current
+         * areas once the unused ones outnumber them.
+         * Name ids may change then.
+         */
+        auto compactNames() -> void;
+
+      private:
+        std::vector<std::uintptr_t> _begins;
+        std::vector<std::uintptr_t> _ends;
+        std::vector<mapf_t> _flags;
+        std::vector<name_id_t> _name_ids;
+        std::vector<std::uint64_t> _file_offsets;
+        std::vector<std::uint64_t> _inodes;
+        NamePool _names;
+    };
+}
+
+#endif
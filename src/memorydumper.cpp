@@ -0,0 +1,407 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "memorydumper.h"
+#include "xkc.h"
+
+using namespace Asura;
+
+MemoryDumper::MemoryDumper(Process& process)
+ : MemoryDumper(process, Options {})
+{
+}
+
+MemoryDumper::MemoryDumper(Process& process, const Options& options)
+ : _process(process),
+   _options(options)
+{
+    if (_options.thread_count == 0)
+    {
+        _options.thread_count = std::max(
+          1u,
+          std::thread::hardware_concurrency());
+    }
+
+    _options.chunk_size = MemoryUtils::AlignToPageSize(
+      std::max(_options.chunk_size, MemoryUtils::GetPageSize()),
+      MemoryUtils::GetPageSize());
+
+    /* A chunk must fit inside its header */
+    _options.chunk_size = std::min<std::size_t>(
+      _options.chunk_size,
+      MemoryUtils::Align(std::numeric_limits<std::uint32_t>::max(),
+                         MemoryUtils::GetPageSize()));
+}
+
+auto MemoryDumper::entries() const -> const std::vector<Entry>&
+{
+    return _entries;
+}
+
+auto MemoryDumper::stats() const -> const Stats&
+{
+    return _stats;
+}
+
+auto MemoryDumper::dump(const std::string& directory) -> void
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::filesystem::create_directories(directory);
+
+    const auto data_path  = (std::filesystem::path(directory)
+                            / DATA_FILE_NAME)
+                             .string();
+    const auto index_path = (std::filesystem::path(directory)
+                             / INDEX_FILE_NAME)
+                              .string();
+
+    std::ofstream data_file(data_path,
+                            std::ios::binary | std::ios::out
+                              | std::ios::trunc);
+
+    if (not data_file.is_open())
+    {
+        ASURA_EXCEPTION("Could not open file " + data_path);
+    }
+
+    prepare();
+
+    if (_options.force_readable)
+    {
+        forceReadable(true);
+    }
+
+    std::atomic_size_t next_chunk {};
+    std::size_t written_chunks {};
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable written_condition;
+
+    /**
+     * Reading and compressing is done in parallel, writing is done in
+     * order one chunk at a time so the compressed chunks stay in order.
+     */
+    const auto worker = [&]()
+    {
+        bytes_t buffer(_options.chunk_size);
+
+        while (true)
+        {
+            const auto chunk_index = next_chunk++;
+
+            if (chunk_index >= _chunks.size())
+            {
+                break;
+            }
+
+            const auto& chunk = _chunks[chunk_index];
+            const auto& entry = _entries[chunk.entry_index];
+            bool read         = true;
+
+            try
+            {
+                MemoryUtils::ReadProcessMemoryAreas(
+                  _process.id(),
+                  { { .local  = buffer.data(),
+                      .remote = entry.address + chunk.offset,
+                      .size   = chunk.size } });
+            }
+            catch (Exception&)
+            {
+                std::memset(buffer.data(), 0, chunk.size);
+                read = false;
+            }
+
+            bytes_t encoded;
+
+            if (_options.compress and not IsZero(buffer.data(), chunk.size))
+            {
+                encoded = XKC<byte_t>::encode(buffer.data(), chunk.size);
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+
+            written_condition.wait(lock,
+                                   [&]()
+                                   {
+                                       return written_chunks == chunk_index
+                                              or error;
+                                   });
+
+            if (error)
+            {
+                break;
+            }
+
+            try
+            {
+                writeChunk(data_file, chunk, buffer, encoded);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+                written_condition.notify_all();
+                break;
+            }
+
+            if (not read)
+            {
+                _entries[chunk.entry_index].dumped = false;
+            }
+
+            written_chunks++;
+            written_condition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < _options.thread_count; i++)
+    {
+        threads.emplace_back(worker);
+    }
+
+    for (auto&& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (_options.force_readable)
+    {
+        forceReadable(false);
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    data_file.close();
+
+    /* Trailing holes aren't written, make them part of the file */
+    std::filesystem::resize_file(data_path, _file_cursor);
+
+    writeIndex(index_path);
+
+    _stats.failed_areas = view_as<std::size_t>(
+      std::count_if(_entries.begin(),
+                    _entries.end(),
+                    [](const Entry& entry)
+                    {
+                        return not entry.dumped;
+                    }));
+
+    _stats.elapsed_ns = view_as<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start)
+        .count());
+}
+
+auto MemoryDumper::IsZero(const byte_t* const data,
+                          const std::size_t size) -> bool
+{
+    const auto words = view_as<const std::uint64_t*>(data);
+
+    for (std::size_t i = 0; i < size / sizeof(std::uint64_t); i++)
+    {
+        if (words[i] != 0)
+        {
+            return false;
+        }
+    }
+
+    for (auto i = size - (size % sizeof(std::uint64_t)); i < size; i++)
+    {
+        if (data[i] != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+auto MemoryDumper::prepare() -> void
+{
+    _entries.clear();
+    _chunks.clear();
+    _stats       = {};
+    _file_cursor = 0;
+
+    const auto& filter = _options.filter;
+
+    for (const auto& area : _process.mmap().areaTable())
+    {
+        if (filter ? not filter(area) :
+                     (area.isDeniedByOS()
+                      or (not area.isReadable()
+                          and not _options.force_readable)))
+        {
+            continue;
+        }
+
+        /* Without compression, the areas are stored contiguously */
+        _entries.push_back(
+          { .address     = area.begin(),
+            .size        = area.size(),
+            .flags       = area.flags(),
+            .name        = area.name(),
+            .file_offset = _options.compress ? 0 : _file_cursor,
+            .stored_size = _options.compress ? 0 : area.size(),
+            .dumped      = true });
+
+        for (std::size_t offset = 0; offset < area.size();
+             offset += _options.chunk_size)
+        {
+            _chunks.push_back(
+              { .entry_index = _entries.size() - 1,
+                .offset      = offset,
+                .size        = std::min(_options.chunk_size,
+                                 area.size() - offset) });
+        }
+
+        if (not _options.compress)
+        {
+            _file_cursor += area.size();
+        }
+
+        _stats.total_bytes += area.size();
+    }
+}
+
+auto MemoryDumper::forceReadable(const bool readable) -> void
+{
+    for (const auto& entry : _entries)
+    {
+        if (entry.flags & MemoryArea::ProtectionFlags::R)
+        {
+            continue;
+        }
+
+        try
+        {
+            MemoryUtils::ProtectMemoryArea(
+              _process.id(),
+              entry.address,
+              entry.size,
+              readable ? entry.flags | MemoryArea::ProtectionFlags::R :
+                         entry.flags);
+        }
+        catch (Exception&)
+        {
+            /* The read will fail and the entry will be marked */
+        }
+    }
+}
+
+auto MemoryDumper::writeChunk(std::ofstream& dataFile,
+                              const Chunk& chunk,
+                              const bytes_t& buffer,
+                              const bytes_t& encoded) -> void
+{
+    auto& entry = _entries[chunk.entry_index];
+
+    if (_options.compress)
+    {
+        if (chunk.offset == 0)
+        {
+            entry.file_offset = _file_cursor;
+        }
+
+        const auto zero = encoded.empty();
+        const auto raw  = not zero and encoded.size() >= chunk.size;
+
+        const ChunkHeader header {
+            .raw_size    = view_as<std::uint32_t>(chunk.size),
+            .stored_size = view_as<std::uint32_t>(
+              zero ? 0 : (raw ? chunk.size : encoded.size()))
+        };
+
+        dataFile.seekp(view_as<std::streamoff>(_file_cursor));
+        dataFile.write(view_as<const char*>(&header), sizeof(header));
+
+        if (not zero)
+        {
+            dataFile.write(view_as<const char*>(raw ? buffer.data() :
+                                                      encoded.data()),
+                           header.stored_size);
+        }
+        else
+        {
+            _stats.zero_bytes += chunk.size;
+        }
+
+        const auto stored_size = sizeof(header) + header.stored_size;
+
+        entry.stored_size += stored_size;
+        _file_cursor += stored_size;
+        _stats.written_bytes += stored_size;
+    }
+    else
+    {
+        const auto page_size = MemoryUtils::GetPageSize();
+        const auto position  = entry.file_offset + chunk.offset;
+
+        /* Write the runs of non-zero pages, skip the rest */
+        for (std::size_t offset = 0; offset < chunk.size;)
+        {
+            if (IsZero(buffer.data() + offset, page_size))
+            {
+                _stats.zero_bytes += page_size;
+                offset += page_size;
+                continue;
+            }
+
+            auto run_end = offset + page_size;
+
+            while (run_end < chunk.size
+                   and not IsZero(buffer.data() + run_end, page_size))
+            {
+                run_end += page_size;
+            }
+
+            dataFile.seekp(view_as<std::streamoff>(position + offset));
+            dataFile.write(view_as<const char*>(buffer.data() + offset),
+                           view_as<std::streamsize>(run_end - offset));
+
+            _stats.written_bytes += run_end - offset;
+            offset = run_end;
+        }
+    }
+
+    if (not dataFile.good())
+    {
+        ASURA_EXCEPTION("Couldn't write the dump of area at "
+                        + std::to_string(entry.address));
+    }
+}
+
+auto MemoryDumper::writeIndex(const std::string& path) const -> void
+{
+    std::ofstream index_file(path, std::ios::out | std::ios::trunc);
+
+    if (not index_file.is_open())
+    {
+        ASURA_EXCEPTION("Could not open file " + path);
+    }
+
+    index_file << "# data: " << DATA_FILE_NAME
+               << (_options.compress ? " (compressed)" : "") << "\n"
+               << "# begin end flags file_offset stored_size dumped name"
+               << "\n";
+
+    for (const auto& entry : _entries)
+    {
+        index_file << std::hex << entry.address << " "
+                   << entry.address + entry.size << " " << std::dec
+                   << view_as<int>(entry.flags) << " " << std::hex
+                   << entry.file_offset << " " << entry.stored_size
+                   << " " << entry.dumped << " " << entry.name << "\n";
+    }
+
+    if (not index_file.good())
+    {
+        ASURA_EXCEPTION("Couldn't write index file " + path);
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef ASURA_MEMORYDUMPER_H
+#define ASURA_MEMORYDUMPER_H
+
+#include "memoryareatable.h"
+#include "process.h"
+
+namespace Asura
+{
+    /**
+     * Dumps the memory of a process inside a directory:
+     * - one data file with every areas, read by a pool of threads
+     * - one index file listing the areas, their protections and where
+     *   they are stored inside the data file.
+     *
+     * Without compression, the areas are stored at their offsets and
+     * zeroed pages are left as holes so the data file stays sparse.
+     * With compression, every chunk of an area is stored as a header
+     * (raw size, stored size) followed by the stored bytes:
+     * - stored size of 0, the chunk is zeroed
+     * - stored size equal to the raw size, the chunk is raw
+     * - otherwise the chunk is encoded with XKC.
+     */
+    class MemoryDumper
+    {
+      public:
+        using filter_t = std::function<bool(
+          const MemoryAreaTable::View&)>;
+
+        struct Options
+        {
+            /* 0 means one thread per CPU */
+            std::size_t thread_count {};
+            /* Rounded up to the page size */
+            std::size_t chunk_size { 0x100000 };
+            bool compress {};
+            /**
+             * Adds temporarily the read protection to the areas that
+             * don't have it.
+             */
+            bool force_readable {};
+            /* Every readable areas by default */
+            filter_t filter {};
+        };
+
+        struct Entry
+        {
+            std::uintptr_t address;
+            std::size_t size;
+            mapf_t flags;
+            std::string name;
+            /* Offset inside the data file */
+            std::uint64_t file_offset;
+            /* Bytes used inside the data file, holes included */
+            std::uint64_t stored_size;
+            /* false when some parts couldn't be read, they're zeroed */
+            bool dumped;
+        };
+
+        struct Stats
+        {
+            std::size_t total_bytes;
+            std::size_t written_bytes;
+            std::size_t zero_bytes;
+            std::size_t failed_areas;
+            std::uint64_t elapsed_ns;
+        };
+
+        struct ChunkHeader
+        {
+            std::uint32_t raw_size;
+            std::uint32_t stored_size;
+        };
+
+        static constexpr inline auto DATA_FILE_NAME  = "memory.bin";
+        static constexpr inline auto INDEX_FILE_NAME = "index.txt";
+
+      private:
+        struct Chunk
+        {
+            std::size_t entry_index;
+            std::size_t offset;
+            std::size_t size;
+        };
+
+      public:
+        explicit MemoryDumper(Process& process);
+        MemoryDumper(Process& process, const Options& options);
+
+      public:
+        auto entries() const -> const std::vector<Entry>&;
+        auto stats() const -> const Stats&;
+
+      public:
+        auto dump(const std::string& directory) -> void;
+
+      private:
+        static auto IsZero(const byte_t* const data,
+                           const std::size_t size) -> bool;
+
+      private:
+        auto prepare() -> void;
+        auto forceReadable(const bool readable) -> void;
+        auto writeChunk(std::ofstream& dataFile,
+                        const Chunk& chunk,
+                        const bytes_t& buffer,
+                        const bytes_t& encoded) -> void;
+        auto writeIndex(const std::string& path) const -> void;
+
+      private:
+        Process& _process;
+        Options _options;
+        std::vector<Entry> _entries;
+        std::vector<Chunk> _chunks;
+        Stats _stats {};
+        std::uint64_t _file_cursor {};
+    };
+}
+
+#endif
@@ -33,3 +33,159 @@ auto MemoryUtils::GetPageSize() -> std::size_t
 
     return _page_size;
 }
+
+auto MemoryUtils::ReadProcessMemoryAreas(const process_id_t pid,
+                                         const transfers_t& transfers)
+  -> void
+{
+#ifndef WINDOWS
+    std::vector<iovec> locals, remotes;
+    locals.reserve(std::min<std::size_t>(transfers.size(), IOV_MAX));
+    remotes.reserve(locals.capacity());
+
+    for (std::size_t first = 0; first < transfers.size();
+         first += IOV_MAX)
+    {
+        const auto last = std::min<std::size_t>(first + IOV_MAX,
+                                                transfers.size());
+        std::size_t expected = 0;
+
+        locals.clear();
+        remotes.clear();
+
+        for (auto i = first; i < last; i++)
+        {
+            const auto& transfer = transfers[i];
+
+            locals.push_back(
+              { .iov_base = transfer.local, .iov_len = transfer.size });
+            remotes.push_back(
+              { .iov_base = view_as<ptr_t>(transfer.remote),
+                .iov_len  = transfer.size });
+
+            expected += transfer.size;
+        }
+
+        const auto ret = process_vm_readv(pid,
+                                          locals.data(),
+                                          locals.size(),
+                                          remotes.data(),
+                                          remotes.size(),
+                                          0);
+
+        if (ret != view_as<decltype(ret)>(expected))
+        {
+            ASURA_EXCEPTION("process_vm_readv failed with: transfers: "
+                            + std::to_string(last - first)
+                            + ", size: " + std::to_string(expected)
+                            + ", ret: " + std::to_string(ret));
+        }
+    }
+#else
+    for (const auto& transfer : transfers)
+    {
+        const auto ret = Toolhelp32ReadProcessMemory(
+          view_as<DWORD>(pid),
+          view_as<ptr_t>(transfer.remote),
+          transfer.local,
+          transfer.size,
+          nullptr);
+
+        if (not ret)
+        {
+            std::stringstream ss;
+            ss << std::hex << transfer.remote;
+
+            ASURA_EXCEPTION("ReadProcessMemory failed with: address: "
+                            + ss.str() + ", size: "
+                            + std::to_string(transfer.size));
+        }
+    }
+#endif
+}
+
+auto MemoryUtils::WriteProcessMemoryAreas(const process_id_t pid,
+                                          const transfers_t& transfers)
+  -> void
+{
+#ifndef WINDOWS
+    std::vector<iovec> locals, remotes;
+    locals.reserve(std::min<std::size_t>(transfers.size(), IOV_MAX));
+    remotes.reserve(locals.capacity());
+
+    for (std::size_t first = 0; first < transfers.size();
+         first += IOV_MAX)
+    {
+        const auto last = std::min<std::size_t>(first + IOV_MAX,
+                                                transfers.size());
+        std::size_t expected = 0;
+
+        locals.clear();
+        remotes.clear();
+
+        for (auto i = first; i < last; i++)
+        {
+            const auto& transfer = transfers[i];
+
+            locals.push_back(
+              { .iov_base = transfer.local, .iov_len = transfer.size });
+            remotes.push_back(
+              { .iov_base = view_as<ptr_t>(transfer.remote),
+                .iov_len  = transfer.size });
+
+            expected += transfer.size;
+        }
+
+        const auto ret = process_vm_writev(pid,
+                                           locals.data(),
+                                           locals.size(),
+                                           remotes.data(),
+                                           remotes.size(),
+                                           0);
+
+        if (ret != view_as<decltype(ret)>(expected))
+        {
+            ASURA_EXCEPTION("process_vm_writev failed with: transfers: "
+                            + std::to_string(last - first)
+                            + ", size: " + std::to_string(expected)
+                            + ", ret: " + std::to_string(ret));
+        }
+    }
+#else
+    const auto process_handle = GetCurrentProcessId() == pid ?
+                                  GetCurrentProcess() :
+                                  OpenProcess(PROCESS_VM_OPERATION
+                                                | PROCESS_VM_WRITE,
+                                              false,
+                                              view_as<DWORD>(pid));
+
+    if (process_handle == nullptr)
+    {
+        ASURA_EXCEPTION("Couldn't open process");
+    }
+
+    for (const auto& transfer : transfers)
+    {
+        const auto ret = WriteProcessMemory(process_handle,
+                                            view_as<ptr_t>(
+                                              transfer.remote),
+                                            transfer.local,
+                                            transfer.size,
+                                            nullptr);
+
+        if (not ret)
+        {
+            std::stringstream ss;
+            ss << std::hex << transfer.remote;
+
+            CloseHandle(process_handle);
+
+            ASURA_EXCEPTION("WriteProcessMemory failed with: address: "
+                            + ss.str() + ", size: "
+                            + std::to_string(transfer.size));
+        }
+    }
+
+    CloseHandle(process_handle);
+#endif
+}
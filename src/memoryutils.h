@@ -15,6 +15,20 @@ namespace Asura
      */
     class MemoryUtils
     {
+      public:
+        /**
+         * One contiguous transfer between our memory and a remote
+         * process memory, used for vectored reads and writes.
+         */
+        struct Transfer
+        {
+            ptr_t local;
+            std::uintptr_t remote;
+            std::size_t size;
+        };
+
+        using transfers_t = std::vector<Transfer>;
+
       public:
         static constexpr inline auto Align(const auto value,
                                            const std::size_t size)
@@ -354,6 +368,18 @@ namespace Asura
 #endif
         }
 
+        /**
+         * Reads/writes every transfers with as few system calls as
+         * possible (IOV_MAX transfers per call on GNU/Linux).
+         */
+        static auto ReadProcessMemoryAreas(const process_id_t pid,
+                                           const transfers_t& transfers)
+          -> void;
+
+        static auto WriteProcessMemoryAreas(const process_id_t pid,
+                                            const transfers_t& transfers)
+          -> void;
+
         static auto GetPageSize() -> std::size_t;
 
       private:
@@ -0,0 +1,668 @@
+#include "pch.h"
+
+#include "elf.h"
+#include "exception.h"
+#include "memoryutils.h"
+#include "moduleindex.h"
+
+using namespace Asura;
+
+#ifndef WINDOWS
+/**
+ * <link.h> includes <elf.h>, which is shadowed by ours, so here's what
+ * glibc gives to the dl_iterate_phdr callback.
+ */
+struct LoadedObject
+{
+    std::uintptr_t dlpi_addr;
+    const char* dlpi_name;
+    const ELF::Elf_Phdr<std::uintptr_t>* dlpi_phdr;
+    std::uint16_t dlpi_phnum;
+    /* Objects loaded and unloaded since the process started */
+    unsigned long long int dlpi_adds;
+    unsigned long long int dlpi_subs;
+    std::size_t dlpi_tls_modid;
+    void* dlpi_tls_data;
+};
+
+extern "C" auto dl_iterate_phdr(int (*callback)(LoadedObject*,
+                                                std::size_t,
+                                                void*),
+                                void* data) -> int;
+
+/* The beginnings of glibc's r_debug and link_map, in the process class */
+template <ELF::IntType T>
+struct RDebug
+{
+    std::int32_t r_version;
+    T r_map;
+};
+
+template <ELF::IntType T>
+struct LinkMap
+{
+    T l_addr;
+    T l_name;
+    /* Dynamic section of the object, used to find its module */
+    T l_ld;
+    T l_next;
+    T l_prev;
+};
+
+/* How many loaded objects are followed at most, the list could loop */
+static constexpr std::size_t MAX_LINK_MAP_ENTRIES = 0x1000;
+
+/**
+ * Dynamic sections of the loaded objects, in the order of the list
+ * found through DT_DEBUG of the executable. Empty when there's none.
+ */
+template <ELF::IntType T>
+static auto ReadLinkMap(const process_id_t pid,
+                        const ModuleIndex::Module& executable,
+                        const ELF::Elf_Ehdr<T>& elfHeader)
+  -> std::vector<std::uintptr_t>
+{
+    std::vector<ELF::Elf_Phdr<T>> program_headers(elfHeader.e_phnum);
+
+    MemoryUtils::ReadProcessMemoryAreas(
+      pid,
+      { { .local  = program_headers.data(),
+          .remote = executable.begin + elfHeader.e_phoff,
+          .size   = program_headers.size() * sizeof(ELF::Elf_Phdr<T>) } });
+
+    auto load_address = std::numeric_limits<std::uintptr_t>::max();
+    const ELF::Elf_Phdr<T>* dynamic_header = nullptr;
+
+    for (const auto& program_header : program_headers)
+    {
+        if (program_header.p_type == ELF::PT_LOAD)
+        {
+            load_address = std::min(
+              load_address,
+              view_as<std::uintptr_t>(program_header.p_vaddr));
+        }
+        else if (program_header.p_type == ELF::PT_DYNAMIC)
+        {
+            dynamic_header = &program_header;
+        }
+    }
+
+    /* Static executable */
+    if (not dynamic_header
+        or load_address == std::numeric_limits<std::uintptr_t>::max())
+    {
+        return {};
+    }
+
+    const auto load_bias = executable.begin
+                           - MemoryUtils::Align(
+                             load_address,
+                             MemoryUtils::GetPageSize());
+
+    std::vector<ELF::Elf_Dyn<T>> dynamic_entries(
+      dynamic_header->p_memsz / sizeof(ELF::Elf_Dyn<T>));
+
+    MemoryUtils::ReadProcessMemoryAreas(
+      pid,
+      { { .local  = dynamic_entries.data(),
+          .remote = load_bias + dynamic_header->p_vaddr,
+          .size   = dynamic_entries.size() * sizeof(ELF::Elf_Dyn<T>) } });
+
+    /* Filled by the dynamic linker when it starts */
+    std::uintptr_t debug_address = 0;
+
+    for (const auto& dyn : dynamic_entries)
+    {
+        if (dyn.d_tag == ELF::DT_NULL)
+        {
+            break;
+        }
+
+        if (dyn.d_tag == ELF::DT_DEBUG)
+        {
+            debug_address = view_as<std::uintptr_t>(dyn.d_un.d_ptr);
+            break;
+        }
+    }
+
+    if (not debug_address)
+    {
+        return {};
+    }
+
+    RDebug<T> debug;
+
+    MemoryUtils::ReadProcessMemoryAreas(pid,
+                                        { { .local  = &debug,
+                                            .remote = debug_address,
+                                            .size   = sizeof(debug) } });
+
+    std::vector<std::uintptr_t> dynamic_addresses;
+
+    for (auto address = view_as<std::uintptr_t>(debug.r_map);
+         address and dynamic_addresses.size() < MAX_LINK_MAP_ENTRIES;)
+    {
+        LinkMap<T> link_map;
+
+        MemoryUtils::ReadProcessMemoryAreas(
+          pid,
+          { { .local  = &link_map,
+              .remote = address,
+              .size   = sizeof(link_map) } });
+
+        dynamic_addresses.push_back(view_as<std::uintptr_t>(link_map.l_ld));
+        address = view_as<std::uintptr_t>(link_map.l_next);
+    }
+
+    return dynamic_addresses;
+}
+#endif
+
+static auto IsModuleArea(const MemoryAreaTable::View& area) -> bool
+{
+#ifndef WINDOWS
+    /* Anonymous memory, memfds and devices aren't modules */
+    const auto& name = area.name();
+
+    return area.inode() != 0 and name.starts_with("/")
+           and not name.starts_with("/memfd:")
+           and not name.starts_with("/dev/");
+#else
+    return not area.name().empty();
+#endif
+}
+
+/**
+ * A loaded image has code, a file only mapped to be read (like
+ * OSUtils::MapFile does) isn't a module, even if it's a library.
+ */
+static auto HasCode(const ModuleIndex::Module& module) -> bool
+{
+    return std::any_of(module.segments.begin(),
+                       module.segments.end(),
+                       [](const ModuleIndex::Segment& segment)
+                       {
+                           return segment.flags
+                                  & MemoryArea::ProtectionFlags::X;
+                       });
+}
+
+static auto FileName(const std::string& path) -> std::string
+{
+    return std::filesystem::path(path).filename().string();
+}
+
+ModuleIndex::ModuleIndex(const ModuleIndex& moduleIndex)
+ : _modules(moduleIndex._modules),
+   _load_order(moduleIndex._load_order),
+   _file_areas(moduleIndex._file_areas),
+   _loaded_objects_adds(moduleIndex._loaded_objects_adds),
+   _loaded_objects_subs(moduleIndex._loaded_objects_subs)
+{
+    rebuildLookups();
+}
+
+auto ModuleIndex::operator=(const ModuleIndex& moduleIndex)
+  -> ModuleIndex&
+{
+    if (this != &moduleIndex)
+    {
+        *this = ModuleIndex(moduleIndex);
+    }
+
+    return *this;
+}
+
+auto ModuleIndex::modules() const -> const std::vector<Module>&
+{
+    return _modules;
+}
+
+auto ModuleIndex::module(const module_id_t moduleID) const
+  -> const Module&
+{
+    return _modules[moduleID];
+}
+
+auto ModuleIndex::loadOrder() const -> const std::vector<module_id_t>&
+{
+    return _load_order;
+}
+
+auto ModuleIndex::findByName(const std::string_view name) const
+  -> module_id_t
+{
+    const auto it = _by_name.find(name);
+
+    return it == _by_name.end() ? INVALID_ID : it->second;
+}
+
+auto ModuleIndex::findByPath(const std::string_view path) const
+  -> module_id_t
+{
+    const auto it = _by_path.find(path);
+
+    return it == _by_path.end() ? INVALID_ID : it->second;
+}
+
+auto ModuleIndex::find(const std::string_view name) const -> module_id_t
+{
+    auto module_id = findByName(name);
+
+    if (module_id != INVALID_ID)
+    {
+        return module_id;
+    }
+
+    module_id = findByPath(name);
+
+    if (module_id != INVALID_ID)
+    {
+        return module_id;
+    }
+
+    for (std::size_t i = 0; i < _modules.size(); i++)
+    {
+        if (_modules[i].path.find(name) != std::string::npos)
+        {
+            return i;
+        }
+    }
+
+    return INVALID_ID;
+}
+
+auto ModuleIndex::search(const std::uintptr_t address) const
+  -> module_id_t
+{
+    /* First segment that begins after our address */
+    const auto it = std::upper_bound(
+      _segments.begin(),
+      _segments.end(),
+      address,
+      [](const std::uintptr_t value, const SegmentEntry& segment)
+      {
+          return value < segment.begin;
+      });
+
+    if (it == _segments.begin())
+    {
+        return INVALID_ID;
+    }
+
+    const auto& segment = *std::prev(it);
+
+    if (address >= segment.end)
+    {
+        return INVALID_ID;
+    }
+
+    return segment.module_id;
+}
+
+auto ModuleIndex::update(const MemoryAreaTable& areaTable) -> bool
+{
+    std::vector<FileArea> file_areas;
+    file_areas.reserve(_file_areas.size());
+
+    for (const auto area : areaTable)
+    {
+        if (IsModuleArea(area))
+        {
+            file_areas.push_back({ .begin       = area.begin(),
+                                   .end         = area.end(),
+                                   .flags       = area.flags(),
+                                   .file_offset = area.fileOffset(),
+                                   .inode       = area.inode() });
+        }
+    }
+
+    /* Most refreshes only touch anonymous memory */
+    if (file_areas == _file_areas and not _modules.empty())
+    {
+        return false;
+    }
+
+    _modules.clear();
+
+    /**
+     * Modules still being filled, by path. A segment continues the
+     * module of its file unless it maps the beginning of the file
+     * again, which means the file was mapped once more.
+     */
+    std::unordered_map<std::string_view, module_id_t> open_modules;
+
+    for (const auto area : areaTable)
+    {
+        if (not IsModuleArea(area))
+        {
+            continue;
+        }
+
+        const Segment segment { .begin       = area.begin(),
+                                .end         = area.end(),
+                                .flags       = area.flags(),
+                                .file_offset = area.fileOffset() };
+
+        const auto it = open_modules.find(area.name());
+
+        if (it != open_modules.end() and area.fileOffset() != 0
+            and _modules[it->second].inode == area.inode())
+        {
+            auto& module = _modules[it->second];
+
+            module.end = std::max(module.end, segment.end);
+            module.segments.push_back(segment);
+
+            continue;
+        }
+
+        open_modules[area.name()] = _modules.size();
+
+        _modules.push_back({ .name     = FileName(area.name()),
+                             .path     = area.name(),
+                             .inode    = area.inode(),
+                             .begin    = segment.begin,
+                             .end      = segment.end,
+                             .segments = { segment } });
+    }
+
+    std::erase_if(_modules,
+                  [](const Module& module)
+                  {
+                      return not HasCode(module);
+                  });
+
+    _file_areas          = std::move(file_areas);
+    _loaded_objects_adds = 0;
+    _loaded_objects_subs = 0;
+
+    _load_order.resize(_modules.size());
+    std::iota(_load_order.begin(), _load_order.end(), 0);
+
+    rebuildLookups();
+
+    return true;
+}
+
+auto ModuleIndex::updateSelf() -> bool
+{
+#ifndef WINDOWS
+    struct Context
+    {
+        ModuleIndex* index;
+        std::vector<Module> modules;
+        bool unchanged;
+    } context { .index = this, .modules = {}, .unchanged = false };
+
+    dl_iterate_phdr(
+      [](LoadedObject* info, std::size_t size, void* data) -> int
+      {
+          auto& context = *view_as<Context*>(data);
+
+          /**
+           * The counters of loaded and unloaded objects tell if
+           * anything changed since last time, no need to go further.
+           */
+          if (context.modules.empty()
+              and size >= offsetof(LoadedObject, dlpi_subs)
+                            + sizeof(info->dlpi_subs))
+          {
+              auto& index = *context.index;
+
+              if (not index._modules.empty()
+                  and index._loaded_objects_adds == info->dlpi_adds
+                  and index._loaded_objects_subs == info->dlpi_subs)
+              {
+                  context.unchanged = true;
+                  return 1;
+              }
+
+              index._loaded_objects_adds = info->dlpi_adds;
+              index._loaded_objects_subs = info->dlpi_subs;
+          }
+
+          const auto page_size = MemoryUtils::GetPageSize();
+
+          Module module { .name     = {},
+                          .path     = info->dlpi_name,
+                          .inode    = 0,
+                          .begin    = std::numeric_limits<
+                            std::uintptr_t>::max(),
+                          .end      = 0,
+                          .segments = {} };
+
+          for (std::size_t i = 0; i < info->dlpi_phnum; i++)
+          {
+              const auto& program_header = info->dlpi_phdr[i];
+
+              if (program_header.p_type != ELF::PT_LOAD)
+              {
+                  continue;
+              }
+
+              const auto begin = info->dlpi_addr
+                                 + program_header.p_vaddr;
+
+              mapf_t flags = 0;
+
+              if (program_header.p_flags & ELF::PF_R)
+              {
+                  flags |= MemoryArea::ProtectionFlags::R;
+              }
+
+              if (program_header.p_flags & ELF::PF_W)
+              {
+                  flags |= MemoryArea::ProtectionFlags::W;
+              }
+
+              if (program_header.p_flags & ELF::PF_X)
+              {
+                  flags |= MemoryArea::ProtectionFlags::X;
+              }
+
+              /* Includes .bss, unlike the file mappings */
+              const Segment segment {
+                  .begin       = MemoryUtils::Align(begin, page_size),
+                  .end         = MemoryUtils::AlignToPageSize(
+                    begin + program_header.p_memsz,
+                    page_size),
+                  .flags       = flags,
+                  .file_offset = MemoryUtils::Align(
+                    view_as<std::uint64_t>(program_header.p_offset),
+                    view_as<std::uint64_t>(page_size))
+              };
+
+              module.begin = std::min(module.begin, segment.begin);
+              module.end   = std::max(module.end, segment.end);
+              module.segments.push_back(segment);
+          }
+
+          if (module.segments.empty())
+          {
+              return 0;
+          }
+
+          /* The executable has no name there */
+          if (module.path.empty())
+          {
+              module.path = std::filesystem::read_symlink(
+                              "/proc/self/exe")
+                              .string();
+          }
+
+          module.name = FileName(module.path);
+
+          context.modules.push_back(std::move(module));
+
+          return 0;
+      },
+      &context);
+
+    if (context.unchanged)
+    {
+        return false;
+    }
+
+    _modules = std::move(context.modules);
+    _file_areas.clear();
+
+    /* The dynamic linker gives them in its order already */
+    _load_order.resize(_modules.size());
+    std::iota(_load_order.begin(), _load_order.end(), 0);
+
+    rebuildLookups();
+
+    return true;
+#else
+    ASURA_EXCEPTION("dl_iterate_phdr isn't available on this platform");
+#endif
+}
+
+auto ModuleIndex::readLoadOrder(const process_id_t pid) -> void
+{
+#ifndef WINDOWS
+    std::array<char, PATH_MAX> buffer;
+
+    const auto real_size = readlink(
+      ("/proc/" + std::to_string(pid) + "/exe").c_str(),
+      buffer.data(),
+      buffer.size());
+
+    if (real_size <= 0)
+    {
+        return;
+    }
+
+    const auto executable_id = findByPath(
+      std::string_view(buffer.data(), view_as<std::size_t>(real_size)));
+
+    if (executable_id == INVALID_ID)
+    {
+        return;
+    }
+
+    const auto& executable = _modules[executable_id];
+    std::vector<std::uintptr_t> dynamic_addresses;
+
+    try
+    {
+        /* Both classes of the ELF header fit in there */
+        alignas(std::uint64_t)
+          std::array<byte_t, sizeof(ELF::Elf_Ehdr<std::uint64_t>)>
+            header;
+
+        MemoryUtils::ReadProcessMemoryAreas(
+          pid,
+          { { .local  = header.data(),
+              .remote = executable.begin,
+              .size   = header.size() } });
+
+        if (std::memcmp(header.data(),
+                        &ELF::MAGIC_NUMBER,
+                        sizeof(ELF::MAGIC_NUMBER))
+            != 0)
+        {
+            return;
+        }
+
+        switch (view_as<const ELF::Elf_Parent_Ehdr*>(header.data())
+                  ->e_ident[ELF::EI_CLASS])
+        {
+            case ELF::ELFCLASS32:
+            {
+                dynamic_addresses = ReadLinkMap(
+                  pid,
+                  executable,
+                  *view_as<const ELF::Elf_Ehdr<std::uint32_t>*>(
+                    header.data()));
+                break;
+            }
+
+            case ELF::ELFCLASS64:
+            {
+                dynamic_addresses = ReadLinkMap(
+                  pid,
+                  executable,
+                  *view_as<const ELF::Elf_Ehdr<std::uint64_t>*>(
+                    header.data()));
+                break;
+            }
+
+            default:
+            {
+                return;
+            }
+        }
+    }
+    catch (Exception&)
+    {
+        return;
+    }
+
+    if (dynamic_addresses.empty())
+    {
+        return;
+    }
+
+    std::vector<module_id_t> load_order;
+    std::vector<bool> is_ordered(_modules.size());
+
+    load_order.reserve(_modules.size());
+
+    const auto add = [&](const module_id_t moduleID)
+    {
+        if (moduleID != INVALID_ID and not is_ordered[moduleID])
+        {
+            is_ordered[moduleID] = true;
+            load_order.push_back(moduleID);
+        }
+    };
+
+    /* The list starts with the executable already */
+    for (const auto dynamic_address : dynamic_addresses)
+    {
+        add(search(dynamic_address));
+    }
+
+    for (module_id_t module_id = 0; module_id < _modules.size();
+         module_id++)
+    {
+        add(module_id);
+    }
+
+    _load_order = std::move(load_order);
+#else
+    static_cast<void>(pid);
+#endif
+}
+
+auto ModuleIndex::rebuildLookups() -> void
+{
+    _segments.clear();
+    _by_name.clear();
+    _by_path.clear();
+
+    for (std::size_t i = 0; i < _modules.size(); i++)
+    {
+        const auto& module = _modules[i];
+
+        for (const auto& segment : module.segments)
+        {
+            _segments.push_back({ .begin     = segment.begin,
+                                  .end       = segment.end,
+                                  .module_id = i });
+        }
+
+        /* The views point to the names of the modules, left untouched */
+        _by_name.emplace(module.name, i);
+        _by_path.emplace(module.path, i);
+    }
+
+    std::sort(_segments.begin(),
+              _segments.end(),
+              [](const SegmentEntry& lhs, const SegmentEntry& rhs)
+              {
+                  return lhs.begin < rhs.begin;
+              });
+}
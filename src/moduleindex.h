@@ -0,0 +1,136 @@
+#ifndef ASURA_MODULEINDEX_H
+#define ASURA_MODULEINDEX_H
+
+#include "memoryareatable.h"
+
+namespace Asura
+{
+    /**
+     * Files mapped inside a process (executable, libraries, ...),
+     * grouped from the file offset and inode of each area, so nothing
+     * has to be asked to the filesystem.
+     * Only the groups with an executable segment are modules, files
+     * mapped as data aren't.
+     * For our own process, the dynamic linker's list of loaded objects
+     * can be used instead.
+     * Rebuilt only when the file mappings changed.
+     */
+    class ModuleIndex
+    {
+      public:
+        using module_id_t = std::size_t;
+
+        static constexpr inline module_id_t INVALID_ID = std::
+          numeric_limits<module_id_t>::max();
+
+        struct Segment
+        {
+            std::uintptr_t begin;
+            std::uintptr_t end;
+            mapf_t flags;
+            std::uint64_t file_offset;
+        };
+
+        struct Module
+        {
+            std::string name;
+            std::string path;
+            std::uint64_t inode;
+            /* Lowest and highest addresses of all the segments */
+            std::uintptr_t begin;
+            std::uintptr_t end;
+            std::vector<Segment> segments;
+        };
+
+      public:
+        ModuleIndex() = default;
+        /* The lookups view the names of our own copies of the modules */
+        ModuleIndex(const ModuleIndex& moduleIndex);
+        ModuleIndex(ModuleIndex&& moduleIndex) = default;
+
+        auto operator=(const ModuleIndex& moduleIndex) -> ModuleIndex&;
+        auto operator=(ModuleIndex&& moduleIndex) -> ModuleIndex& = default;
+
+      public:
+        auto modules() const -> const std::vector<Module>&;
+        auto module(const module_id_t moduleID) const -> const Module&;
+
+        /**
+         * Every module id, in the order the dynamic linker looks for
+         * symbols: the executable, then the libraries as they were
+         * loaded. Address order after update(), until readLoadOrder().
+         */
+        auto loadOrder() const -> const std::vector<module_id_t>&;
+
+        /**
+         * The module with the lowest id wins when several have that
+         * name or path. Ids are in address order after update(), in the
+         * dynamic linker's order after updateSelf().
+         */
+        auto findByName(const std::string_view name) const
+          -> module_id_t;
+        auto findByPath(const std::string_view path) const
+          -> module_id_t;
+
+        /* Name, then path, then any path containing it */
+        auto find(const std::string_view name) const -> module_id_t;
+
+        /* Module owning the segment that contains the address */
+        auto search(const std::uintptr_t address) const -> module_id_t;
+
+      public:
+        /**
+         * Returns false when the file mappings didn't change since last
+         * time, nothing is rebuilt then.
+         */
+        auto update(const MemoryAreaTable& areaTable) -> bool;
+
+        /* From dl_iterate_phdr, our own process only */
+        auto updateSelf() -> bool;
+
+        /**
+         * Takes the load order from the dynamic linker's list of loaded
+         * objects inside the process (r_debug of the executable).
+         * Modules it doesn't know about (Wine's PE modules, files mapped
+         * by hand) come after, in address order. Nothing changes when
+         * the list can't be read, like for static executables.
+         */
+        auto readLoadOrder(const process_id_t pid) -> void;
+
+      private:
+        struct FileArea
+        {
+            std::uintptr_t begin;
+            std::uintptr_t end;
+            mapf_t flags;
+            std::uint64_t file_offset;
+            std::uint64_t inode;
+
+            auto operator==(const FileArea& fileArea) const
+              -> bool = default;
+        };
+
+        struct SegmentEntry
+        {
+            std::uintptr_t begin;
+            std::uintptr_t end;
+            module_id_t module_id;
+        };
+
+        auto rebuildLookups() -> void;
+
+      private:
+        std::vector<Module> _modules;
+        std::vector<module_id_t> _load_order;
+        /* Every segment of every module, sorted by address */
+        std::vector<SegmentEntry> _segments;
+        std::unordered_map<std::string_view, module_id_t> _by_name;
+        std::unordered_map<std::string_view, module_id_t> _by_path;
+        /* What the index was built from, by update() or updateSelf() */
+        std::vector<FileArea> _file_areas;
+        std::uint64_t _loaded_objects_adds {};
+        std::uint64_t _loaded_objects_subs {};
+    };
+}
+
+#endif
@@ -1,3 +1,84 @@
 #include "pch.h"
 
 #include "osutils.h"
+
+using namespace Asura;
+
+auto OSUtils::FindSelfModule(const std::string& modName)
+  -> std::optional<ModuleIndex::Module>
+{
+    static std::mutex mutex;
+    static ModuleIndex module_index;
+#ifndef WINDOWS
+    /**
+     * PE modules mapped by Wine are only files mapped inside our
+     * process, the dynamic linker doesn't know about them.
+     */
+    static ModuleIndex mapped_module_index;
+#endif
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+#ifndef WINDOWS
+    module_index.updateSelf();
+
+    auto module_id = module_index.find(modName);
+
+    if (module_id != ModuleIndex::INVALID_ID)
+    {
+        return module_index.module(module_id);
+    }
+
+    /* Only parses the memory map when the name wasn't found */
+    mapped_module_index.update(Process::self().mmap().areaTable());
+
+    module_id = mapped_module_index.find(modName);
+
+    if (module_id == ModuleIndex::INVALID_ID)
+    {
+        return std::nullopt;
+    }
+
+    return mapped_module_index.module(module_id);
+#else
+    module_index.update(Process::self().mmap().areaTable());
+
+    const auto module_id = module_index.find(modName);
+
+    if (module_id == ModuleIndex::INVALID_ID)
+    {
+        return std::nullopt;
+    }
+
+    return module_index.module(module_id);
+#endif
+}
+
+auto OSUtils::MapFile(const std::string& path)
+  -> std::shared_ptr<const MappedFile>
+{
+    static std::mutex mutex;
+    static std::unordered_map<std::string,
+                              std::weak_ptr<const MappedFile>>
+      mapped_files;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    /* Forgets the files nobody holds anymore */
+    std::erase_if(mapped_files,
+                  [](const auto& entry)
+                  {
+                      return entry.second.expired();
+                  });
+
+    auto& cached_file = mapped_files[path];
+    auto mapped_file  = cached_file.lock();
+
+    if (not mapped_file or mapped_file->isStale())
+    {
+        mapped_file = std::make_shared<const MappedFile>(path);
+        cached_file = mapped_file;
+    }
+
+    return mapped_file;
+}
@@ -3,6 +3,7 @@
 
 #include "elf.h"
 #include "exception.h"
+#include "mappedfile.h"
 #include "memoryutils.h"
 #include "pe.h"
 #include "process.h"
@@ -144,34 +145,32 @@ namespace Asura
         }
 
       public:
+        /**
+         * From an index of our own modules kept across calls, only
+         * rebuilt when a library was loaded or unloaded.
+         * Names the dynamic linker doesn't know (Wine's PE modules) are
+         * then looked for inside the memory map.
+         */
+        static auto FindSelfModule(const std::string& modName)
+          -> std::optional<ModuleIndex::Module>;
+
+        /**
+         * Read only mapping of the file, given again for the same path
+         * while a caller still holds it and the file didn't change.
+         * Unmapped once the last caller releases it.
+         */
+        static auto MapFile(const std::string& path)
+          -> std::shared_ptr<const MappedFile>;
+
         /* M is to say if we want to search from mapped module. */
         template <bool M = true>
         static auto FindExportedFunctionRunTime(
           const std::string& modName,
           const std::string& funcName) -> module_sym_t
         {
-            auto process = Process::self();
-
-            process.refreshModules();
-
-            const auto& modules = process.modules();
-
-            const auto found_module = std::find_if(
-              modules.begin(),
-              modules.end(),
-              [&](const Process::Module& module)
-              {
-                  const auto mod_path = module.path();
-
-                  if (mod_path.find(modName) != std::string::npos)
-                  {
-                      return true;
-                  }
+            const auto found_module = FindSelfModule(modName);
 
-                  return false;
-              });
-
-            if (found_module == modules.end())
+            if (not found_module)
             {
                 return { 0, 0 };
             }
@@ -186,7 +185,7 @@ namespace Asura
                     return FindFromParsedELF<M>(
                       data,
                       funcName,
-                      found_module->baseAddress());
+                      view_as<ptr_t>(found_module->begin));
                 }
                 /* Wine compability */
                 else if (std::memcmp(data,
@@ -197,42 +196,38 @@ namespace Asura
                     return FindFromParsedPE<M>(
                       data,
                       funcName,
-                      found_module->baseAddress());
+                      view_as<ptr_t>(found_module->begin));
                 }
                 else
                 {
                     ASURA_EXCEPTION("Could not find any compatible file "
                                     "format for "
-                                    + found_module->path());
+                                    + found_module->path);
                 }
             };
 
             if constexpr (not M)
             {
-                std::ifstream file(found_module->path(),
-                                   std::ios::binary | std::ios::in);
-
-                if (not file.is_open())
+                /**
+                 * Only the pages of the headers and of the symbols
+                 * looked at are read from the disk.
+                 */
+                const auto mapped_file = MapFile(found_module->path);
+
+                if (mapped_file->size() < sizeof(ELF::Elf_Ehdr<
+                                                 std::uint64_t>))
                 {
-                    ASURA_EXCEPTION("Couldn't open file "
-                                    + found_module->path());
-                    return {};
+                    ASURA_EXCEPTION("File too small: "
+                                    + found_module->path);
                 }
 
-                file.seekg(0, std::ios::end);
-                const auto file_size = file.tellg();
-                file.seekg(0, std::ios::beg);
-
-                bytes_t file_bytes(file_size);
-                file.read(view_as<char*>(file_bytes.data()), file_size);
-                file.close();
-
-                return test_magic_numbers_and_parse(file_bytes.data());
+                return test_magic_numbers_and_parse(
+                  view_as<ptr_t>(mapped_file->data()));
             }
             else
             {
                 return test_magic_numbers_and_parse(
-                  found_module->baseAddress());
+                  view_as<ptr_t>(found_module->begin));
             }
         }
 
@@ -0,0 +1,168 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "memoryutils.h"
+#include "pageresidency.h"
+
+using namespace Asura;
+
+PageResidency::PageResidency(const ProcessBase& process)
+{
+#ifndef WINDOWS
+    _pagemap_fd = open(
+      ("/proc/" + std::to_string(process.id()) + "/pagemap").c_str(),
+      O_RDONLY | O_CLOEXEC);
+#else
+    static_cast<void>(process);
+#endif
+}
+
+PageResidency::~PageResidency()
+{
+#ifndef WINDOWS
+    if (_pagemap_fd >= 0)
+    {
+        close(_pagemap_fd);
+    }
+#endif
+}
+
+auto PageResidency::isAvailable() const -> bool
+{
+    return _pagemap_fd >= 0;
+}
+
+auto PageResidency::residentRanges(const std::uintptr_t begin,
+                                   const std::uintptr_t end,
+                                   ranges_t& ranges) -> std::size_t
+{
+    const auto add_range = [&](const std::uintptr_t rangeBegin,
+                               const std::uintptr_t rangeEnd)
+    {
+        if (not ranges.empty() and ranges.back().end == rangeBegin)
+        {
+            ranges.back().end = rangeEnd;
+        }
+        else
+        {
+            ranges.push_back({ .begin = rangeBegin, .end = rangeEnd });
+        }
+    };
+
+    if (not isAvailable())
+    {
+        add_range(begin, end);
+        return 0;
+    }
+
+#ifndef WINDOWS
+    const auto page_size       = MemoryUtils::GetPageSize();
+    const auto zero_page_frame = ZeroPageFrame();
+    std::size_t skipped        = 0;
+
+    _entries.resize(ENTRIES_PER_READ);
+
+    for (auto address = begin; address < end;)
+    {
+        const auto entry_count = std::min(ENTRIES_PER_READ,
+                                          (end - address) / page_size);
+        const auto read_size   = entry_count * sizeof(std::uint64_t);
+
+        const auto ret = pread(_pagemap_fd,
+                               _entries.data(),
+                               read_size,
+                               view_as<off_t>((address / page_size)
+                                              * sizeof(std::uint64_t)));
+
+        /* Can't tell, keep the rest */
+        if (ret != view_as<decltype(ret)>(read_size))
+        {
+            add_range(address, end);
+            break;
+        }
+
+        for (std::size_t i = 0; i < entry_count; i++)
+        {
+            const auto entry = _entries[i];
+
+            const auto resident = (entry & SWAPPED_BIT)
+                                  or ((entry & PRESENT_BIT)
+                                      and (zero_page_frame == 0
+                                           or (entry & PFN_MASK)
+                                                != zero_page_frame));
+
+            if (resident)
+            {
+                add_range(address, address + page_size);
+            }
+            else
+            {
+                skipped += page_size;
+            }
+
+            address += page_size;
+        }
+    }
+
+    return skipped;
+#else
+    return 0;
+#endif
+}
+
+auto PageResidency::ZeroPageFrame() -> std::uint64_t
+{
+#ifndef WINDOWS
+    static std::once_flag once_flag;
+    static std::uint64_t zero_page_frame = 0;
+
+    /* Reading an untouched anonymous page maps the zero page */
+    std::call_once(
+      once_flag,
+      []()
+      {
+          const auto page_size = MemoryUtils::GetPageSize();
+          const auto page      = mmap(nullptr,
+                                 page_size,
+                                 PROT_READ,
+                                 MAP_PRIVATE | MAP_ANONYMOUS,
+                                 -1,
+                                 0);
+
+          if (page == MAP_FAILED)
+          {
+              return;
+          }
+
+          static_cast<void>(*view_as<volatile byte_t*>(page));
+
+          const auto pagemap_fd = open("/proc/self/pagemap",
+                                       O_RDONLY | O_CLOEXEC);
+
+          if (pagemap_fd >= 0)
+          {
+              std::uint64_t entry = 0;
+
+              const auto ret = pread(
+                pagemap_fd,
+                &entry,
+                sizeof(entry),
+                view_as<off_t>((view_as<std::uintptr_t>(page) / page_size)
+                               * sizeof(entry)));
+
+              if (ret == sizeof(entry) and (entry & PRESENT_BIT))
+              {
+                  zero_page_frame = entry & PFN_MASK;
+              }
+
+              close(pagemap_fd);
+          }
+
+          munmap(page, page_size);
+      });
+
+    return zero_page_frame;
+#else
+    return 0;
+#endif
+}
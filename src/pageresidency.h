@@ -0,0 +1,64 @@
+#ifndef ASURA_PAGERESIDENCY_H
+#define ASURA_PAGERESIDENCY_H
+
+#include "processbase.h"
+
+namespace Asura
+{
+    /**
+     * Tells which pages of a process are backed by memory, from
+     * /proc/pid/pagemap.
+     * Pages never touched, or only mapped to the shared zero page, read
+     * as zeroes and can be skipped when looking for data.
+     */
+    class PageResidency
+    {
+      public:
+        struct Range
+        {
+            std::uintptr_t begin;
+            std::uintptr_t end;
+        };
+
+        using ranges_t = std::vector<Range>;
+
+        static constexpr inline std::uint64_t PRESENT_BIT = 1ull << 63;
+        static constexpr inline std::uint64_t SWAPPED_BIT = 1ull << 62;
+        static constexpr inline std::uint64_t PFN_MASK = (1ull << 55) - 1;
+        /* pagemap entries read at once */
+        static constexpr inline std::size_t ENTRIES_PER_READ = 0x1000;
+
+      public:
+        explicit PageResidency(const ProcessBase& process);
+        ~PageResidency();
+
+        PageResidency(const PageResidency&)                    = delete;
+        auto operator=(const PageResidency&) -> PageResidency& = delete;
+
+      public:
+        auto isAvailable() const -> bool;
+
+      public:
+        /**
+         * Appends the resident ranges between begin and end, merged
+         * when contiguous, and returns how many bytes were skipped.
+         * When pagemap isn't available, the whole range is resident.
+         */
+        auto residentRanges(const std::uintptr_t begin,
+                            const std::uintptr_t end,
+                            ranges_t& ranges) -> std::size_t;
+
+      private:
+        /**
+         * Page frame of the shared zero page, 0 when the page frames are
+         * hidden to us (needs CAP_SYS_ADMIN).
+         */
+        static auto ZeroPageFrame() -> std::uint64_t;
+
+      private:
+        int _pagemap_fd { -1 };
+        std::vector<std::uint64_t> _entries;
+    };
+}
+
+#endif
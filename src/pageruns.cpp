@@ -0,0 +1,160 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "memoryutils.h"
+#include "pageruns.h"
+#include "processbase.h"
+
+using namespace Asura;
+
+static constexpr auto READ_WRITE = MemoryArea::ProtectionFlags::R
+                                   | MemoryArea::ProtectionFlags::W;
+
+auto PageRuns::runs() const -> const std::vector<Run>&
+{
+    return _runs;
+}
+
+auto PageRuns::add(const MemoryAreaTable& table,
+                   const std::uintptr_t address,
+                   const std::size_t size) -> void
+{
+    const auto page_size = MemoryUtils::GetPageSize();
+    const auto end = MemoryUtils::AlignToPageSize(address + size,
+                                                  page_size);
+
+    for (auto page = MemoryUtils::Align(address, page_size); page < end;)
+    {
+        const auto area_index = table.search(page);
+
+        if (area_index == MemoryAreaTable::INVALID_INDEX)
+        {
+            std::stringstream ss;
+            ss << std::hex << page;
+
+            ASURA_EXCEPTION("Could not find area for address: "
+                            + ss.str());
+        }
+
+        const auto area    = table.view(area_index);
+        const auto run_end = std::min(end, area.end());
+
+        /**
+         * Contiguous pages with the same protections are merged, ranges
+         * sharing a page land in the same run.
+         */
+        if (not _runs.empty() and _runs.back().end >= page
+            and _runs.back().flags == area.flags())
+        {
+            _runs.back().end = std::max(_runs.back().end, run_end);
+        }
+        else
+        {
+            _runs.push_back(
+              { .begin = page, .end = run_end, .flags = area.flags() });
+        }
+
+        page = run_end;
+    }
+}
+
+auto PageRuns::clear() -> void
+{
+    _runs.clear();
+}
+
+auto PageRuns::protect(const process_id_t pid, const bool writable) const
+  -> void
+{
+    std::exception_ptr restore_error;
+
+    for (std::size_t i = 0; i < _runs.size(); i++)
+    {
+        /* Already what we need */
+        if ((_runs[i].flags & READ_WRITE) == READ_WRITE)
+        {
+            continue;
+        }
+
+        try
+        {
+            ProtectRun(pid, _runs[i], writable);
+        }
+        catch (Exception&)
+        {
+            if (not writable)
+            {
+                if (not restore_error)
+                {
+                    restore_error = std::current_exception();
+                }
+
+                continue;
+            }
+
+            /**
+             * Nothing is left writable, the failed run too as it may
+             * have been changed partly.
+             */
+            for (std::size_t j = 0; j <= i; j++)
+            {
+                if ((_runs[j].flags & READ_WRITE) == READ_WRITE)
+                {
+                    continue;
+                }
+
+                try
+                {
+                    ProtectRun(pid, _runs[j], false);
+                }
+                catch (Exception&)
+                {
+                }
+            }
+
+            throw;
+        }
+    }
+
+    if (restore_error)
+    {
+        std::rethrow_exception(restore_error);
+    }
+}
+
+auto PageRuns::ProtectRun(const process_id_t pid,
+                          const Run& run,
+                          const bool writable) -> void
+{
+    /* Executable pages stay executable, they might be running */
+    const auto flags = writable ? run.flags | READ_WRITE : run.flags;
+
+    if (pid != ProcessBase::self().id())
+    {
+        MemoryUtils::ProtectMemoryArea(pid,
+                                       run.begin,
+                                       run.end - run.begin,
+                                       flags);
+        return;
+    }
+
+#ifdef WINDOWS
+    DWORD old_flags;
+
+    if (not VirtualProtect(view_as<ptr_t>(run.begin),
+                           run.end - run.begin,
+                           MemoryArea::ProtectionFlags::ToOS(flags),
+                           &old_flags))
+    {
+        ASURA_EXCEPTION("VirtualProtect failed");
+    }
+#else
+    if (mprotect(view_as<ptr_t>(run.begin),
+                 run.end - run.begin,
+                 view_as<int>(MemoryArea::ProtectionFlags::ToOS(flags)))
+        < 0)
+    {
+        ASURA_EXCEPTION("mprotect failed");
+    }
+#endif
+}
@@ -0,0 +1,57 @@
+#ifndef ASURA_PAGERUNS_H
+#define ASURA_PAGERUNS_H
+
+#include "memoryareatable.h"
+
+namespace Asura
+{
+    /**
+     * Pages touched by a bunch of writes, grouped in runs of contiguous
+     * pages with the same protections, so they're made writable once
+     * per run then restored.
+     * Used by PatchSet and HookBatch.
+     */
+    class PageRuns
+    {
+      public:
+        struct Run
+        {
+            std::uintptr_t begin;
+            std::uintptr_t end;
+            mapf_t flags;
+        };
+
+      public:
+        auto runs() const -> const std::vector<Run>&;
+
+      public:
+        /**
+         * Ranges are added sorted by address, the areas they're in are
+         * taken from the table.
+         */
+        auto add(const MemoryAreaTable& table,
+                 const std::uintptr_t address,
+                 const std::size_t size) -> void;
+        auto clear() -> void;
+
+        /**
+         * Our own process is protected directly, others through
+         * MemoryUtils::ProtectMemoryArea.
+         * When making them writable fails, the runs already changed are
+         * restored before throwing. When restoring, every run is gone
+         * through and the first error is thrown at the end.
+         */
+        auto protect(const process_id_t pid, const bool writable) const
+          -> void;
+
+      private:
+        static auto ProtectRun(const process_id_t pid,
+                               const Run& run,
+                               const bool writable) -> void;
+
+      private:
+        std::vector<Run> _runs;
+    };
+}
+
+#endif
@@ -0,0 +1,208 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "patchset.h"
+
+using namespace Asura;
+
+PatchSet::PatchSet(Process& process)
+ : _process(process)
+{
+}
+
+auto PatchSet::patches() const -> const std::vector<Patch>&
+{
+    return _patches;
+}
+
+auto PatchSet::isApplied() const -> bool
+{
+    return _applied;
+}
+
+auto PatchSet::add(const std::uintptr_t address, const bytes_t& bytes)
+  -> void
+{
+    if (_applied)
+    {
+        ASURA_EXCEPTION("Can't add a patch to an applied patch set");
+    }
+
+    if (bytes.empty())
+    {
+        return;
+    }
+
+    _patches.push_back(
+      { .address = address, .bytes = bytes, .original = {} });
+}
+
+auto PatchSet::clear() -> void
+{
+    if (_applied)
+    {
+        ASURA_EXCEPTION("Can't clear an applied patch set");
+    }
+
+    _patches.clear();
+}
+
+auto PatchSet::apply() -> void
+{
+    if (_applied)
+    {
+        ASURA_EXCEPTION("Patch set is already applied");
+    }
+
+    std::sort(_patches.begin(),
+              _patches.end(),
+              [](const Patch& lhs, const Patch& rhs)
+              {
+                  return lhs.address < rhs.address;
+              });
+
+    for (std::size_t i = 1; i < _patches.size(); i++)
+    {
+        const auto& previous = _patches[i - 1];
+
+        if (previous.address + previous.bytes.size()
+            > _patches[i].address)
+        {
+            std::stringstream ss;
+            ss << std::hex << _patches[i].address;
+
+            ASURA_EXCEPTION("Patches overlap at address: " + ss.str());
+        }
+    }
+
+    /* Only once for the whole set */
+    _process.mmap().refresh();
+
+    const auto page_runs = pageRuns();
+
+    bool is_writable   = false;
+    bool read_original = false;
+
+    try
+    {
+        page_runs.protect(_process.id(), true);
+        is_writable = true;
+
+        MemoryUtils::transfers_t transfers;
+        transfers.reserve(_patches.size());
+
+        for (auto&& patch : _patches)
+        {
+            patch.original.resize(patch.bytes.size());
+
+            transfers.push_back({ .local  = patch.original.data(),
+                                  .remote = patch.address,
+                                  .size   = patch.original.size() });
+        }
+
+        MemoryUtils::ReadProcessMemoryAreas(_process.id(), transfers);
+        read_original = true;
+
+        write(false);
+    }
+    catch (...)
+    {
+        /* Don't leave the set half applied */
+        if (read_original)
+        {
+            try
+            {
+                write(true);
+            }
+            catch (Exception&)
+            {
+            }
+        }
+
+        /* protect already put back what it changed when it failed */
+        if (is_writable)
+        {
+            try
+            {
+                page_runs.protect(_process.id(), false);
+            }
+            catch (Exception&)
+            {
+            }
+        }
+
+        throw;
+    }
+
+    /* Written, even if a protection can't be restored */
+    _applied = true;
+
+    page_runs.protect(_process.id(), false);
+}
+
+auto PatchSet::revert() -> void
+{
+    if (not _applied)
+    {
+        ASURA_EXCEPTION("Patch set isn't applied");
+    }
+
+    _process.mmap().refresh();
+
+    const auto page_runs = pageRuns();
+
+    page_runs.protect(_process.id(), true);
+
+    try
+    {
+        write(true);
+    }
+    catch (...)
+    {
+        try
+        {
+            page_runs.protect(_process.id(), false);
+        }
+        catch (Exception&)
+        {
+        }
+
+        throw;
+    }
+
+    _applied = false;
+
+    page_runs.protect(_process.id(), false);
+}
+
+auto PatchSet::pageRuns() const -> PageRuns
+{
+    const auto& table = _process.mmap().areaTable();
+
+    PageRuns page_runs;
+
+    /* Patches are sorted */
+    for (const auto& patch : _patches)
+    {
+        page_runs.add(table, patch.address, patch.bytes.size());
+    }
+
+    return page_runs;
+}
+
+auto PatchSet::write(const bool original) -> void
+{
+    MemoryUtils::transfers_t transfers;
+    transfers.reserve(_patches.size());
+
+    for (auto&& patch : _patches)
+    {
+        auto& bytes = original ? patch.original : patch.bytes;
+
+        transfers.push_back({ .local  = bytes.data(),
+                              .remote = patch.address,
+                              .size   = bytes.size() });
+    }
+
+    MemoryUtils::WriteProcessMemoryAreas(_process.id(), transfers);
+}
@@ -0,0 +1,63 @@
+#ifndef ASURA_PATCHSET_H
+#define ASURA_PATCHSET_H
+
+#include "pageruns.h"
+#include "process.h"
+
+namespace Asura
+{
+    /**
+     * Writes a bunch of patches at once.
+     * The pages touched are made writable once per contiguous run of
+     * pages, everything is written with one vectored call, then the
+     * protections are restored.
+     * The original bytes are kept so the whole set can be reverted the
+     * same way.
+     */
+    class PatchSet
+    {
+      public:
+        struct Patch
+        {
+            std::uintptr_t address;
+            bytes_t bytes;
+            /* Filled when applied */
+            bytes_t original;
+        };
+
+      public:
+        explicit PatchSet(Process& process);
+
+      public:
+        auto patches() const -> const std::vector<Patch>&;
+        auto isApplied() const -> bool;
+
+      public:
+        auto add(const std::uintptr_t address, const bytes_t& bytes)
+          -> void;
+        auto clear() -> void;
+
+        auto apply() -> void;
+        auto revert() -> void;
+
+        auto add(const auto address,
+                 const auto ptr,
+                 const std::size_t size) -> void
+        {
+            add(view_as<std::uintptr_t>(address),
+                bytes_t(view_as<const byte_t*>(ptr),
+                        view_as<const byte_t*>(ptr) + size));
+        }
+
+      private:
+        auto pageRuns() const -> PageRuns;
+        auto write(const bool original) -> void;
+
+      private:
+        Process& _process;
+        std::vector<Patch> _patches;
+        bool _applied {};
+    };
+}
+
+#endif
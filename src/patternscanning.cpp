@@ -3,6 +3,7 @@
 #include "builtins.h"
 #include "exception.h"
 #include "memoryutils.h"
+#include "pageresidency.h"
 #include "patternbyte.h"
 #include "patternscanning.h"
 #include "simd.h"
@@ -65,6 +66,121 @@ auto Asura::PatternScanning::searchInProcessWithAreaName(
     }
 }
 
+auto Asura::PatternScanning::searchInProcessResident(
+  PatternByte& pattern,
+  const Process& process,
+  ResidencyStats& residencyStats,
+  const std::function<
+    auto(PatternByte&, const data_t, const std::size_t, const ptr_t)
+      ->bool>& searchMethod) -> void
+{
+    const auto& mmap      = process.mmap();
+    const auto& area_name = pattern.areaName();
+
+    PageResidency page_residency(process);
+    PageResidency::ranges_t ranges;
+    MemoryUtils::transfers_t transfers;
+
+    struct alignas(sizeof(SIMD::value_t)) SIMDBlock
+    {
+        byte_t bytes[sizeof(SIMD::value_t)];
+    };
+
+    std::vector<SIMDBlock> area_read;
+
+    for (const auto& area : mmap.areas())
+    {
+        if (not area->isReadable()
+            or (not area_name.empty()
+                and area->name().find(area_name) == std::string::npos))
+        {
+            continue;
+        }
+
+        ranges.clear();
+
+        /* Anonymous areas, [heap], [stack], [anon:*] etc. */
+        if (area->name().empty() or area->name().front() == '[')
+        {
+            residencyStats.skipped_bytes += page_residency.residentRanges(
+              area->begin(),
+              area->end(),
+              ranges);
+        }
+        else
+        {
+            ranges.push_back(
+              { .begin = area->begin(), .end = area->end() });
+        }
+
+        /**
+         * Every range is surrounded by a SIMD value, like readAligned,
+         * so the scans can safely load a bit before and after.
+         */
+        std::size_t values_count = 1;
+        transfers.clear();
+
+        for (const auto& range : ranges)
+        {
+            transfers.push_back(
+              { .local  = view_as<ptr_t>(values_count),
+                .remote = range.begin,
+                .size   = range.end - range.begin });
+
+            values_count += (range.end - range.begin)
+                              / sizeof(SIMD::value_t)
+                            + 1;
+        }
+
+        area_read.resize(values_count);
+
+        for (auto&& transfer : transfers)
+        {
+            transfer.local = area_read.data()
+                             + view_as<std::size_t>(transfer.local);
+        }
+
+        std::vector<bool> readable(transfers.size(), true);
+
+        try
+        {
+            MemoryUtils::ReadProcessMemoryAreas(process.id(), transfers);
+        }
+        catch (Exception&)
+        {
+            for (std::size_t i = 0; i < transfers.size(); i++)
+            {
+                try
+                {
+                    MemoryUtils::ReadProcessMemoryAreas(process.id(),
+                                                        { transfers[i] });
+                }
+                catch (Exception&)
+                {
+                    readable[i] = false;
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < transfers.size(); i++)
+        {
+            if (not readable[i])
+            {
+                continue;
+            }
+
+            const auto& transfer = transfers[i];
+
+            searchMethod(pattern,
+                         view_as<data_t>(transfer.local),
+                         transfer.size,
+                         view_as<ptr_t>(transfer.remote));
+
+            residencyStats.scanned_bytes += transfer.size;
+        }
+    }
+}
+
 auto Asura::PatternScanning::searchV1(PatternByte& pattern,
                                       const data_t data,
                                       const std::size_t size,
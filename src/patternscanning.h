@@ -9,6 +9,13 @@ namespace Asura
 
     class PatternScanning
     {
+      public:
+        struct ResidencyStats
+        {
+            std::size_t scanned_bytes;
+            std::size_t skipped_bytes;
+        };
+
       public:
         static auto searchInProcess(
           PatternByte& pattern,
@@ -27,6 +34,25 @@ namespace Asura
               ->bool>& searchMethod
           = searchV4) -> void;
 
+        /**
+         * Same as searchInProcess, but the pages of anonymous areas that
+         * were never touched, or only mapped to the zero page, are
+         * neither read nor scanned.
+         * File backed areas are always scanned entirely, their pages
+         * are loaded only once accessed.
+         * Each resident range is scanned on its own: a match that runs
+         * into a skipped page isn't found, even when the pattern's
+         * bytes there are zeroes or unknown.
+         */
+        static auto searchInProcessResident(
+          PatternByte& pattern,
+          const Process& process,
+          ResidencyStats& residencyStats,
+          const std::function<
+            auto(PatternByte&, const data_t, const std::size_t, const ptr_t)
+              ->bool>& searchMethod
+          = searchV4) -> void;
+
         /**
          * This works by making the preprocessed pattern into simd
          * values, with its mask. The mask is basically used for
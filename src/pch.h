@@ -4,19 +4,23 @@
 /* std */
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <bit>
 #include <bitset>
 #include <cassert>
 #include <cerrno>
+#include <charconv>
 #include <chrono>
 #include <climits>
 #include <cmath>
 #include <concepts>
+#include <condition_variable>
 #include <csignal>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <deque>
 #include <exception>
 #include <filesystem>
 #include <fstream>
@@ -24,14 +28,19 @@
 #include <iostream>
 #include <limits>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <optional>
 #include <random>
 #include <regex>
+#include <span>
 #include <sstream>
+#include <string_view>
 #include <thread>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -56,17 +65,22 @@
 
 /* OS specific stuffs */
 #ifndef WINDOWS
+    #include <dirent.h>
     #include <dlfcn.h>
     #include <fcntl.h>
+    #include <poll.h>
 
     #include <sys/file.h>
     #include <sys/ioctl.h>
     #include <sys/mman.h>
     #include <sys/stat.h>
+    #include <sys/syscall.h>
     #include <sys/types.h>
     #include <sys/uio.h>
     #include <sys/wait.h>
+    #include <unistd.h>
 
+    #include <linux/futex.h>
     #include <linux/limits.h>
 #else
     #include <windows.h>
@@ -1,3 +1,131 @@
 #include "pch.h"
 
 #include "pe.h"
+
+using namespace Asura;
+
+auto PE::ResolveForwardedFunction(
+  const std::string& forwardedName,
+  const forwarded_handler_t& handleForwardedFunction) -> module_sym_t
+{
+    const auto dot_pos = forwardedName.find('.');
+
+    if (dot_pos == std::string::npos)
+    {
+        ASURA_EXCEPTION("Should never happen (but still happens?): "
+                        + forwardedName);
+    }
+
+    if (handleForwardedFunction == nullptr)
+    {
+        ASURA_EXCEPTION("Pointer required for: " + forwardedName);
+    }
+
+    return handleForwardedFunction(forwardedName.substr(0, dot_pos + 1),
+                                   forwardedName.substr(dot_pos + 1));
+}
+
+PE::ExportIndex::ExportIndex(const std::uint32_t ordinalBase)
+ : _ordinal_base(ordinalBase)
+{
+}
+
+auto PE::ExportIndex::ordinalBase() const -> std::uint32_t
+{
+    return _ordinal_base;
+}
+
+auto PE::ExportIndex::exports() const -> const std::vector<Export>&
+{
+    return _exports;
+}
+
+auto PE::ExportIndex::names() const
+  -> const std::unordered_map<std::string, std::uint32_t>&
+{
+    return _by_name;
+}
+
+auto PE::ExportIndex::size() const -> std::size_t
+{
+    return _exports.size();
+}
+
+auto PE::ExportIndex::addExport(const std::uint32_t rva,
+                                const std::string& forwardedName)
+  -> void
+{
+    _exports.push_back({ .rva            = rva,
+                         .forwarded_name = forwardedName,
+                         .resolved       = std::nullopt });
+}
+
+auto PE::ExportIndex::addName(const std::string& name,
+                              const std::uint32_t ordinal) -> void
+{
+    if (ordinal < _ordinal_base or ordinal - _ordinal_base >= size())
+    {
+        ASURA_EXCEPTION("Ordinal " + std::to_string(ordinal)
+                        + " out of the exports for " + name);
+    }
+
+    _by_name.emplace(name, ordinal - _ordinal_base);
+}
+
+auto PE::ExportIndex::find(
+  const std::string& funcName,
+  const std::uintptr_t baseAddress,
+  const forwarded_handler_t& handleForwardedFunction) -> module_sym_t
+{
+    std::uint32_t export_index;
+
+    if (not funcName.empty()
+        and std::all_of(funcName.begin(),
+                        funcName.end(),
+                        [](const std::uint8_t& c)
+                        {
+                            return std::isdigit(c);
+                        }))
+    {
+        export_index = view_as<std::uint32_t>(std::stoul(funcName))
+                       - _ordinal_base;
+
+        if (export_index >= size())
+        {
+            return { 0, 0 };
+        }
+    }
+    else
+    {
+        const auto it = _by_name.find(funcName);
+
+        if (it == _by_name.end())
+        {
+            return { 0, 0 };
+        }
+
+        export_index = it->second;
+    }
+
+    auto& exported = _exports[export_index];
+
+    /* Unused ordinal */
+    if (not exported.rva)
+    {
+        return { 0, 0 };
+    }
+
+    if (exported.forwarded_name.empty())
+    {
+        return { baseAddress, baseAddress + exported.rva };
+    }
+
+    if (not exported.resolved)
+    {
+        exported.resolved = ResolveForwardedFunction(
+          exported.forwarded_name,
+          handleForwardedFunction);
+    }
+
+    return *exported.resolved;
+}
@@ -10,6 +10,64 @@ namespace Asura
     {
         constexpr inline std::uint16_t MAGIC_NUMBER = 0x5A4D;
 
+        using forwarded_handler_t = std::function<
+          auto(const std::string&, const std::string&)->module_sym_t>;
+
+        /* dll.function, resolved through the handler */
+        auto ResolveForwardedFunction(
+          const std::string& forwardedName,
+          const forwarded_handler_t& handleForwardedFunction)
+          -> module_sym_t;
+
+        /**
+         * Every export of a module by name and ordinal, for resolving
+         * many of them without going through the export directory
+         * again.
+         * Forwarded exports are resolved once, then kept.
+         */
+        class ExportIndex
+        {
+          public:
+            struct Export
+            {
+                std::uint32_t rva;
+                /* Empty unless forwarded to another module */
+                std::string forwarded_name;
+                std::optional<module_sym_t> resolved;
+            };
+
+          public:
+            explicit ExportIndex(const std::uint32_t ordinalBase = 0);
+
+          public:
+            auto ordinalBase() const -> std::uint32_t;
+            auto exports() const -> const std::vector<Export>&;
+            /* To the index in exports() */
+            auto names() const
+              -> const std::unordered_map<std::string, std::uint32_t>&;
+            auto size() const -> std::size_t;
+
+          public:
+            auto addExport(const std::uint32_t rva,
+                           const std::string& forwardedName = {})
+              -> void;
+            /* Names an export already added, from its ordinal */
+            auto addName(const std::string& name,
+                         const std::uint32_t ordinal) -> void;
+
+            /* The name can also be an ordinal, like for the directory */
+            auto find(const std::string& funcName,
+                      const std::uintptr_t baseAddress,
+                      const forwarded_handler_t& handleForwardedFunction)
+              -> module_sym_t;
+
+          private:
+            std::uint32_t _ordinal_base;
+            /* By ordinal minus the base */
+            std::vector<Export> _exports;
+            std::unordered_map<std::string, std::uint32_t> _by_name;
+        };
+
         namespace IMAGE
         {
             constexpr inline auto NUMBEROF_DIRECTORY_ENTRIES = 16;
@@ -245,9 +303,7 @@ namespace Asura
                   const DOS_HEADER* const dosHeader,
                   const std::string& funcName,
                   const auto baseAddress,
-                  const std::function<
-                    auto(const std::string&, const std::string&)
-                      ->module_sym_t> handleForwardedFunction) const
+                  const forwarded_handler_t& handleForwardedFunction) const
                   -> module_sym_t
                 {
                     const auto exp_dir_entry = &OptionalHeader.DataDirectory
@@ -276,72 +332,36 @@ namespace Asura
                         }
                     };
 
-                    const auto export_directory = view_as<
-                      const IMAGE::EXPORT_DIRECTORY* const>(
-                      get_va(entry_rva));
-
-                    if (not export_directory)
+                    /* No exports */
+                    if (not entry_rva)
                     {
                         return { 0, 0 };
                     }
 
-                    const auto funcs = view_as<T*>(
+                    const auto export_directory = view_as<
+                      const IMAGE::EXPORT_DIRECTORY* const>(
+                      get_va(entry_rva));
+
+                    const auto funcs = view_as<const std::uint32_t*>(
                       get_va(export_directory->AddressOfFunctions));
 
-                    const auto names = view_as<T*>(
+                    const auto names = view_as<const std::uint32_t*>(
                       get_va(export_directory->AddressOfNames));
 
-                    const auto ordinals = view_as<T*>(
+                    const auto ordinals = view_as<const std::uint16_t*>(
                       get_va(export_directory->AddressOfNameOrdinals));
 
-                    /* dll.function */
-                    const auto do_forwarded_function =
-                      [&](const auto func_ptr)
-                    {
-                        const std::string& forward_func_name(
-                          view_as<const char* const>(func_ptr));
-
-                        const auto dot_pos = forward_func_name.find('.');
-
-                        if (dot_pos != std::string::npos)
-                        {
-                            const auto module_name = forward_func_name
-                                                       .substr(0,
-                                                               dot_pos
-                                                                 + 1);
-
-                            const auto real_func_name = forward_func_name
-                                                          .substr(
-                                                            dot_pos + 1,
-                                                            forward_func_name
-                                                              .size());
-
-                            if (handleForwardedFunction == nullptr)
-                            {
-                                ASURA_EXCEPTION("Pointer required for: "
-                                                + forward_func_name);
-                            }
-
-                            return handleForwardedFunction(module_name,
-                                                           real_func_name);
-                        }
-                        else
-                        {
-                            ASURA_EXCEPTION("Should never happen (but "
-                                            "still "
-                                            "happens?): "
-                                            + forward_func_name);
-                        }
-                    };
-
                     const auto process_func =
-                      [&](const auto func_rva) -> module_sym_t
+                      [&](const std::uint32_t func_rva) -> module_sym_t
                     {
                         /* is it forwarded ? */
                         if (func_rva >= entry_rva
                             and func_rva < entry_rva + entry_size)
                         {
-                            return do_forwarded_function(get_va(func_rva));
+                            return ResolveForwardedFunction(
+                              view_as<const char* const>(
+                                get_va(func_rva)),
+                              handleForwardedFunction);
                         }
                         else
                         {
@@ -362,30 +382,130 @@ namespace Asura
                                         return std::isdigit(c);
                                     }))
                     {
-                        return process_func(
-                          funcs[std::stoi(funcName)
-                                - export_directory->Base]);
+                        const auto func_index = std::stoul(funcName)
+                                                - export_directory->Base;
+
+                        if (func_index
+                            >= export_directory->NumberOfFunctions)
+                        {
+                            return { 0, 0 };
+                        }
+
+                        return process_func(funcs[func_index]);
                     }
                     else
                     {
-                        for (std::uint16_t i = 0;
-                             i < export_directory->NumberOfNames;
-                             i++)
+                        /**
+                         * The linker sorts the names, so they can be
+                         * binary searched.
+                         */
+                        const auto names_end = names
+                                               + export_directory
+                                                   ->NumberOfNames;
+
+                        const auto found = std::lower_bound(
+                          names,
+                          names_end,
+                          funcName,
+                          [&](const std::uint32_t name_rva,
+                              const std::string& value)
+                          {
+                              return std::strcmp(
+                                       view_as<const char* const>(
+                                         get_va(name_rva)),
+                                       value.c_str())
+                                     < 0;
+                          });
+
+                        if (found != names_end
+                            and funcName
+                                  == view_as<const char* const>(
+                                    get_va(*found)))
                         {
-                            const std::string func_name = view_as<
-                              const char* const>(get_va(names[i]));
+                            return process_func(
+                              funcs[ordinals[found - names]]);
+                        }
+                    }
 
-                            if (func_name.find(funcName)
-                                != std::string::npos)
-                            {
-                                continue;
-                            }
+                    return { 0, 0 };
+                }
+
+                template <bool M>
+                auto build_export_index(
+                  const DOS_HEADER* const dosHeader) const -> ExportIndex
+                {
+                    const auto exp_dir_entry = &OptionalHeader.DataDirectory
+                                                  [IMAGE::
+                                                     DIRECTORY_ENTRY_EXPORT];
 
-                            return process_func(funcs[ordinals[i]]);
+                    const auto entry_rva  = exp_dir_entry->VirtualAddress;
+                    const auto entry_size = exp_dir_entry->Size;
+
+                    const auto get_va = [&](const auto rva)
+                    {
+                        if constexpr (M)
+                        {
+                            return view_as<std::uintptr_t>(dosHeader)
+                                   + rva;
                         }
+                        else
+                        {
+                            return view_as<std::uintptr_t>(dosHeader)
+                                   + rva_2_raw(rva);
+                        }
+                    };
+
+                    /* No exports */
+                    if (not entry_rva)
+                    {
+                        return ExportIndex();
                     }
 
-                    return { 0, 0 };
+                    const auto export_directory = view_as<
+                      const IMAGE::EXPORT_DIRECTORY* const>(
+                      get_va(entry_rva));
+
+                    const auto funcs = view_as<const std::uint32_t*>(
+                      get_va(export_directory->AddressOfFunctions));
+
+                    const auto names = view_as<const std::uint32_t*>(
+                      get_va(export_directory->AddressOfNames));
+
+                    const auto ordinals = view_as<const std::uint16_t*>(
+                      get_va(export_directory->AddressOfNameOrdinals));
+
+                    ExportIndex export_index(export_directory->Base);
+
+                    for (std::uint32_t i = 0;
+                         i < export_directory->NumberOfFunctions;
+                         i++)
+                    {
+                        const auto func_rva = funcs[i];
+
+                        if (func_rva >= entry_rva
+                            and func_rva < entry_rva + entry_size)
+                        {
+                            export_index.addExport(
+                              func_rva,
+                              view_as<const char* const>(
+                                get_va(func_rva)));
+                        }
+                        else
+                        {
+                            export_index.addExport(func_rva);
+                        }
+                    }
+
+                    for (std::uint32_t i = 0;
+                         i < export_directory->NumberOfNames;
+                         i++)
+                    {
+                        export_index.addName(
+                          view_as<const char* const>(get_va(names[i])),
+                          export_directory->Base + ordinals[i]);
+                    }
+
+                    return export_index;
                 }
             };
 
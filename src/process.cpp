@@ -2,6 +2,7 @@
 
 #include "patternscanning.h"
 #include "process.h"
+#include "processindex.h"
 #include "processmemoryarea.h"
 #include "types.h"
 
@@ -81,35 +82,13 @@ auto Asura::Process::find(const std::string& name) -> Asura::Process
     CloseHandle(tool_handle);
 
 #else
-    for (const auto& entry : std::filesystem::directory_iterator("/proc"))
-    {
-        if (entry.is_directory())
-        {
-            process_id_t pid;
-
-            try
-            {
-                pid = std::stoi(entry.path().filename());
-            }
-            /* could be fs or any folder that is not a number */
-            catch (std::invalid_argument&)
-            {
-                continue;
-            }
-
-            const auto [result, found] = Process::name(pid);
+    ProcessIndex process_index;
 
-            if (not found)
-            {
-                continue;
-            }
+    const auto pid = process_index.find(name);
 
-            if (result.find(name) != std::string::npos)
-            {
-                process = Process(pid);
-                break;
-            }
-        }
+    if (pid != ProcessIndex::INVALID_PID)
+    {
+        process = Process(pid);
     }
 #endif
 
@@ -229,6 +208,11 @@ auto Process::modules() const -> const std::list<Module>&
     return _modules;
 }
 
+auto Process::moduleIndex() const -> const ModuleIndex&
+{
+    return _module_index;
+}
+
 auto Process::search(PatternByte& patternByte) const -> void
 {
     PatternScanning::searchInProcess(patternByte, *this);
@@ -246,38 +230,48 @@ auto Process::modules() -> std::list<Module>&
 
 auto Process::refreshModules() -> void
 {
+    /* Nothing to do when no file mapping changed */
+    if (not _module_index.update(_mmap.areaTable())
+        and not _modules.empty())
+    {
+        return;
+    }
+
+    _module_index.readLoadOrder(id());
+
     _modules.clear();
 
-    const auto& mmap  = this->mmap();
-    const auto& areas = mmap.areas();
-
-    std::for_each(areas.begin(),
-                  areas.end(),
-                  [&](const std::shared_ptr<ProcessMemoryArea>& area)
-                  {
-                      if (area->isDeniedByOS() or not area->isReadable())
-                      {
-                          return;
-                      }
-
-                      const auto area_name = area->name();
-
-                      const auto path = std::filesystem::path(
-                        area->name());
-
-                      if (std::filesystem::exists(path))
-                      {
-                          const auto base_name = path.filename();
-
-                          _modules.push_back({ area->begin<ptr_t>(),
-                                               base_name.string(),
-                                               area->name() });
-                      }
-                  });
-
-    _modules.unique(
-      [](const Module& moduleA, const Module& moduleB)
-      {
-          return (moduleA.name() == moduleB.name());
-      });
+    for (const auto& module : _module_index.modules())
+    {
+        _modules.push_back(
+          { view_as<ptr_t>(module.begin), module.name, module.path });
+    }
+}
+
+auto Process::symbolResolver() -> SymbolResolver&
+{
+    return _symbol_resolver;
+}
+
+auto Process::resolveSymbols(const std::string_view moduleName,
+                             const std::vector<std::string>& names)
+  -> std::vector<SymbolResolver::Resolved>
+{
+    return _symbol_resolver.resolve(_module_index, moduleName, names);
+}
+
+auto Process::nearestSymbol(const std::uintptr_t address)
+  -> std::optional<SymbolResolver::Nearest>
+{
+    return _symbol_resolver.nearest(_module_index, address);
+}
+
+auto Process::resolveSymbolsFromMemory(
+  const std::string_view moduleName,
+  const std::vector<std::string>& names)
+  -> std::vector<RemoteSymbolResolver::Resolved>
+{
+    return RemoteSymbolResolver(id()).resolve(_module_index,
+                                              moduleName,
+                                              names);
 }
@@ -5,11 +5,14 @@
 #include "memoryarea.h"
 #include "memorymap.h"
 #include "memoryutils.h"
+#include "moduleindex.h"
 #include "patternbyte.h"
 #include "processbase.h"
 #include "processmemoryarea.h"
 #include "processmemorymap.h"
+#include "remotesymbolresolver.h"
 #include "runnabletask.h"
+#include "symbolresolver.h"
 
 namespace Asura
 {
@@ -58,12 +61,29 @@ namespace Asura
         auto tasks() const -> tasks_t;
         auto mmap() const -> const ProcessMemoryMap&;
         auto modules() const -> const std::list<Module>&;
+        auto moduleIndex() const -> const ModuleIndex&;
         auto search(PatternByte& patternByte) const -> void;
 
       public:
         auto mmap() -> ProcessMemoryMap&;
         auto modules() -> std::list<Module>&;
         auto refreshModules() -> void;
+        auto symbolResolver() -> SymbolResolver&;
+
+        /* From the modules found by the last refreshModules() */
+        auto resolveSymbols(const std::string_view moduleName,
+                            const std::vector<std::string>& names)
+          -> std::vector<SymbolResolver::Resolved>;
+        auto nearestSymbol(const std::uintptr_t address)
+          -> std::optional<SymbolResolver::Nearest>;
+
+        /**
+         * From the memory of the process instead of the files, only
+         * what's needed is read.
+         */
+        auto resolveSymbolsFromMemory(const std::string_view moduleName,
+                                      const std::vector<std::string>& names)
+          -> std::vector<RemoteSymbolResolver::Resolved>;
 
       public:
         template <std::size_t N = TASK_STACK_SIZE>
@@ -128,6 +148,8 @@ namespace Asura
         std::string _full_name;
         ProcessMemoryMap _mmap;
         std::list<Module> _modules;
+        ModuleIndex _module_index;
+        SymbolResolver _symbol_resolver;
     };
 }
 
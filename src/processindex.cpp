@@ -0,0 +1,517 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "processindex.h"
+
+using namespace Asura;
+
+#ifndef WINDOWS
+/* What getdents64 fills the buffer with */
+struct LinuxDirent64
+{
+    std::uint64_t d_ino;
+    std::int64_t d_off;
+    std::uint16_t d_reclen;
+    std::uint8_t d_type;
+    char d_name[1];
+};
+
+/* Clock ticks since boot, 0 when /proc/pid/stat can't be read */
+static auto ReadStartTime(const process_id_t pid) -> std::uint64_t
+{
+    const auto fd = open(("/proc/" + std::to_string(pid) + "/stat").c_str(),
+                         O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        return 0;
+    }
+
+    std::array<char, 0x400> buffer;
+    const auto read_size = read(fd, buffer.data(), buffer.size() - 1);
+
+    close(fd);
+
+    if (read_size <= 0)
+    {
+        return 0;
+    }
+
+    buffer[view_as<std::size_t>(read_size)] = '\0';
+
+    /* comm can have spaces and parentheses, fields start after it */
+    const auto comm_end = std::strrchr(buffer.data(), ')');
+
+    if (comm_end == nullptr)
+    {
+        return 0;
+    }
+
+    std::istringstream fields(comm_end + 1);
+    std::string field;
+
+    /* state is the third field, starttime the twenty-second */
+    for (int i = 3; i < 22; i++)
+    {
+        fields >> field;
+    }
+
+    std::uint64_t start_time {};
+    fields >> start_time;
+
+    return fields.fail() ? 0 : start_time;
+}
+#endif
+
+ProcessIndex::ProcessIndex()
+{
+#ifndef WINDOWS
+    _proc_fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (_proc_fd < 0)
+    {
+        ASURA_EXCEPTION("Couldn't open /proc");
+    }
+
+    _dirents.resize(DIRENTS_BUFFER_SIZE);
+#endif
+
+    refresh();
+}
+
+ProcessIndex::~ProcessIndex()
+{
+    for (auto&& [pid, entry] : _entries)
+    {
+        release(entry);
+    }
+
+#ifndef WINDOWS
+    close(_proc_fd);
+#endif
+}
+
+auto ProcessIndex::pids() const -> const std::vector<process_id_t>&
+{
+    return _pids;
+}
+
+auto ProcessIndex::refresh() -> void
+{
+    std::vector<process_id_t> pids;
+    pids.reserve(_pids.size());
+
+#ifndef WINDOWS
+    if (lseek(_proc_fd, 0, SEEK_SET) < 0)
+    {
+        ASURA_EXCEPTION("Couldn't rewind /proc");
+    }
+
+    while (true)
+    {
+        const auto read_size = syscall(SYS_getdents64,
+                                       _proc_fd,
+                                       _dirents.data(),
+                                       _dirents.size());
+
+        if (read_size < 0)
+        {
+            ASURA_EXCEPTION("getdents64 failed on /proc with: "
+                            + std::to_string(errno));
+        }
+
+        if (read_size == 0)
+        {
+            break;
+        }
+
+        for (std::size_t offset = 0;
+             offset < view_as<std::size_t>(read_size);)
+        {
+            const auto dirent = view_as<const LinuxDirent64*>(
+              _dirents.data() + offset);
+
+            offset += dirent->d_reclen;
+
+            if (dirent->d_type != DT_DIR)
+            {
+                continue;
+            }
+
+            /* Anything that isn't only a number isn't a process */
+            const std::string_view name(dirent->d_name);
+            process_id_t pid;
+
+            const auto [end, error] = std::from_chars(name.data(),
+                                                      name.data()
+                                                        + name.size(),
+                                                      pid);
+
+            if (error == std::errc() and end == name.data() + name.size())
+            {
+                pids.push_back(pid);
+            }
+        }
+    }
+
+    std::sort(pids.begin(), pids.end());
+
+    /* Processes gone */
+    for (auto it = _entries.begin(); it != _entries.end();)
+    {
+        if (not std::binary_search(pids.begin(), pids.end(), it->first))
+        {
+            release(it->second);
+            it = _entries.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    for (const auto pid : pids)
+    {
+        const Entry new_entry { .comm       = {},
+                                .exe        = {},
+                                .comm_read  = false,
+                                .exe_read   = false,
+                                .pidfd      = -1,
+                                .start_time = 0 };
+
+        const auto [it, inserted] = _entries.try_emplace(pid, new_entry);
+
+        if (not inserted and isReused(pid, it->second))
+        {
+            release(it->second);
+            it->second = new_entry;
+        }
+    }
+#else
+    const auto tool_handle = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS,
+                                                      0);
+
+    if (tool_handle == INVALID_HANDLE_VALUE)
+    {
+        ASURA_EXCEPTION("Couldn't list processes");
+    }
+
+    _entries.clear();
+
+    PROCESSENTRY32 process_entry32;
+    process_entry32.dwSize = sizeof(process_entry32);
+
+    if (Process32First(tool_handle, &process_entry32))
+    {
+        do
+        {
+            const auto pid = view_as<process_id_t>(
+              process_entry32.th32ProcessID);
+
+            /* The snapshot already has the names */
+            _entries.emplace(pid,
+                             Entry { .comm      = process_entry32.szExeFile,
+                                     .exe       = process_entry32.szExeFile,
+                                     .comm_read = true,
+                                     .exe_read  = true });
+            pids.push_back(pid);
+        }
+        while (Process32Next(tool_handle, &process_entry32));
+    }
+
+    CloseHandle(tool_handle);
+
+    std::sort(pids.begin(), pids.end());
+#endif
+
+    _pids = std::move(pids);
+}
+
+auto ProcessIndex::comm(const process_id_t pid) -> const std::string&
+{
+    auto& entry = _entries.at(pid);
+
+#ifndef WINDOWS
+    if (not entry.comm_read)
+    {
+        if (not entry.start_time)
+        {
+            entry.start_time = ReadStartTime(pid);
+        }
+
+        const auto fd = open(
+          ("/proc/" + std::to_string(pid) + "/comm").c_str(),
+          O_RDONLY | O_CLOEXEC);
+
+        if (fd >= 0)
+        {
+            /* TASK_COMM_LEN */
+            std::array<char, 16> buffer;
+
+            const auto read_size = read(fd, buffer.data(), buffer.size());
+
+            if (read_size > 0)
+            {
+                entry.comm.assign(buffer.data(), read_size);
+
+                if (entry.comm.ends_with('\n'))
+                {
+                    entry.comm.pop_back();
+                }
+            }
+
+            close(fd);
+        }
+
+        entry.comm_read = true;
+    }
+#endif
+
+    return entry.comm;
+}
+
+auto ProcessIndex::exe(const process_id_t pid) -> const std::string&
+{
+    auto& entry = _entries.at(pid);
+
+    if (not entry.exe_read)
+    {
+        readExe(pid, entry);
+    }
+
+    return entry.exe;
+}
+
+auto ProcessIndex::find(const std::string& name) -> process_id_t
+{
+    /* Stops at the first match, so executables are read on demand */
+    for (const auto pid : _pids)
+    {
+        if (exe(pid).find(name) != std::string::npos)
+        {
+            watch(pid, _entries.at(pid));
+            return pid;
+        }
+    }
+
+    return INVALID_PID;
+}
+
+auto ProcessIndex::find(const std::vector<std::string>& names)
+  -> std::vector<process_id_t>
+{
+    std::vector<process_id_t> found(names.size(), INVALID_PID);
+
+    /* Most of them will be needed anyway */
+    resolveExes();
+
+    std::size_t found_count = 0;
+
+    for (const auto pid : _pids)
+    {
+        auto& entry = _entries.at(pid);
+
+        if (entry.exe.empty())
+        {
+            continue;
+        }
+
+        for (std::size_t i = 0; i < names.size(); i++)
+        {
+            if (found[i] == INVALID_PID
+                and entry.exe.find(names[i]) != std::string::npos)
+            {
+                found[i] = pid;
+                found_count++;
+
+                watch(pid, entry);
+            }
+        }
+
+        if (found_count == names.size())
+        {
+            break;
+        }
+    }
+
+    return found;
+}
+
+auto ProcessIndex::isAlive(const process_id_t pid) -> bool
+{
+    const auto it = _entries.find(pid);
+
+    if (it == _entries.end())
+    {
+        return false;
+    }
+
+#ifndef WINDOWS
+    auto& entry = it->second;
+
+    watch(pid, entry);
+
+    if (entry.pidfd < 0)
+    {
+        /* No pidfd support, or it was already gone */
+        return kill(pid, 0) == 0 or errno == EPERM;
+    }
+
+    /* Readable once the process exited */
+    pollfd poll_fd { .fd = entry.pidfd, .events = POLLIN, .revents = 0 };
+
+    return poll(&poll_fd, 1, 0) == 0;
+#else
+    const auto process_handle = OpenProcess(
+      PROCESS_QUERY_LIMITED_INFORMATION,
+      false,
+      view_as<DWORD>(pid));
+
+    if (process_handle == nullptr)
+    {
+        return false;
+    }
+
+    DWORD exit_code;
+    const auto alive = GetExitCodeProcess(process_handle, &exit_code)
+                       and exit_code == STILL_ACTIVE;
+
+    CloseHandle(process_handle);
+
+    return alive;
+#endif
+}
+
+auto ProcessIndex::resolveExes() -> void
+{
+    std::vector<std::pair<process_id_t, Entry*>> unresolved;
+
+    for (const auto pid : _pids)
+    {
+        auto& entry = _entries.at(pid);
+
+        if (not entry.exe_read)
+        {
+            unresolved.emplace_back(pid, &entry);
+        }
+    }
+
+    if (unresolved.size() < PARALLEL_THRESHOLD)
+    {
+        for (auto&& [pid, entry] : unresolved)
+        {
+            readExe(pid, *entry);
+        }
+
+        return;
+    }
+
+    /* Each entry is only touched by one thread */
+    std::atomic_size_t next_index {};
+    std::vector<std::thread> threads(
+      std::max(1u, std::thread::hardware_concurrency()));
+
+    for (auto&& thread : threads)
+    {
+        thread = std::thread(
+          [&]()
+          {
+              for (auto index = next_index++; index < unresolved.size();
+                   index      = next_index++)
+              {
+                  readExe(unresolved[index].first,
+                          *unresolved[index].second);
+              }
+          });
+    }
+
+    for (auto&& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+auto ProcessIndex::readExe(const process_id_t pid, Entry& entry) -> void
+{
+#ifndef WINDOWS
+    /* Before, a pid reused in between is caught at the next refresh */
+    if (not entry.start_time)
+    {
+        entry.start_time = ReadStartTime(pid);
+    }
+
+    std::array<char, PATH_MAX> buffer;
+
+    const auto real_size = readlink(
+      ("/proc/" + std::to_string(pid) + "/exe").c_str(),
+      buffer.data(),
+      buffer.size());
+
+    /* could be a kernel thread */
+    if (real_size > 0)
+    {
+        entry.exe.assign(buffer.data(), real_size);
+    }
+#else
+    static_cast<void>(pid);
+#endif
+
+    entry.exe_read = true;
+}
+
+auto ProcessIndex::watch(const process_id_t pid, Entry& entry) -> void
+{
+#ifndef WINDOWS
+    if (entry.pidfd >= 0)
+    {
+        return;
+    }
+
+    entry.pidfd = view_as<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    static_cast<void>(pid);
+    static_cast<void>(entry);
+#endif
+}
+
+auto ProcessIndex::release(Entry& entry) -> void
+{
+#ifndef WINDOWS
+    if (entry.pidfd >= 0)
+    {
+        close(entry.pidfd);
+        entry.pidfd = -1;
+    }
+#else
+    static_cast<void>(entry);
+#endif
+}
+
+auto ProcessIndex::isReused(const process_id_t pid,
+                            const Entry& entry) const -> bool
+{
+#ifndef WINDOWS
+    /* The watched process exited, the pid is listed again */
+    if (entry.pidfd >= 0)
+    {
+        pollfd poll_fd { .fd      = entry.pidfd,
+                         .events  = POLLIN,
+                         .revents = 0 };
+
+        return poll(&poll_fd, 1, 0) != 0;
+    }
+
+    /* Nothing kept about it */
+    if (not entry.start_time)
+    {
+        return false;
+    }
+
+    return ReadStartTime(pid) != entry.start_time;
+#else
+    static_cast<void>(pid);
+    static_cast<void>(entry);
+
+    return false;
+#endif
+}
@@ -0,0 +1,97 @@
+#ifndef ASURA_PROCESSINDEX_H
+#define ASURA_PROCESSINDEX_H
+
+#include "types.h"
+
+namespace Asura
+{
+    /**
+     * Processes running on the system, listed from /proc in a few
+     * getdents64 calls.
+     * The name and executable of a process are only read when a query
+     * needs them, then kept until the process goes away, so looking for
+     * many names, or looking again later, doesn't read them again.
+     * A pid reused by another process between two refreshes is told
+     * apart by its pidfd or its start time, what was kept is dropped.
+     * Processes found are watched through a pidfd, telling if they're
+     * still alive doesn't need to list /proc again.
+     */
+    class ProcessIndex
+    {
+      public:
+        static constexpr inline process_id_t INVALID_PID = -1;
+        /* Executables resolved by several threads above that */
+        static constexpr inline std::size_t PARALLEL_THRESHOLD = 0x40;
+        static constexpr inline std::size_t DIRENTS_BUFFER_SIZE = 0x8000;
+
+      private:
+        struct Entry
+        {
+            std::string comm;
+            std::string exe;
+            bool comm_read;
+            bool exe_read;
+#ifndef WINDOWS
+            int pidfd;
+            /* From /proc/pid/stat when comm or exe was read, 0 if not */
+            std::uint64_t start_time;
+#endif
+        };
+
+      public:
+        ProcessIndex();
+        ~ProcessIndex();
+
+        ProcessIndex(const ProcessIndex&)                    = delete;
+        auto operator=(const ProcessIndex&) -> ProcessIndex& = delete;
+
+      public:
+        /* Sorted */
+        auto pids() const -> const std::vector<process_id_t>&;
+
+      public:
+        /**
+         * Processes that are still there keep what was already read
+         * about them, unless their pid now belongs to another process.
+         */
+        auto refresh() -> void;
+
+        /* Empty when it can't be read (kernel threads, permissions) */
+        auto comm(const process_id_t pid) -> const std::string&;
+        auto exe(const process_id_t pid) -> const std::string&;
+
+        /**
+         * First process whose executable path contains the name, like
+         * Process::find.
+         */
+        auto find(const std::string& name) -> process_id_t;
+
+        /* One pass for all the names, INVALID_PID for those not found */
+        auto find(const std::vector<std::string>& names)
+          -> std::vector<process_id_t>;
+
+        /**
+         * Doesn't list /proc, the process is watched once found or asked
+         * for the first time.
+         */
+        auto isAlive(const process_id_t pid) -> bool;
+
+      private:
+        auto resolveExes() -> void;
+        auto readExe(const process_id_t pid, Entry& entry) -> void;
+        auto watch(const process_id_t pid, Entry& entry) -> void;
+        auto release(Entry& entry) -> void;
+        auto isReused(const process_id_t pid, const Entry& entry) const
+          -> bool;
+
+      private:
+        std::vector<process_id_t> _pids;
+        std::unordered_map<process_id_t, Entry> _entries;
+#ifndef WINDOWS
+        int _proc_fd { -1 };
+        std::vector<byte_t> _dirents;
+#endif
+    };
+}
+
+#endif
@@ -100,7 +100,8 @@ auto ProcessMemoryArea::write(const bytes_t& bytes,
 auto Asura::ProcessMemoryArea::isDeniedByOS() const -> bool
 {
 #ifndef WIN32
-    return name() == "[vvar]";
+    /* [vvar] and [vvar_vclock] on recent kernels */
+    return name().starts_with("[vvar");
 #else
     return false;
 #endif
@@ -118,6 +119,16 @@ auto Asura::ProcessMemoryArea::isWritable() const -> bool
            and not isDeniedByOS();
 }
 
+auto ProcessMemoryArea::fileOffset() const -> std::uint64_t
+{
+    return _file_offset;
+}
+
+auto ProcessMemoryArea::inode() const -> std::uint64_t
+{
+    return _inode;
+}
+
 auto ProcessMemoryArea::protectionFlags() -> ModifiableProtectionFlags&
 {
     return _protection_flags;
@@ -127,3 +138,10 @@ auto ProcessMemoryArea::initProtectionFlags(mapf_t flags) -> void
 {
     _protection_flags.cachedValue() = flags;
 }
+
+auto ProcessMemoryArea::setFileMapping(const std::uint64_t fileOffset,
+                                       const std::uint64_t inode) -> void
+{
+    _file_offset = fileOffset;
+    _inode       = inode;
+}
@@ -44,10 +44,15 @@ namespace Asura
         auto isDeniedByOS() const -> bool;
         auto isReadable() const -> bool;
         auto isWritable() const -> bool;
+        /* Offset inside the mapped file and its inode, 0 if none */
+        auto fileOffset() const -> std::uint64_t;
+        auto inode() const -> std::uint64_t;
 
       public:
         auto protectionFlags() -> ModifiableProtectionFlags&;
         auto initProtectionFlags(const mapf_t flags) -> void;
+        auto setFileMapping(const std::uint64_t fileOffset,
+                            const std::uint64_t inode) -> void;
 
       public:
         template <typename T = byte_t>
@@ -77,6 +82,8 @@ namespace Asura
       private:
         ModifiableProtectionFlags _protection_flags;
         ProcessBase _process_base;
+        std::uint64_t _file_offset {};
+        std::uint64_t _inode {};
     };
 };
 
@@ -17,6 +17,17 @@ ProcessMemoryMap::ProcessMemoryMap(ProcessBase process)
     refresh();
 }
 
+auto ProcessMemoryMap::ChangeSet::empty() const -> bool
+{
+    return added.empty() and removed.empty() and resized.empty()
+           and protection_changed.empty();
+}
+
+auto ProcessMemoryMap::lastChanges() const -> const ChangeSet&
+{
+    return _last_changes;
+}
+
 auto ProcessMemoryMap::refresh() -> void
 {
     if (_process_base.id() == Process::INVALID_PID)
@@ -24,7 +35,29 @@ auto ProcessMemoryMap::refresh() -> void
         return;
     }
 
-    _areas.clear();
+    auto parsed_areas = parse();
+
+    update(parsed_areas);
+}
+
+auto ProcessMemoryMap::subscribe(change_callback_t callback)
+  -> std::size_t
+{
+    const auto subscriber_id = _next_subscriber_id++;
+
+    _subscribers.emplace(subscriber_id, std::move(callback));
+
+    return subscriber_id;
+}
+
+auto ProcessMemoryMap::unsubscribe(const std::size_t subscriberID) -> void
+{
+    _subscribers.erase(subscriberID);
+}
+
+auto ProcessMemoryMap::parse() const -> std::vector<ParsedArea>
+{
+    std::vector<ParsedArea> parsed_areas;
 
 #ifndef WINDOWS
     std::ifstream file_memory_map("/proc/"
@@ -113,6 +146,14 @@ auto ProcessMemoryMap::refresh() -> void
                             "characters");
         }
 
+        /* Needed to tell which areas belong to the same file mapping */
+        std::uint64_t file_offset {}, inode {};
+        std::string range, perms, device;
+
+        std::istringstream fields(line);
+        fields >> range >> perms >> std::hex >> file_offset >> device
+          >> std::dec >> inode;
+
         const std::regex regex_name(REGEX_NAME);
 
         /* Sometimes there's no name */
@@ -131,17 +172,16 @@ auto ProcessMemoryMap::refresh() -> void
             return true;
         };
 
-        const auto area = std::make_shared<ProcessMemoryArea>(
-          _process_base);
-        area->initProtectionFlags(
-          (is_on(prot[0]) ? MemoryArea::ProtectionFlags::READ : 0)
-          | (is_on(prot[1]) ? MemoryArea::ProtectionFlags::WRITE : 0)
-          | (is_on(prot[2]) ? MemoryArea::ProtectionFlags::EXECUTE : 0));
-        area->setAddress(view_as<ptr_t>(start));
-        area->setSize(end - start);
-        area->setName(name);
-
-        _areas.push_back(std::move(area));
+        parsed_areas.push_back(
+          { start,
+            end,
+            (is_on(prot[0]) ? MemoryArea::ProtectionFlags::READ : 0)
+              | (is_on(prot[1]) ? MemoryArea::ProtectionFlags::WRITE : 0)
+              | (is_on(prot[2]) ? MemoryArea::ProtectionFlags::EXECUTE :
+                                  0),
+            std::move(name),
+            file_offset,
+            inode });
     }
 
     file_memory_map.close();
@@ -167,24 +207,237 @@ auto ProcessMemoryMap::refresh() -> void
          == sizeof(info);
          bs += info.RegionSize)
     {
-        const auto area = std::make_shared<ProcessMemoryArea>(
-          _process_base);
-        area->setAddress(bs);
-        area->setSize(info.RegionSize);
-        area->initProtectionFlags(
-          ProcessMemoryArea::ProtectionFlags::ToOwn(info.Protect));
+        ParsedArea parsed_area {
+            view_as<std::uintptr_t>(bs),
+            view_as<std::uintptr_t>(bs) + info.RegionSize,
+            ProcessMemoryArea::ProtectionFlags::ToOwn(info.Protect),
+            {},
+            0,
+            0
+        };
 
         if (GetModuleFileNameA(view_as<HMODULE>(info.AllocationBase),
                                module_path.data(),
                                module_path.size()))
         {
-            area->setName(std::string(module_path.begin(),
-                                      module_path.end()));
+            parsed_area.name = std::string(module_path.begin(),
+                                           module_path.end());
         }
 
-        _areas.push_back(std::move(area));
+        parsed_areas.push_back(std::move(parsed_area));
     }
 
     CloseHandle(process_handle);
 #endif
+
+    return parsed_areas;
+}
+
+auto ProcessMemoryMap::update(std::vector<ParsedArea>& parsedAreas)
+  -> void
+{
+    ChangeSet changes;
+
+    std::vector<std::shared_ptr<ProcessMemoryArea>> areas;
+    areas.reserve(parsedAreas.size());
+
+    std::sort(parsedAreas.begin(),
+              parsedAreas.end(),
+              [](const ParsedArea& area1, const ParsedArea& area2)
+              {
+                  return area1.begin < area2.begin;
+              });
+
+    /**
+     * Both lists are sorted by address, so we can walk them together.
+     * An area that starts at the same address with the same name is
+     * kept, only its size or protection is updated if the OS split,
+     * merged or changed it.
+     */
+    auto old_area = _areas.begin();
+
+    for (auto&& parsed_area : parsedAreas)
+    {
+        while (old_area != _areas.end()
+               and (*old_area)->begin() < parsed_area.begin)
+        {
+            changes.removed.push_back(std::move(*old_area));
+            old_area++;
+        }
+
+        if (old_area != _areas.end()
+            and (*old_area)->begin() == parsed_area.begin
+            and (*old_area)->name() == parsed_area.name)
+        {
+            auto area = std::move(*old_area);
+            old_area++;
+
+            if (area->end() != parsed_area.end)
+            {
+                area->setSize(parsed_area.end - parsed_area.begin);
+                changes.resized.push_back(area);
+            }
+
+            if (area->protectionFlags().cachedValue()
+                != parsed_area.flags)
+            {
+                area->initProtectionFlags(parsed_area.flags);
+                changes.protection_changed.push_back(area);
+            }
+
+            area->setFileMapping(parsed_area.file_offset,
+                                 parsed_area.inode);
+
+            areas.push_back(std::move(area));
+            continue;
+        }
+
+        /* Same address but another mapping took its place */
+        if (old_area != _areas.end()
+            and (*old_area)->begin() == parsed_area.begin)
+        {
+            changes.removed.push_back(std::move(*old_area));
+            old_area++;
+        }
+
+        const auto area = std::make_shared<ProcessMemoryArea>(
+          _process_base);
+        area->initProtectionFlags(parsed_area.flags);
+        area->setAddress(view_as<ptr_t>(parsed_area.begin));
+        area->setSize(parsed_area.end - parsed_area.begin);
+        area->setName(parsed_area.name);
+        area->setFileMapping(parsed_area.file_offset, parsed_area.inode);
+
+        changes.added.push_back(area);
+        areas.push_back(area);
+    }
+
+    for (; old_area != _areas.end(); old_area++)
+    {
+        changes.removed.push_back(std::move(*old_area));
+    }
+
+    _areas        = std::move(areas);
+    _last_changes = std::move(changes);
+
+    rebuildIndex();
+
+    if (_last_changes.empty())
+    {
+        return;
+    }
+
+    /* Subscribers are allowed to unsubscribe inside their callback */
+    const auto subscribers = _subscribers;
+
+    for (const auto& [subscriber_id, callback] : subscribers)
+    {
+        callback(*this, _last_changes);
+    }
+}
+
+auto ProcessMemoryMap::processBase() const -> const ProcessBase&
+{
+    return _process_base;
+}
+
+auto ProcessMemoryMap::areaTable() const -> const MemoryAreaTable&
+{
+    return _area_table;
+}
+
+auto ProcessMemoryMap::mergedAreas() const
+  -> const std::vector<SimplifiedArea>&
+{
+    return _merged_areas;
+}
+
+auto ProcessMemoryMap::searchIndex(const std::uintptr_t address) const
+  -> std::size_t
+{
+    return _area_table.search(address);
+}
+
+auto ProcessMemoryMap::searchMergedIndex(const std::uintptr_t address) const
+  -> std::size_t
+{
+    const auto it = std::upper_bound(
+      _merged_areas.begin(),
+      _merged_areas.end(),
+      address,
+      [](const std::uintptr_t value, const SimplifiedArea& merged_area)
+      {
+          return value < merged_area.begin;
+      });
+
+    if (it == _merged_areas.begin())
+    {
+        return INVALID_INDEX;
+    }
+
+    const auto merged_area_index = view_as<std::size_t>(
+      std::distance(_merged_areas.begin(), it) - 1);
+
+    if (address >= _merged_areas[merged_area_index].end)
+    {
+        return INVALID_INDEX;
+    }
+
+    return merged_area_index;
+}
+
+auto ProcessMemoryMap::rebuildIndex() -> void
+{
+    _area_table.clear();
+    _merged_areas.clear();
+
+    _area_table.reserve(_areas.size());
+
+    /**
+     * Thanks to the operating system, the areas are already in order,
+     * but better to be safe than sorry.
+     */
+    if (not std::is_sorted(
+          _areas.begin(),
+          _areas.end(),
+          [](const std::shared_ptr<ProcessMemoryArea>& area1,
+             const std::shared_ptr<ProcessMemoryArea>& area2)
+          {
+              return area1->begin() < area2->begin();
+          }))
+    {
+        std::sort(_areas.begin(),
+                  _areas.end(),
+                  [](const std::shared_ptr<ProcessMemoryArea>& area1,
+                     const std::shared_ptr<ProcessMemoryArea>& area2)
+                  {
+                      return area1->begin() < area2->begin();
+                  });
+    }
+
+    for (const auto& area : _areas)
+    {
+        _area_table.push(area->begin(),
+                         area->end(),
+                         area->protectionFlags().cachedValue(),
+                         area->name(),
+                         area->fileOffset(),
+                         area->inode());
+
+        /**
+         * If begin ptr is the same as the previous end then affect the
+         * new end ptr, else we got our newest non-merged area.
+         */
+        if (not _merged_areas.empty()
+            and _merged_areas.back().end == area->begin())
+        {
+            _merged_areas.back().end = area->end();
+        }
+        else
+        {
+            _merged_areas.push_back({ area->begin(), area->end() });
+        }
+    }
+
+    _area_table.compactNames();
 }
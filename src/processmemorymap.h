@@ -1,6 +1,7 @@
 #ifndef ASURA_PROCESSMEMORYMAP_H
 #define ASURA_PROCESSMEMORYMAP_H
 
+#include "memoryareatable.h"
 #include "memorymap.h"
 #include "memoryutils.h"
 #include "processbase.h"
@@ -12,12 +13,72 @@ namespace Asura
 
     class ProcessMemoryMap : public MemoryMap<ProcessMemoryArea>
     {
+      public:
+        /**
+         * Contiguous areas merged together, even if they're not the
+         * same memory protections.
+         */
+        struct SimplifiedArea
+        {
+            std::uintptr_t begin;
+            std::uintptr_t end;
+        };
+
+        /**
+         * What changed between two refreshes.
+         * Areas that are still mapped at the same address with the same
+         * name are kept as the same objects, so anyone holding them
+         * stays up to date.
+         */
+        struct ChangeSet
+        {
+            auto empty() const -> bool;
+
+            std::vector<std::shared_ptr<ProcessMemoryArea>> added;
+            std::vector<std::shared_ptr<ProcessMemoryArea>> removed;
+            /* split or merged by the OS */
+            std::vector<std::shared_ptr<ProcessMemoryArea>> resized;
+            std::vector<std::shared_ptr<ProcessMemoryArea>>
+              protection_changed;
+        };
+
+        using change_callback_t = std::function<
+          void(const ProcessMemoryMap&, const ChangeSet&)>;
+
+        static constexpr inline std::size_t INVALID_INDEX = MemoryAreaTable::
+          INVALID_INDEX;
+
+      private:
+        struct ParsedArea
+        {
+            std::uintptr_t begin;
+            std::uintptr_t end;
+            mapf_t flags;
+            std::string name;
+            std::uint64_t file_offset;
+            std::uint64_t inode;
+        };
+
       public:
         ProcessMemoryMap();
         explicit ProcessMemoryMap(ProcessBase process);
 
+      public:
+        auto processBase() const -> const ProcessBase&;
+        /* As of the last refresh, see MemoryAreaTable */
+        auto areaTable() const -> const MemoryAreaTable&;
+        auto mergedAreas() const -> const std::vector<SimplifiedArea>&;
+        auto searchIndex(const std::uintptr_t address) const
+          -> std::size_t;
+        auto searchMergedIndex(const std::uintptr_t address) const
+          -> std::size_t;
+
+        auto lastChanges() const -> const ChangeSet&;
+
       public:
         auto refresh() -> void;
+        auto subscribe(change_callback_t callback) -> std::size_t;
+        auto unsubscribe(const std::size_t subscriberID) -> void;
 
       public:
         auto read(const auto address, const std::size_t size) const
@@ -45,83 +106,35 @@ namespace Asura
             write<decltype(address)>(address, data);
         }
 
+        /* Every transfers at once, straight from where they are */
+        auto write(const MemoryUtils::transfers_t& transfers) const
+          -> void
+        {
+            MemoryUtils::WriteProcessMemoryAreas(_process_base.id(),
+                                                 transfers);
+        }
+
         auto searchNearestEmptyArea(const auto address) const
+          -> std::uintptr_t
         {
-            if (_areas.size() == 0)
+            if (_merged_areas.empty())
             {
-                return address;
+                return view_as<std::uintptr_t>(address);
             }
 
-            struct SimplifiedArea
-            {
-                std::uintptr_t begin;
-                std::uintptr_t end;
-            };
-
-            std::vector<SimplifiedArea> simplified_areas;
-
             /**
-             * Merge areas, even if they're not the same memory
-             * protections.
-             * Thanks to the operating system, the areas are already
-             * in order.
+             * Find the merged area that contains our address, if there's
+             * none we take the last one like before.
              */
-            std::size_t area_index = 0;
+            const auto merged_area_index = searchMergedIndex(
+              view_as<std::uintptr_t>(address));
 
-            while (area_index < _areas.size())
-            {
-                SimplifiedArea simplified_area;
-
-                const auto first_area = _areas[area_index];
-                const auto begin_ptr  = first_area->begin();
-                auto end_ptr          = first_area->end();
-
-                for (area_index = area_index + 1;
-                     area_index < _areas.size();
-                     area_index++)
-                {
-                    const auto next_area = _areas[area_index];
-
-                    /**
-                     * If begin ptr is the same as the previous end
-                     * then affect the new end ptr and go on the next
-                     * area
-                     */
-                    if (next_area->begin() == end_ptr)
-                    {
-                        end_ptr = next_area->end();
-                    }
-                    /**
-                     * Else we break and find our newest non-merged
-                     * area
-                     */
-                    else
-                    {
-                        break;
-                    }
-                }
-
-                simplified_area.begin = begin_ptr;
-                simplified_area.end   = end_ptr;
-                simplified_areas.push_back(simplified_area);
-            }
+            const auto& merged_area = (merged_area_index == INVALID_INDEX) ?
+                                        _merged_areas.back() :
+                                        _merged_areas[merged_area_index];
 
-            /**
-             * Now find the closest area we can get
-             */
-            std::uintptr_t start_ptr, end_ptr;
-
-            for (const auto& simplified_area : simplified_areas)
-            {
-                start_ptr = simplified_area.begin;
-                end_ptr   = simplified_area.end;
-
-                if (view_as<std::uintptr_t>(address) >= start_ptr
-                    and view_as<std::uintptr_t>(address) < end_ptr)
-                {
-                    break;
-                }
-            }
+            const auto start_ptr = merged_area.begin;
+            const auto end_ptr   = merged_area.end;
 
             const auto relative_address = view_as<std::uintptr_t>(address)
                                           - start_ptr;
@@ -145,19 +158,15 @@ namespace Asura
         auto search(const auto address) const
           -> std::shared_ptr<ProcessMemoryArea>
         {
-            for (const auto& area : _areas)
+            const auto area_index = searchIndex(
+              view_as<std::uintptr_t>(address));
+
+            if (area_index == INVALID_INDEX)
             {
-                const auto start_ptr = area->begin();
-                const auto end_ptr   = area->end();
-
-                if (view_as<std::uintptr_t>(address) >= start_ptr
-                    and view_as<std::uintptr_t>(address) < end_ptr)
-                {
-                    return area;
-                }
+                return nullptr;
             }
 
-            return nullptr;
+            return _areas[area_index];
         }
 
       public:
@@ -225,8 +234,25 @@ namespace Asura
             forceWrite(address, data);
         }
 
+      private:
+        auto parse() const -> std::vector<ParsedArea>;
+        auto update(std::vector<ParsedArea>& parsedAreas) -> void;
+        auto rebuildIndex() -> void;
+
       private:
         ProcessBase _process_base;
+
+        /**
+         * Flat copy of the areas, sorted by address so we can binary
+         * search them instead of walking every areas.
+         * They're only rebuilt when the map changes (refresh).
+         */
+        MemoryAreaTable _area_table;
+        std::vector<SimplifiedArea> _merged_areas;
+
+        ChangeSet _last_changes;
+        std::map<std::size_t, change_callback_t> _subscribers;
+        std::size_t _next_subscriber_id {};
     };
 }
 
@@ -0,0 +1,880 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "remotesymbolresolver.h"
+
+using namespace Asura;
+
+RemoteSymbolResolver::RemoteSymbolResolver(const process_id_t pid)
+ : _pid(pid)
+{
+}
+
+auto RemoteSymbolResolver::resolve(const ModuleIndex::Module& module,
+                                   const std::vector<std::string>& names)
+  -> std::vector<Resolved>
+{
+    /* Forwarded exports stay unresolved without the other modules */
+    std::vector<Forward> forwards;
+
+    return resolveModule(module, names, forwards);
+}
+
+auto RemoteSymbolResolver::resolve(const ModuleIndex& moduleIndex,
+                                   const std::string_view moduleName,
+                                   const std::vector<std::string>& names)
+  -> std::vector<Resolved>
+{
+    const auto module_id = moduleIndex.find(moduleName);
+
+    if (module_id == ModuleIndex::INVALID_ID)
+    {
+        return std::vector<Resolved>(names.size(),
+                                     { 0, SymbolTable::Type::Other });
+    }
+
+    std::vector<Forward> forwards;
+
+    auto resolved = resolveModule(moduleIndex.module(module_id),
+                                   names,
+                                   forwards);
+
+    for (std::size_t depth = 0;
+         depth < MAX_FORWARDS and not forwards.empty();
+         depth++)
+    {
+        /**
+         * dll.function, grouped by module so each one is only read
+         * once.
+         */
+        std::map<std::string, std::vector<Forward>> forwards_by_module;
+
+        for (auto&& forward : forwards)
+        {
+            const auto dot_pos = forward.forwarded_name.find('.');
+
+            if (dot_pos == std::string::npos)
+            {
+                continue;
+            }
+
+            auto module_name = forward.forwarded_name.substr(0, dot_pos);
+
+            std::transform(module_name.begin(),
+                           module_name.end(),
+                           module_name.begin(),
+                           [](const unsigned char c)
+                           {
+                               return std::tolower(c);
+                           });
+
+            auto func_name = forward.forwarded_name.substr(dot_pos + 1);
+
+            /* By ordinal */
+            if (func_name.starts_with('#'))
+            {
+                func_name.erase(0, 1);
+            }
+
+            forwards_by_module[module_name + ".dll"].push_back(
+              { .name_index     = forward.name_index,
+                .forwarded_name = std::move(func_name) });
+        }
+
+        std::vector<Forward> next_forwards;
+
+        for (auto&& [module_name, module_forwards] : forwards_by_module)
+        {
+            const auto forwarded_module_id = moduleIndex.find(
+              module_name);
+
+            if (forwarded_module_id == ModuleIndex::INVALID_ID)
+            {
+                continue;
+            }
+
+            std::vector<std::string> func_names;
+
+            for (auto&& forward : module_forwards)
+            {
+                func_names.push_back(forward.forwarded_name);
+            }
+
+            std::vector<Forward> module_next_forwards;
+
+            const auto forwarded_resolved = resolveModule(
+              moduleIndex.module(forwarded_module_id),
+              func_names,
+              module_next_forwards);
+
+            for (std::size_t i = 0; i < module_forwards.size(); i++)
+            {
+                const auto name_index = module_forwards[i].name_index;
+
+                resolved[name_index] = forwarded_resolved[i];
+            }
+
+            for (auto&& forward : module_next_forwards)
+            {
+                next_forwards.push_back(
+                  { .name_index = module_forwards[forward.name_index]
+                                    .name_index,
+                    .forwarded_name = std::move(forward.forwarded_name) });
+            }
+        }
+
+        forwards = std::move(next_forwards);
+    }
+
+    return resolved;
+}
+
+auto RemoteSymbolResolver::readBatches() const -> std::size_t
+{
+    return _read_batches;
+}
+
+auto RemoteSymbolResolver::read(MemoryUtils::transfers_t& transfers)
+  -> void
+{
+    if (transfers.empty())
+    {
+        return;
+    }
+
+    MemoryUtils::ReadProcessMemoryAreas(_pid, transfers);
+    _read_batches++;
+
+    transfers.clear();
+}
+
+auto RemoteSymbolResolver::resolveModule(
+  const ModuleIndex::Module& module,
+  const std::vector<std::string>& names,
+  std::vector<Forward>& forwards) -> std::vector<Resolved>
+{
+    std::vector<Resolved> resolved(names.size(),
+                                   { 0, SymbolTable::Type::Other });
+
+    if (names.empty())
+    {
+        return resolved;
+    }
+
+    /* Both the ELF header and the DOS header fit in there */
+    alignas(std::uint64_t)
+      std::array<byte_t, sizeof(ELF::Elf_Ehdr<std::uint64_t>)>
+        header;
+
+    MemoryUtils::transfers_t transfers;
+
+    transfers.push_back({ .local  = header.data(),
+                          .remote = module.begin,
+                          .size   = header.size() });
+    read(transfers);
+
+    if (std::memcmp(header.data(),
+                    &ELF::MAGIC_NUMBER,
+                    sizeof(ELF::MAGIC_NUMBER))
+        == 0)
+    {
+        const auto elf_parent_header = view_as<
+          const ELF::Elf_Parent_Ehdr*>(header.data());
+
+        switch (elf_parent_header->e_ident[ELF::EI_CLASS])
+        {
+            case ELF::ELFCLASS32:
+            {
+                resolveELF(module,
+                           *view_as<const ELF::Elf_Ehdr<std::uint32_t>*>(
+                             header.data()),
+                           names,
+                           resolved);
+                break;
+            }
+
+            case ELF::ELFCLASS64:
+            {
+                resolveELF(module,
+                           *view_as<const ELF::Elf_Ehdr<std::uint64_t>*>(
+                             header.data()),
+                           names,
+                           resolved);
+                break;
+            }
+
+            default:
+            {
+                ASURA_EXCEPTION(
+                  "Unknown ELF Class: "
+                  + std::to_string(
+                    elf_parent_header->e_ident[ELF::EI_CLASS]));
+            }
+        }
+    }
+    /* Wine compability */
+    else if (std::memcmp(header.data(),
+                         &PE::MAGIC_NUMBER,
+                         sizeof(PE::MAGIC_NUMBER))
+             == 0)
+    {
+        const auto dos_header = view_as<const PE::IMAGE::DOS_HEADER*>(
+          header.data());
+
+        alignas(std::uint64_t)
+          std::array<byte_t, sizeof(PE::IMAGE::NT_HEADERS<std::uint64_t>)>
+            nt_headers;
+
+        transfers.push_back({ .local  = nt_headers.data(),
+                              .remote = module.begin
+                                        + dos_header->e_lfanew,
+                              .size   = nt_headers.size() });
+        read(transfers);
+
+        const auto nt_parent_headers = view_as<
+          const PE::IMAGE::PARENT_NT_HEADERS*>(nt_headers.data());
+
+        switch (nt_parent_headers->FileHeader.Machine)
+        {
+            case PE::IMAGE::FILE_MACHINE_I386:
+            {
+                resolvePE(module,
+                          *view_as<const PE::IMAGE::NT_HEADERS<
+                            std::uint32_t>*>(nt_parent_headers),
+                          names,
+                          resolved,
+                          forwards);
+                break;
+            }
+
+            case PE::IMAGE::FILE_MACHINE_IA64:
+            case PE::IMAGE::FILE_MACHINE_AMD64:
+            {
+                resolvePE(module,
+                          *view_as<const PE::IMAGE::NT_HEADERS<
+                            std::uint64_t>*>(nt_parent_headers),
+                          names,
+                          resolved,
+                          forwards);
+                break;
+            }
+
+            default:
+            {
+                ASURA_EXCEPTION(
+                  "Unknown PE Machine: "
+                  + std::to_string(
+                    nt_parent_headers->FileHeader.Machine));
+            }
+        }
+    }
+    else
+    {
+        ASURA_EXCEPTION("Could not find any compatible file format for "
+                        + module.path);
+    }
+
+    return resolved;
+}
+
+template <ELF::IntType T>
+auto RemoteSymbolResolver::resolveELF(
+  const ModuleIndex::Module& module,
+  const ELF::Elf_Ehdr<T>& elfHeader,
+  const std::vector<std::string>& names,
+  std::vector<Resolved>& resolved) -> void
+{
+    MemoryUtils::transfers_t transfers;
+
+    std::vector<ELF::Elf_Phdr<T>> program_headers(elfHeader.e_phnum);
+
+    transfers.push_back(
+      { .local  = program_headers.data(),
+        .remote = module.begin + elfHeader.e_phoff,
+        .size   = program_headers.size() * sizeof(ELF::Elf_Phdr<T>) });
+    read(transfers);
+
+    auto load_address = std::numeric_limits<std::uintptr_t>::max();
+    const ELF::Elf_Phdr<T>* dynamic_header = nullptr;
+
+    for (const auto& program_header : program_headers)
+    {
+        if (program_header.p_type == ELF::PT_LOAD)
+        {
+            load_address = std::min(
+              load_address,
+              view_as<std::uintptr_t>(program_header.p_vaddr));
+        }
+        else if (program_header.p_type == ELF::PT_DYNAMIC)
+        {
+            dynamic_header = &program_header;
+        }
+    }
+
+    if (not dynamic_header
+        or load_address == std::numeric_limits<std::uintptr_t>::max())
+    {
+        return;
+    }
+
+    const auto load_bias = module.begin
+                           - MemoryUtils::Align(
+                             load_address,
+                             MemoryUtils::GetPageSize());
+
+    std::vector<ELF::Elf_Dyn<T>> dynamic_entries(
+      dynamic_header->p_memsz / sizeof(ELF::Elf_Dyn<T>));
+
+    transfers.push_back(
+      { .local  = dynamic_entries.data(),
+        .remote = load_bias + dynamic_header->p_vaddr,
+        .size   = dynamic_entries.size() * sizeof(ELF::Elf_Dyn<T>) });
+    read(transfers);
+
+    std::uintptr_t symbol_table = 0, string_table = 0, gnu_hash = 0,
+                   sysv_hash = 0, versions = 0;
+    std::size_t string_table_size = 0;
+
+    /* The dynamic linker may have relocated them, or not */
+    const auto dyn_address = [&](const ELF::Elf_Dyn<T>& dyn)
+    {
+        const auto address = view_as<std::uintptr_t>(dyn.d_un.d_ptr);
+
+        return address < module.begin ? address + load_bias : address;
+    };
+
+    for (const auto& dyn : dynamic_entries)
+    {
+        if (dyn.d_tag == ELF::DT_NULL)
+        {
+            break;
+        }
+
+        switch (dyn.d_tag)
+        {
+            case ELF::DT_SYMTAB:
+            {
+                symbol_table = dyn_address(dyn);
+                break;
+            }
+            case ELF::DT_STRTAB:
+            {
+                string_table = dyn_address(dyn);
+                break;
+            }
+            case ELF::DT_STRSZ:
+            {
+                string_table_size = dyn.d_un.d_val;
+                break;
+            }
+            case ELF::DT_GNU_HASH:
+            {
+                gnu_hash = dyn_address(dyn);
+                break;
+            }
+            case ELF::DT_HASH:
+            {
+                sysv_hash = dyn_address(dyn);
+                break;
+            }
+            case ELF::DT_VERSYM:
+            {
+                versions = dyn_address(dyn);
+                break;
+            }
+        }
+    }
+
+    if (not symbol_table or not string_table)
+    {
+        ASURA_EXCEPTION("Couldn't find the dynamic symbols of "
+                        + module.path);
+    }
+
+    struct Candidate
+    {
+        std::size_t name_index;
+        std::uint32_t symbol_index;
+    };
+
+    /**
+     * Symbols the hash table led to, read with their versions, then
+     * the names of the defined ones, in two batches for all of them.
+     */
+    const auto match_candidates =
+      [&](const std::vector<Candidate>& candidates)
+    {
+        std::vector<ELF::Elf_Sym<T>> symbols(candidates.size());
+        std::vector<std::uint16_t> symbol_versions(candidates.size(), 0);
+
+        for (std::size_t i = 0; i < candidates.size(); i++)
+        {
+            transfers.push_back(
+              { .local  = &symbols[i],
+                .remote = symbol_table
+                          + candidates[i].symbol_index
+                              * sizeof(ELF::Elf_Sym<T>),
+                .size   = sizeof(ELF::Elf_Sym<T>) });
+
+            if (versions)
+            {
+                transfers.push_back(
+                  { .local  = &symbol_versions[i],
+                    .remote = versions
+                              + candidates[i].symbol_index
+                                  * sizeof(std::uint16_t),
+                    .size   = sizeof(std::uint16_t) });
+            }
+        }
+
+        read(transfers);
+
+        std::vector<std::string> symbol_names(candidates.size());
+
+        for (std::size_t i = 0; i < candidates.size(); i++)
+        {
+            const auto& symbol = symbols[i];
+
+            if (symbol.st_shndx == ELF::SHN_UNDEF
+                or (symbol_versions[i] & ELF::VERSYM_HIDDEN))
+            {
+                continue;
+            }
+
+            /* The terminator tells a longer name apart */
+            auto length = names[candidates[i].name_index].size() + 1;
+
+            if (string_table_size)
+            {
+                if (symbol.st_name >= string_table_size)
+                {
+                    continue;
+                }
+
+                length = std::min<std::size_t>(length,
+                                               string_table_size
+                                                 - symbol.st_name);
+            }
+
+            symbol_names[i].resize(length);
+
+            transfers.push_back({ .local  = symbol_names[i].data(),
+                                  .remote = string_table
+                                            + symbol.st_name,
+                                  .size   = length });
+        }
+
+        read(transfers);
+
+        for (std::size_t i = 0; i < candidates.size(); i++)
+        {
+            const auto& name = names[candidates[i].name_index];
+            const auto& symbol_name = symbol_names[i];
+            const auto type = SymbolTable::TypeFromELF(
+              symbols[i].st_info);
+
+            if (resolved[candidates[i].name_index].address == 0 and type
+                and symbol_name.size() == name.size() + 1
+                and symbol_name.back() == '\0'
+                and symbol_name.compare(0, name.size(), name) == 0)
+            {
+                resolved[candidates[i].name_index] = {
+                    .address = load_bias + symbols[i].st_value,
+                    .type    = *type
+                };
+            }
+        }
+    };
+
+    if (gnu_hash)
+    {
+        std::array<std::uint32_t, 4> gnu_hash_header;
+
+        transfers.push_back({ .local  = gnu_hash_header.data(),
+                              .remote = gnu_hash,
+                              .size   = sizeof(gnu_hash_header) });
+        read(transfers);
+
+        const auto bucket_count = gnu_hash_header[0];
+        const auto symbol_start = gnu_hash_header[1];
+        const auto bloom_size   = gnu_hash_header[2];
+        const auto bloom_shift  = gnu_hash_header[3];
+
+        if (bucket_count == 0 or bloom_size == 0)
+        {
+            return;
+        }
+
+        std::vector<T> bloom(bloom_size);
+        std::vector<std::uint32_t> buckets(bucket_count);
+
+        const auto bloom_address = gnu_hash + sizeof(gnu_hash_header);
+        const auto buckets_address = bloom_address
+                                     + bloom.size() * sizeof(T);
+        const auto chains_address = buckets_address
+                                    + buckets.size()
+                                        * sizeof(std::uint32_t);
+
+        transfers.push_back({ .local  = bloom.data(),
+                              .remote = bloom_address,
+                              .size   = bloom.size() * sizeof(T) });
+        transfers.push_back(
+          { .local  = buckets.data(),
+            .remote = buckets_address,
+            .size   = buckets.size() * sizeof(std::uint32_t) });
+        read(transfers);
+
+        constexpr auto bloom_bits = sizeof(T) * CHAR_BIT;
+
+        std::vector<std::uint32_t> hashes(names.size());
+        /* Next symbol of the chain, 0 once there's nothing left */
+        std::vector<std::uint32_t> symbol_indexes(names.size(), 0);
+
+        for (std::size_t i = 0; i < names.size(); i++)
+        {
+            const auto hash = ELF::GNUHash(names[i]);
+
+            const auto bloom_word = bloom[(hash / bloom_bits)
+                                          & (bloom_size - 1)];
+            const T bloom_mask    = (T(1) << (hash % bloom_bits))
+                                 | (T(1)
+                                    << ((hash >> bloom_shift) % bloom_bits));
+
+            if ((bloom_word & bloom_mask) != bloom_mask)
+            {
+                continue;
+            }
+
+            const auto symbol_index = buckets[hash % bucket_count];
+
+            if (symbol_index >= symbol_start)
+            {
+                hashes[i]         = hash;
+                symbol_indexes[i] = symbol_index;
+            }
+        }
+
+        std::vector<std::array<std::uint32_t, CHAIN_READ_COUNT>> chains(
+          names.size());
+
+        while (true)
+        {
+            for (std::size_t i = 0; i < names.size(); i++)
+            {
+                if (symbol_indexes[i])
+                {
+                    transfers.push_back(
+                      { .local  = chains[i].data(),
+                        .remote = chains_address
+                                  + (symbol_indexes[i] - symbol_start)
+                                      * sizeof(std::uint32_t),
+                        .size   = sizeof(chains[i]) });
+                }
+            }
+
+            if (transfers.empty())
+            {
+                break;
+            }
+
+            read(transfers);
+
+            std::vector<Candidate> candidates;
+
+            for (std::size_t i = 0; i < names.size(); i++)
+            {
+                if (not symbol_indexes[i])
+                {
+                    continue;
+                }
+
+                auto chain_ended = false;
+
+                for (std::size_t j = 0; j < CHAIN_READ_COUNT; j++)
+                {
+                    const auto chain_hash = chains[i][j];
+
+                    if ((chain_hash | 1) == (hashes[i] | 1))
+                    {
+                        candidates.push_back(
+                          { .name_index   = i,
+                            .symbol_index = view_as<std::uint32_t>(
+                              symbol_indexes[i] + j) });
+                    }
+
+                    /* The lowest bit marks the end of the chain */
+                    if (chain_hash & 1)
+                    {
+                        chain_ended = true;
+                        break;
+                    }
+                }
+
+                symbol_indexes[i] = chain_ended ?
+                                      0 :
+                                      view_as<std::uint32_t>(
+                                        symbol_indexes[i]
+                                        + CHAIN_READ_COUNT);
+            }
+
+            match_candidates(candidates);
+
+            for (std::size_t i = 0; i < names.size(); i++)
+            {
+                if (resolved[i].address)
+                {
+                    symbol_indexes[i] = 0;
+                }
+            }
+        }
+    }
+    else if (sysv_hash)
+    {
+        std::array<std::uint32_t, 2> sysv_hash_header;
+
+        transfers.push_back({ .local  = sysv_hash_header.data(),
+                              .remote = sysv_hash,
+                              .size   = sizeof(sysv_hash_header) });
+        read(transfers);
+
+        const auto bucket_count = sysv_hash_header[0];
+        const auto chain_count  = sysv_hash_header[1];
+
+        if (bucket_count == 0)
+        {
+            return;
+        }
+
+        /* Buckets then chains */
+        std::vector<std::uint32_t> table(bucket_count + chain_count);
+
+        transfers.push_back(
+          { .local  = table.data(),
+            .remote = sysv_hash + sizeof(sysv_hash_header),
+            .size   = table.size() * sizeof(std::uint32_t) });
+        read(transfers);
+
+        const auto chains = table.data() + bucket_count;
+
+        std::vector<std::uint32_t> symbol_indexes(names.size());
+
+        for (std::size_t i = 0; i < names.size(); i++)
+        {
+            symbol_indexes[i] = table[ELF::SysVHash(names[i])
+                                      % bucket_count];
+        }
+
+        /* One step of every chain at a time */
+        while (true)
+        {
+            std::vector<Candidate> candidates;
+
+            for (std::size_t i = 0; i < names.size(); i++)
+            {
+                if (symbol_indexes[i] and symbol_indexes[i] < chain_count)
+                {
+                    candidates.push_back(
+                      { .name_index   = i,
+                        .symbol_index = symbol_indexes[i] });
+                }
+            }
+
+            if (candidates.empty())
+            {
+                break;
+            }
+
+            match_candidates(candidates);
+
+            for (const auto& candidate : candidates)
+            {
+                auto& symbol_index = symbol_indexes[candidate.name_index];
+
+                symbol_index = resolved[candidate.name_index].address ?
+                                 0 :
+                                 chains[candidate.symbol_index];
+            }
+        }
+    }
+    else
+    {
+        /**
+         * HACK:
+         * Usually symbol table is just before string table, so that ease
+         * our stuff.
+         */
+        if (string_table <= symbol_table or not string_table_size)
+        {
+            ASURA_EXCEPTION("Couldn't find the symbol count of "
+                            + module.path);
+        }
+
+        std::vector<ELF::Elf_Sym<T>> symbols(
+          (string_table - symbol_table) / sizeof(ELF::Elf_Sym<T>));
+        std::string strings(string_table_size, '\0');
+
+        transfers.push_back(
+          { .local  = symbols.data(),
+            .remote = symbol_table,
+            .size   = symbols.size() * sizeof(ELF::Elf_Sym<T>) });
+        transfers.push_back({ .local  = strings.data(),
+                              .remote = string_table,
+                              .size   = strings.size() });
+        read(transfers);
+
+        for (std::size_t i = 0; i < names.size(); i++)
+        {
+            for (const auto& symbol : symbols)
+            {
+                const auto type = SymbolTable::TypeFromELF(
+                  symbol.st_info);
+
+                if (symbol.st_shndx != ELF::SHN_UNDEF and type
+                    and symbol.st_name < strings.size()
+                    and names[i] == strings.c_str() + symbol.st_name)
+                {
+                    resolved[i] = { .address = load_bias + symbol.st_value,
+                                    .type    = *type };
+                    break;
+                }
+            }
+        }
+    }
+}
+
+template <PE::IMAGE::IntType T>
+auto RemoteSymbolResolver::resolvePE(
+  const ModuleIndex::Module& module,
+  const PE::IMAGE::NT_HEADERS<T>& ntHeaders,
+  const std::vector<std::string>& names,
+  std::vector<Resolved>& resolved,
+  std::vector<Forward>& forwards) -> void
+{
+    const auto& exp_dir_entry = ntHeaders.OptionalHeader.DataDirectory
+                                  [PE::IMAGE::DIRECTORY_ENTRY_EXPORT];
+
+    const auto entry_rva  = exp_dir_entry.VirtualAddress;
+    const auto entry_size = exp_dir_entry.Size;
+
+    /* No exports */
+    if (not entry_rva or entry_size < sizeof(PE::IMAGE::EXPORT_DIRECTORY))
+    {
+        return;
+    }
+
+    /**
+     * The directory, its tables and the names all live in there, read
+     * at once.
+     */
+    bytes_t export_data(entry_size);
+
+    MemoryUtils::transfers_t transfers;
+
+    transfers.push_back({ .local  = export_data.data(),
+                          .remote = module.begin + entry_rva,
+                          .size   = export_data.size() });
+    read(transfers);
+
+    const auto at = [&](const std::uint32_t rva, const std::size_t size)
+    {
+        if (rva < entry_rva or rva - entry_rva > entry_size
+            or size > entry_size - (rva - entry_rva))
+        {
+            ASURA_EXCEPTION("Exports outside of the export directory "
+                            "of "
+                            + module.path);
+        }
+
+        return export_data.data() + (rva - entry_rva);
+    };
+
+    const auto string_at = [&](const std::uint32_t rva)
+    {
+        const auto string = view_as<const char*>(at(rva, 0));
+
+        return std::string_view(string,
+                                strnlen(string,
+                                        entry_size - (rva - entry_rva)));
+    };
+
+    const auto export_directory = view_as<
+      const PE::IMAGE::EXPORT_DIRECTORY*>(at(entry_rva,
+                                             sizeof(
+                                               PE::IMAGE::EXPORT_DIRECTORY)));
+
+    const auto funcs = view_as<const std::uint32_t*>(
+      at(export_directory->AddressOfFunctions,
+         export_directory->NumberOfFunctions * sizeof(std::uint32_t)));
+
+    const auto func_names = view_as<const std::uint32_t*>(
+      at(export_directory->AddressOfNames,
+         export_directory->NumberOfNames * sizeof(std::uint32_t)));
+
+    const auto ordinals = view_as<const std::uint16_t*>(
+      at(export_directory->AddressOfNameOrdinals,
+         export_directory->NumberOfNames * sizeof(std::uint16_t)));
+
+    const auto func_names_end = func_names
+                                + export_directory->NumberOfNames;
+
+    for (std::size_t i = 0; i < names.size(); i++)
+    {
+        const auto& name = names[i];
+        std::size_t func_index;
+
+        if (not name.empty()
+            and std::all_of(name.begin(),
+                            name.end(),
+                            [](const std::uint8_t& c)
+                            {
+                                return std::isdigit(c);
+                            }))
+        {
+            func_index = std::stoul(name) - export_directory->Base;
+        }
+        else
+        {
+            /* The linker sorts the names */
+            const auto found = std::lower_bound(
+              func_names,
+              func_names_end,
+              name,
+              [&](const std::uint32_t name_rva, const std::string& value)
+              {
+                  return string_at(name_rva) < value;
+              });
+
+            if (found == func_names_end or string_at(*found) != name)
+            {
+                continue;
+            }
+
+            func_index = ordinals[found - func_names];
+        }
+
+        if (func_index >= export_directory->NumberOfFunctions)
+        {
+            continue;
+        }
+
+        const auto func_rva = funcs[func_index];
+
+        if (not func_rva)
+        {
+            continue;
+        }
+
+        /* is it forwarded ? */
+        if (func_rva >= entry_rva and func_rva < entry_rva + entry_size)
+        {
+            forwards.push_back(
+              { .name_index     = i,
+                .forwarded_name = std::string(string_at(func_rva)) });
+        }
+        else
+        {
+            resolved[i] = { .address = module.begin + func_rva,
+                            .type    = SymbolTable::Type::Function };
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef ASURA_REMOTESYMBOLRESOLVER_H
+#define ASURA_REMOTESYMBOLRESOLVER_H
+
+#include "elf.h"
+#include "memoryutils.h"
+#include "moduleindex.h"
+#include "pe.h"
+#include "symboltable.h"
+
+namespace Asura
+{
+    /**
+     * Resolves exported symbols of modules inside another process from
+     * its memory, without reading whole modules: for ELF, the header,
+     * program headers, dynamic section, hash table, then only the
+     * symbols and names the hash table leads to; for PE (Wine), the
+     * headers and the export directory.
+     * Reads needed by all the names are batched together, a batch of
+     * names costs about the same handful of process_vm_readv calls as
+     * a single name.
+     */
+    class RemoteSymbolResolver
+    {
+      public:
+        /* Entries of a GNU hash chain read at once for each name */
+        static constexpr inline std::size_t CHAIN_READ_COUNT = 8;
+        /* How far forwarded exports are followed */
+        static constexpr inline std::size_t MAX_FORWARDS = 4;
+
+        struct Resolved
+        {
+            /* 0 when not found */
+            std::uintptr_t address;
+            /**
+             * The address of an IndirectFunction is the one of its
+             * resolver, it has to be called inside the process to know
+             * the function. PE exports are all Function.
+             */
+            SymbolTable::Type type;
+        };
+
+      public:
+        explicit RemoteSymbolResolver(const process_id_t pid);
+
+      public:
+        auto resolve(const ModuleIndex::Module& module,
+                     const std::vector<std::string>& names)
+          -> std::vector<Resolved>;
+
+        /* Follows forwarded exports to the other modules */
+        auto resolve(const ModuleIndex& moduleIndex,
+                     const std::string_view moduleName,
+                     const std::vector<std::string>& names)
+          -> std::vector<Resolved>;
+
+        /* Batches of reads done so far */
+        auto readBatches() const -> std::size_t;
+
+      private:
+        struct Forward
+        {
+            std::size_t name_index;
+            std::string forwarded_name;
+        };
+
+        auto read(MemoryUtils::transfers_t& transfers) -> void;
+
+        template <ELF::IntType T>
+        auto resolveELF(const ModuleIndex::Module& module,
+                        const ELF::Elf_Ehdr<T>& elfHeader,
+                        const std::vector<std::string>& names,
+                        std::vector<Resolved>& resolved) -> void;
+
+        template <PE::IMAGE::IntType T>
+        auto resolvePE(const ModuleIndex::Module& module,
+                       const PE::IMAGE::NT_HEADERS<T>& ntHeaders,
+                       const std::vector<std::string>& names,
+                       std::vector<Resolved>& resolved,
+                       std::vector<Forward>& forwards) -> void;
+
+        auto resolveModule(const ModuleIndex::Module& module,
+                           const std::vector<std::string>& names,
+                           std::vector<Forward>& forwards)
+          -> std::vector<Resolved>;
+
+      private:
+        process_id_t _pid;
+        std::size_t _read_batches {};
+    };
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef ASURA_SHAREDCIRCULARBUFFER_H
+#define ASURA_SHAREDCIRCULARBUFFER_H
+
+#include "types.h"
+
+namespace Asura
+{
+    /**
+     * Same idea as CircularBuffer, but meant to live inside memory
+     * shared between processes (see SharedRegion): once filled, a push
+     * overwrites the oldest element.
+     * One producer, any number of readers, nobody ever waits.
+     * Each slot is guarded by a sequence number, so a reader racing
+     * with the producer overwriting the slot notices it instead of
+     * reading a torn element.
+     * Zeroed memory is a valid empty buffer.
+     */
+    template <typename T, std::size_t N>
+    class SharedCircularBuffer
+    {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "T is copied by bytes across processes");
+        static_assert(N > 0);
+
+        static constexpr inline std::size_t CACHE_LINE_SIZE = 64;
+
+        struct Slot
+        {
+            /* 2 * index + 1 while written, 2 * index + 2 once written */
+            alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> sequence;
+            T element;
+        };
+
+      public:
+        enum PushType
+        {
+            Filling,
+            Updating
+        };
+
+      public:
+        /* Elements pushed since the beginning */
+        auto pushed() const -> std::uint64_t;
+
+        /* 0 is the latest element, like CircularBuffer::get */
+        auto get(const std::size_t wantedSlot, T& element) const -> bool;
+
+        /* Element by the index it was pushed at */
+        auto getAt(const std::uint64_t index, T& element) const -> bool;
+
+        /**
+         * Reads the element at cursor and advances it, elements already
+         * overwritten are skipped.
+         * Returns false when there's nothing new.
+         */
+        auto read(std::uint64_t& cursor, T& element) const -> bool;
+
+      public:
+        auto push(const T& element) -> PushType;
+
+      private:
+        alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> _pushed;
+        std::array<Slot, N> _slots;
+    };
+
+    template <typename T, std::size_t N>
+    auto SharedCircularBuffer<T, N>::pushed() const -> std::uint64_t
+    {
+        return _pushed.load(std::memory_order_acquire);
+    }
+
+    template <typename T, std::size_t N>
+    auto SharedCircularBuffer<T, N>::get(const std::size_t wantedSlot,
+                                         T& element) const -> bool
+    {
+        const auto pushed_count = pushed();
+
+        if (wantedSlot >= std::min<std::uint64_t>(pushed_count, N))
+        {
+            return false;
+        }
+
+        return getAt(pushed_count - 1 - wantedSlot, element);
+    }
+
+    template <typename T, std::size_t N>
+    auto SharedCircularBuffer<T, N>::getAt(const std::uint64_t index,
+                                           T& element) const -> bool
+    {
+        if (index >= pushed())
+        {
+            return false;
+        }
+
+        const auto& slot    = _slots[index % N];
+        const auto expected = 2 * index + 2;
+
+        if (slot.sequence.load(std::memory_order_acquire) != expected)
+        {
+            return false;
+        }
+
+        std::memcpy(&element, &slot.element, sizeof(T));
+
+        /* The copy must be done before checking it wasn't overwritten */
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return slot.sequence.load(std::memory_order_relaxed) == expected;
+    }
+
+    template <typename T, std::size_t N>
+    auto SharedCircularBuffer<T, N>::read(std::uint64_t& cursor,
+                                          T& element) const -> bool
+    {
+        while (true)
+        {
+            const auto pushed_count = pushed();
+
+            if (cursor >= pushed_count)
+            {
+                return false;
+            }
+
+            if (pushed_count - cursor > N)
+            {
+                cursor = pushed_count - N;
+            }
+
+            /* Can only fail when overwritten meanwhile */
+            if (getAt(cursor++, element))
+            {
+                return true;
+            }
+        }
+    }
+
+    template <typename T, std::size_t N>
+    auto SharedCircularBuffer<T, N>::push(const T& element) -> PushType
+    {
+        const auto index = _pushed.load(std::memory_order_relaxed);
+        auto& slot       = _slots[index % N];
+
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+
+        /* Readers must see the slot as being written before the copy */
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&slot.element, &element, sizeof(T));
+
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        _pushed.store(index + 1, std::memory_order_release);
+
+        return index >= N ? Updating : Filling;
+    }
+}
+
+#endif
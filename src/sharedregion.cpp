@@ -0,0 +1,193 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "sharedregion.h"
+
+using namespace Asura;
+
+SharedRegion::SharedRegion(const std::size_t size)
+ : _size(MemoryUtils::AlignToPageSize(size, MemoryUtils::GetPageSize()))
+{
+#ifndef WINDOWS
+    _fd = memfd_create("asura_shared", MFD_CLOEXEC);
+
+    if (_fd < 0)
+    {
+        ASURA_EXCEPTION("memfd_create failed with: "
+                        + std::to_string(errno));
+    }
+
+    if (ftruncate(_fd, view_as<off_t>(_size)) < 0)
+    {
+        release();
+        ASURA_EXCEPTION("ftruncate failed with size: "
+                        + std::to_string(_size));
+    }
+
+    const auto data = mmap(nullptr,
+                           _size,
+                           PROT_READ | PROT_WRITE,
+                           MAP_SHARED,
+                           _fd,
+                           0);
+
+    if (data == MAP_FAILED)
+    {
+        release();
+        ASURA_EXCEPTION("mmap failed with size: " + std::to_string(_size));
+    }
+
+    _data = view_as<byte_t*>(data);
+#else
+    ASURA_EXCEPTION("Shared regions aren't supported on this platform");
+#endif
+}
+
+SharedRegion::~SharedRegion()
+{
+    release();
+}
+
+auto SharedRegion::data() const -> byte_t*
+{
+    return _data;
+}
+
+auto SharedRegion::size() const -> std::size_t
+{
+    return _size;
+}
+
+auto SharedRegion::fd() const -> int
+{
+    return _fd;
+}
+
+auto SharedRegion::remoteAddress() const -> std::uintptr_t
+{
+    return _remote_address;
+}
+
+auto SharedRegion::mapInto(Agent& agent,
+                           const ProcessBase& process,
+                           const mapf_t flags) -> std::uintptr_t
+{
+#ifndef WINDOWS
+    if (_remote_address != UNMAPPED)
+    {
+        ASURA_EXCEPTION("Region is already mapped in the target");
+    }
+
+    const auto page_size = MemoryUtils::GetPageSize();
+
+    /* Our memfd, as seen from the target */
+    const auto path = "/proc/" + std::to_string(getpid()) + "/fd/"
+                      + std::to_string(_fd);
+
+    const auto path_address = agent.result(
+      agent.allocArea(0, page_size, MemoryArea::ProtectionFlags::RW));
+
+    if (Agent::IsSyscallError(path_address))
+    {
+        ASURA_EXCEPTION("Could not allocate the path in the target");
+    }
+
+    try
+    {
+        MemoryUtils::WriteProcessMemoryArea(
+          process.id(),
+          bytes_t(path.c_str(), path.c_str() + path.size() + 1),
+          path_address);
+    }
+    catch (...)
+    {
+        agent.result(agent.freeArea(path_address, page_size));
+        throw;
+    }
+
+    const auto open_ticket = agent.pushSyscall(
+      SYS_openat,
+      { view_as<std::uint64_t>(AT_FDCWD),
+        path_address,
+        O_RDWR | O_CLOEXEC,
+        0,
+        0,
+        0 });
+    const auto free_ticket = agent.freeArea(path_address, page_size);
+
+    const auto remote_fd = agent.result(open_ticket);
+
+    if (Agent::IsSyscallError(remote_fd))
+    {
+        agent.result(free_ticket);
+        ASURA_EXCEPTION("Target could not open " + path);
+    }
+
+    /* The mapping keeps the memfd alive, the fd isn't needed anymore */
+    const auto map_ticket = agent.pushSyscall(
+      SYS_mmap,
+      { 0,
+        _size,
+        view_as<std::uint64_t>(MemoryArea::ProtectionFlags::ToOS(flags)),
+        MAP_SHARED,
+        remote_fd,
+        0 });
+    const auto close_ticket = agent.pushSyscall(
+      SYS_close,
+      { remote_fd, 0, 0, 0, 0, 0 });
+
+    const auto remote_address = agent.result(map_ticket);
+
+    agent.result(close_ticket);
+    agent.result(free_ticket);
+
+    if (Agent::IsSyscallError(remote_address))
+    {
+        ASURA_EXCEPTION("Target could not map the region, size: "
+                        + std::to_string(_size));
+    }
+
+    _remote_address = remote_address;
+
+    return _remote_address;
+#else
+    static_cast<void>(agent);
+    static_cast<void>(process);
+    static_cast<void>(flags);
+    ASURA_EXCEPTION("Shared regions aren't supported on this platform");
+#endif
+}
+
+auto SharedRegion::unmapFrom(Agent& agent) -> void
+{
+    if (_remote_address == UNMAPPED)
+    {
+        return;
+    }
+
+    const auto ret = agent.result(agent.freeArea(_remote_address, _size));
+
+    if (Agent::IsSyscallError(ret))
+    {
+        ASURA_EXCEPTION("Target could not unmap the region");
+    }
+
+    _remote_address = UNMAPPED;
+}
+
+auto SharedRegion::release() -> void
+{
+#ifndef WINDOWS
+    if (_data)
+    {
+        munmap(_data, _size);
+        _data = nullptr;
+    }
+
+    if (_fd >= 0)
+    {
+        close(_fd);
+        _fd = -1;
+    }
+#endif
+}
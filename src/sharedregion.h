@@ -0,0 +1,74 @@
+#ifndef ASURA_SHAREDREGION_H
+#define ASURA_SHAREDREGION_H
+
+#include "agent.h"
+
+namespace Asura
+{
+    /**
+     * Memory backed by a memfd, mapped here and inside a target process
+     * through its agent.
+     * Both sides share the same pages, so data exchanged through it
+     * (see SharedCircularBuffer) costs no syscall at all.
+     * Linux only.
+     */
+    class SharedRegion
+    {
+      public:
+        static constexpr inline std::uintptr_t UNMAPPED = 0;
+
+      public:
+        explicit SharedRegion(const std::size_t size);
+        ~SharedRegion();
+
+        SharedRegion(const SharedRegion&)                    = delete;
+        auto operator=(const SharedRegion&) -> SharedRegion& = delete;
+
+      public:
+        auto data() const -> byte_t*;
+        auto size() const -> std::size_t;
+        auto fd() const -> int;
+        /* Where the target sees it */
+        auto remoteAddress() const -> std::uintptr_t;
+
+        /**
+         * Object living at the beginning of the region, the region
+         * must be large enough for it.
+         */
+        template <typename T>
+        auto as() const -> T*
+        {
+            if (sizeof(T) > _size)
+            {
+                ASURA_EXCEPTION("Region is too small, size: "
+                                + std::to_string(_size)
+                                + ", needed: "
+                                + std::to_string(sizeof(T)));
+            }
+
+            return view_as<T*>(_data);
+        }
+
+      public:
+        /**
+         * The agent opens our memfd from /proc and maps it, returns the
+         * remote address.
+         */
+        auto mapInto(Agent& agent,
+                     const ProcessBase& process,
+                     const mapf_t flags = MemoryArea::ProtectionFlags::RW)
+          -> std::uintptr_t;
+        auto unmapFrom(Agent& agent) -> void;
+
+      private:
+        auto release() -> void;
+
+      private:
+        int _fd { -1 };
+        std::size_t _size {};
+        byte_t* _data {};
+        std::uintptr_t _remote_address { UNMAPPED };
+    };
+}
+
+#endif
@@ -0,0 +1,831 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "simd.h"
+#include "snapshot.h"
+
+using namespace Asura;
+
+Snapshot::Snapshot(const Process& process,
+                   const CaptureMode captureMode,
+                   const filter_t& filter)
+ : _pid(process.id())
+{
+    if (captureMode == CaptureMode::Frozen
+        and _pid == ProcessBase::self().id())
+    {
+        ASURA_EXCEPTION("Can't stop our own process for a snapshot");
+    }
+
+    for (const auto& area : process.mmap().areaTable())
+    {
+        if (filter ? not filter(area) : not area.isReadable())
+        {
+            continue;
+        }
+
+        /* Areas are page aligned, so are the offsets */
+        _regions.push_back({ .address  = area.begin(),
+                             .size     = area.size(),
+                             .offset   = _size,
+                             .flags    = area.flags(),
+                             .name     = area.name(),
+                             .captured = false });
+
+        _size += area.size();
+    }
+
+    _stats.total_bytes = _size;
+
+    allocateStorage();
+
+    try
+    {
+        if (captureMode == CaptureMode::Frozen)
+        {
+            captureFrozen();
+        }
+        else
+        {
+            std::vector<std::size_t> region_indexes(_regions.size());
+            std::iota(region_indexes.begin(), region_indexes.end(), 0);
+
+            capture(region_indexes);
+        }
+    }
+    catch (...)
+    {
+        releaseStorage();
+        throw;
+    }
+}
+
+Snapshot::~Snapshot()
+{
+    releaseStorage();
+}
+
+Snapshot::Snapshot(Snapshot&& snapshot) noexcept
+ : _pid(snapshot._pid),
+   _regions(std::move(snapshot._regions)),
+   _stats(snapshot._stats),
+   _size(std::exchange(snapshot._size, 0)),
+   _storage(std::exchange(snapshot._storage, nullptr)),
+   _fd(std::exchange(snapshot._fd, -1))
+{
+}
+
+auto Snapshot::operator=(Snapshot&& snapshot) noexcept -> Snapshot&
+{
+    if (this != &snapshot)
+    {
+        releaseStorage();
+
+        _pid     = snapshot._pid;
+        _regions = std::move(snapshot._regions);
+        _stats   = snapshot._stats;
+        _size    = std::exchange(snapshot._size, 0);
+        _storage = std::exchange(snapshot._storage, nullptr);
+        _fd      = std::exchange(snapshot._fd, -1);
+    }
+
+    return *this;
+}
+
+auto Snapshot::Diff(const byte_t* const previous,
+                    const byte_t* const current,
+                    const std::size_t size,
+                    const std::uintptr_t baseAddress,
+                    changes_t& changes) -> void
+{
+    constexpr auto simd_size  = sizeof(SIMD::value_t);
+    constexpr auto unroll     = 4;
+    constexpr auto all_bits   = view_as<std::uint64_t>(SIMD::cmp_all);
+    constexpr auto block_size = simd_size * unroll;
+
+    bool in_run           = false;
+    std::size_t run_begin = 0;
+
+    const auto add_change = [&](const std::size_t runEnd)
+    {
+        const auto address = baseAddress + run_begin;
+        const auto length  = runEnd - run_begin;
+
+        if (not changes.empty()
+            and changes.back().address + changes.back().size == address)
+        {
+            changes.back().size += length;
+        }
+        else
+        {
+            changes.push_back({ .address = address, .size = length });
+        }
+    };
+
+    /**
+     * Each bit of the mask is a byte that changed, we walk the runs of
+     * ones and zeroes instead of the bytes.
+     */
+    const auto walk_mask = [&](const std::uint64_t changed,
+                               const std::size_t offset,
+                               const std::size_t bits)
+    {
+        std::size_t bit = 0;
+
+        while (bit < bits)
+        {
+            const auto rest = changed >> bit;
+
+            if (in_run)
+            {
+                bit += view_as<std::size_t>(std::countr_one(rest));
+
+                if (bit < bits)
+                {
+                    add_change(offset + bit);
+                    in_run = false;
+                }
+            }
+            else
+            {
+                if (rest == 0)
+                {
+                    break;
+                }
+
+                bit += view_as<std::size_t>(std::countr_zero(rest));
+
+                run_begin = offset + bit;
+                in_run    = true;
+            }
+        }
+    };
+
+    const auto changed_mask = [&](const std::size_t offset)
+    {
+        const auto equal = SIMD::CMPMask8bits(
+          SIMD::LoadUnaligned(view_as<SIMD::value_t*>(previous + offset)),
+          SIMD::LoadUnaligned(view_as<SIMD::value_t*>(current + offset)));
+
+        return ~view_as<std::uint64_t>(equal) & all_bits;
+    };
+
+    std::size_t offset = 0;
+
+    for (; offset + block_size <= size; offset += block_size)
+    {
+        std::array<std::uint64_t, unroll> masks;
+
+        std::uint64_t any_changed = 0, all_changed = all_bits;
+
+        for (std::size_t i = 0; i < unroll; i++)
+        {
+            masks[i] = changed_mask(offset + i * simd_size);
+            any_changed |= masks[i];
+            all_changed &= masks[i];
+        }
+
+        /* Nothing that would start or end a run */
+        if ((not in_run and any_changed == 0)
+            or (in_run and all_changed == all_bits))
+        {
+            continue;
+        }
+
+        for (std::size_t i = 0; i < unroll; i++)
+        {
+            walk_mask(masks[i], offset + i * simd_size, simd_size);
+        }
+    }
+
+    for (; offset + simd_size <= size; offset += simd_size)
+    {
+        walk_mask(changed_mask(offset), offset, simd_size);
+    }
+
+    /* Remaining bytes, less than a SIMD value */
+    std::uint64_t tail_mask = 0;
+
+    for (std::size_t i = 0; offset + i < size; i++)
+    {
+        if (previous[offset + i] != current[offset + i])
+        {
+            tail_mask |= view_as<std::uint64_t>(1) << i;
+        }
+    }
+
+    walk_mask(tail_mask, offset, size - offset);
+
+    if (in_run)
+    {
+        add_change(size);
+    }
+}
+
+auto Snapshot::processID() const -> process_id_t
+{
+    return _pid;
+}
+
+auto Snapshot::regions() const -> const std::vector<Region>&
+{
+    return _regions;
+}
+
+auto Snapshot::stats() const -> const CaptureStats&
+{
+    return _stats;
+}
+
+auto Snapshot::size() const -> std::size_t
+{
+    return _size;
+}
+
+auto Snapshot::data() const -> const byte_t*
+{
+    return _storage;
+}
+
+auto Snapshot::regionData(const Region& region) const -> const byte_t*
+{
+    return _storage + region.offset;
+}
+
+auto Snapshot::fd() const -> int
+{
+    return _fd;
+}
+
+auto Snapshot::diff(const Snapshot& snapshot) const -> changes_t
+{
+    changes_t changes;
+
+    std::size_t i = 0, j = 0;
+
+    /* Both are sorted by address, compare what overlaps */
+    while (i < _regions.size() and j < snapshot._regions.size())
+    {
+        const auto& previous = _regions[i];
+        const auto& current  = snapshot._regions[j];
+
+        const auto begin = std::max(previous.address, current.address);
+        const auto end   = std::min(previous.address + previous.size,
+                                  current.address + current.size);
+
+        if (begin < end and previous.captured and current.captured)
+        {
+            Diff(regionData(previous) + (begin - previous.address),
+                 snapshot.regionData(current) + (begin - current.address),
+                 end - begin,
+                 begin,
+                 changes);
+        }
+
+        if (previous.address + previous.size
+            < current.address + current.size)
+        {
+            i++;
+        }
+        else
+        {
+            j++;
+        }
+    }
+
+    return changes;
+}
+
+auto Snapshot::diffLive() const -> changes_t
+{
+    changes_t changes;
+
+    bytes_t buffer(std::min(LIVE_DIFF_BATCH_SIZE, _size));
+    MemoryUtils::transfers_t transfers;
+    std::vector<const byte_t*> previous_data;
+    std::size_t buffer_used = 0;
+
+    const auto diff_transfer = [&](const std::size_t index)
+    {
+        const auto& transfer = transfers[index];
+
+        Diff(previous_data[index],
+             view_as<const byte_t*>(transfer.local),
+             transfer.size,
+             transfer.remote,
+             changes);
+    };
+
+    const auto flush = [&]()
+    {
+        try
+        {
+            MemoryUtils::ReadProcessMemoryAreas(_pid, transfers);
+
+            for (std::size_t i = 0; i < transfers.size(); i++)
+            {
+                diff_transfer(i);
+            }
+        }
+        catch (Exception&)
+        {
+            /**
+             * Something got unmapped meanwhile, we don't report what
+             * can't be read anymore.
+             */
+            for (std::size_t i = 0; i < transfers.size(); i++)
+            {
+                try
+                {
+                    MemoryUtils::ReadProcessMemoryAreas(_pid,
+                                                        { transfers[i] });
+                }
+                catch (Exception&)
+                {
+                    continue;
+                }
+
+                diff_transfer(i);
+            }
+        }
+
+        transfers.clear();
+        previous_data.clear();
+        buffer_used = 0;
+    };
+
+    for (const auto& region : _regions)
+    {
+        if (not region.captured)
+        {
+            continue;
+        }
+
+        /* Big regions are split to fit inside the buffer */
+        for (std::size_t offset = 0; offset < region.size;)
+        {
+            if (buffer_used == buffer.size())
+            {
+                flush();
+            }
+
+            const auto size = std::min(region.size - offset,
+                                       buffer.size() - buffer_used);
+
+            transfers.push_back({ .local  = buffer.data() + buffer_used,
+                                  .remote = region.address + offset,
+                                  .size   = size });
+            previous_data.push_back(regionData(region) + offset);
+
+            buffer_used += size;
+            offset += size;
+        }
+    }
+
+    if (not transfers.empty())
+    {
+        flush();
+    }
+
+    return changes;
+}
+
+auto Snapshot::SoftDirtySupported() -> bool
+{
+#ifndef WINDOWS
+    static std::once_flag once_flag;
+    static bool supported = false;
+
+    /**
+     * Freshly faulted pages are soft-dirty when the kernel tracks them,
+     * otherwise the bit is never set and we can't rely on it.
+     */
+    std::call_once(
+      once_flag,
+      []()
+      {
+          const auto page_size = MemoryUtils::GetPageSize();
+          const auto page      = mmap(nullptr,
+                                 page_size,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS,
+                                 -1,
+                                 0);
+
+          if (page == MAP_FAILED)
+          {
+              return;
+          }
+
+          *view_as<volatile byte_t*>(page) = 1;
+
+          const auto pagemap_fd = open("/proc/self/pagemap",
+                                       O_RDONLY | O_CLOEXEC);
+
+          if (pagemap_fd >= 0)
+          {
+              std::uint64_t entry = 0;
+
+              const auto ret = pread(
+                pagemap_fd,
+                &entry,
+                sizeof(entry),
+                view_as<off_t>((view_as<std::uintptr_t>(page) / page_size)
+                               * sizeof(entry)));
+
+              supported = ret == sizeof(entry)
+                          and (entry & SOFT_DIRTY_BIT);
+
+              close(pagemap_fd);
+          }
+
+          munmap(page, page_size);
+      });
+
+    return supported;
+#else
+    return false;
+#endif
+}
+
+auto Snapshot::ClearSoftDirty(const process_id_t pid) -> bool
+{
+#ifndef WINDOWS
+    if (not SoftDirtySupported())
+    {
+        return false;
+    }
+
+    std::ofstream clear_refs("/proc/" + std::to_string(pid)
+                             + "/clear_refs");
+
+    if (not clear_refs.is_open())
+    {
+        return false;
+    }
+
+    /* Clears the soft-dirty bits of every pages */
+    clear_refs << "4";
+    clear_refs.flush();
+
+    return clear_refs.good();
+#else
+    static_cast<void>(pid);
+    return false;
+#endif
+}
+
+auto Snapshot::ReadState(const std::string& statPath) -> char
+{
+    std::ifstream stat_file(statPath);
+    std::string stat;
+    std::getline(stat_file, stat);
+
+    /* The name can contain anything, the state is after it */
+    const auto name_end = stat.rfind(')');
+
+    if (name_end == std::string::npos or name_end + 2 >= stat.size())
+    {
+        return 0;
+    }
+
+    return stat[name_end + 2];
+}
+
+auto Snapshot::IsStopped(const char state) -> bool
+{
+    /* By a signal or by a tracer */
+    return state == 'T' or state == 't';
+}
+
+auto Snapshot::WaitUntilStopped(const process_id_t pid) -> void
+{
+#ifndef WINDOWS
+    using namespace std::chrono_literals;
+
+    const auto tasks_path = "/proc/" + std::to_string(pid) + "/task";
+    const auto deadline   = std::chrono::steady_clock::now() + 1s;
+
+    while (true)
+    {
+        bool all_stopped = true;
+
+        for (const auto& task_entry :
+             std::filesystem::directory_iterator(tasks_path))
+        {
+            const auto state = ReadState(
+              (task_entry.path() / "stat").string());
+
+            if (state == 0)
+            {
+                continue;
+            }
+
+            if (not IsStopped(state) and state != 'Z' and state != 'X')
+            {
+                all_stopped = false;
+                break;
+            }
+        }
+
+        if (all_stopped)
+        {
+            return;
+        }
+
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            ASURA_EXCEPTION("Process " + std::to_string(pid)
+                            + " didn't stop in time");
+        }
+
+        std::this_thread::yield();
+    }
+#else
+    static_cast<void>(pid);
+#endif
+}
+
+auto Snapshot::allocateStorage() -> void
+{
+    if (_size == 0)
+    {
+        return;
+    }
+
+#ifndef WINDOWS
+    _fd = memfd_create("asura_snapshot", MFD_CLOEXEC);
+
+    if (_fd < 0)
+    {
+        ASURA_EXCEPTION("memfd_create failed with: "
+                        + std::to_string(errno));
+    }
+
+    if (ftruncate(_fd, view_as<off_t>(_size)) < 0)
+    {
+        releaseStorage();
+        ASURA_EXCEPTION("ftruncate failed with size: "
+                        + std::to_string(_size));
+    }
+
+    const auto storage = mmap(nullptr,
+                              _size,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED,
+                              _fd,
+                              0);
+
+    if (storage == MAP_FAILED)
+    {
+        releaseStorage();
+        ASURA_EXCEPTION("mmap failed with size: " + std::to_string(_size));
+    }
+
+    _storage = view_as<byte_t*>(storage);
+#else
+    _storage = view_as<byte_t*>(
+      VirtualAlloc(nullptr, _size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+
+    if (_storage == nullptr)
+    {
+        ASURA_EXCEPTION("VirtualAlloc failed with size: "
+                        + std::to_string(_size));
+    }
+#endif
+}
+
+auto Snapshot::releaseStorage() -> void
+{
+#ifndef WINDOWS
+    if (_storage)
+    {
+        munmap(_storage, _size);
+    }
+
+    if (_fd >= 0)
+    {
+        close(_fd);
+    }
+#else
+    if (_storage)
+    {
+        VirtualFree(_storage, 0, MEM_RELEASE);
+    }
+#endif
+
+    _storage = nullptr;
+    _fd      = -1;
+}
+
+auto Snapshot::capture(const std::vector<std::size_t>& regionIndexes)
+  -> void
+{
+    MemoryUtils::transfers_t transfers;
+    transfers.reserve(regionIndexes.size());
+
+    for (const auto region_index : regionIndexes)
+    {
+        const auto& region = _regions[region_index];
+
+        transfers.push_back({ .local  = _storage + region.offset,
+                              .remote = region.address,
+                              .size   = region.size });
+    }
+
+    try
+    {
+        MemoryUtils::ReadProcessMemoryAreas(_pid, transfers);
+
+        for (const auto region_index : regionIndexes)
+        {
+            _regions[region_index].captured = true;
+        }
+
+        return;
+    }
+    catch (Exception&)
+    {
+    }
+
+    /* Find out which ones failed */
+    for (std::size_t i = 0; i < regionIndexes.size(); i++)
+    {
+        auto& region = _regions[regionIndexes[i]];
+
+        try
+        {
+            MemoryUtils::ReadProcessMemoryAreas(_pid, { transfers[i] });
+            region.captured = true;
+        }
+        catch (Exception&)
+        {
+            std::memset(_storage + region.offset, 0, region.size);
+            region.captured = false;
+        }
+    }
+
+    _stats.failed_regions = view_as<std::size_t>(
+      std::count_if(_regions.begin(),
+                    _regions.end(),
+                    [](const Region& region)
+                    {
+                        return not region.captured;
+                    }));
+}
+
+auto Snapshot::captureFrozen() -> void
+{
+#ifndef WINDOWS
+    const auto soft_dirty = ClearSoftDirty(_pid);
+
+    std::vector<std::size_t> region_indexes(_regions.size());
+    std::iota(region_indexes.begin(), region_indexes.end(), 0);
+
+    /* Pre-copy while the process still runs */
+    capture(region_indexes);
+
+    const auto pause_start = std::chrono::steady_clock::now();
+
+    /**
+     * Stopped by job control or a debugger, whoever did it is the one
+     * resuming it.
+     */
+    const auto was_stopped = IsStopped(
+      ReadState("/proc/" + std::to_string(_pid) + "/stat"));
+
+    const auto resume = [&]()
+    {
+        if (not was_stopped)
+        {
+            kill(_pid, SIGCONT);
+        }
+    };
+
+    if (kill(_pid, SIGSTOP) < 0)
+    {
+        ASURA_EXCEPTION("Couldn't stop process "
+                        + std::to_string(_pid));
+    }
+
+    try
+    {
+        WaitUntilStopped(_pid);
+
+        if (soft_dirty)
+        {
+            const auto transfers = dirtyTransfers();
+
+            try
+            {
+                MemoryUtils::ReadProcessMemoryAreas(_pid, transfers);
+
+                for (const auto& transfer : transfers)
+                {
+                    _stats.recopied_bytes += transfer.size;
+                }
+            }
+            catch (Exception&)
+            {
+                /* The memory map changed, copy everything again */
+                capture(region_indexes);
+                _stats.recopied_bytes = _size;
+            }
+        }
+        else
+        {
+            capture(region_indexes);
+            _stats.recopied_bytes = _size;
+        }
+    }
+    catch (...)
+    {
+        resume();
+        throw;
+    }
+
+    resume();
+
+    _stats.pause_ns = view_as<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - pause_start)
+        .count());
+#else
+    ASURA_EXCEPTION("Frozen snapshots are only supported on GNU/Linux");
+#endif
+}
+
+auto Snapshot::dirtyTransfers() -> MemoryUtils::transfers_t
+{
+    MemoryUtils::transfers_t transfers;
+
+#ifndef WINDOWS
+    const auto page_size = MemoryUtils::GetPageSize();
+    const auto pagemap_fd = open(
+      ("/proc/" + std::to_string(_pid) + "/pagemap").c_str(),
+      O_RDONLY | O_CLOEXEC);
+
+    if (pagemap_fd < 0)
+    {
+        ASURA_EXCEPTION("Couldn't open pagemap of process "
+                        + std::to_string(_pid));
+    }
+
+    std::vector<std::uint64_t> entries;
+
+    for (const auto& region : _regions)
+    {
+        /* Couldn't be read before, it won't be now */
+        if (not region.captured)
+        {
+            continue;
+        }
+
+        const auto page_count = region.size / page_size;
+        entries.resize(page_count);
+
+        const auto entries_size = page_count * sizeof(std::uint64_t);
+        const auto ret          = pread(pagemap_fd,
+                               entries.data(),
+                               entries_size,
+                               view_as<off_t>((region.address / page_size)
+                                              * sizeof(std::uint64_t)));
+
+        if (ret != view_as<decltype(ret)>(entries_size))
+        {
+            close(pagemap_fd);
+            ASURA_EXCEPTION("Couldn't read pagemap of process "
+                            + std::to_string(_pid));
+        }
+
+        /* Coalesce contiguous dirty pages */
+        for (std::size_t page = 0; page < page_count; page++)
+        {
+            if (not(entries[page] & SOFT_DIRTY_BIT))
+            {
+                continue;
+            }
+
+            const auto offset = page * page_size;
+
+            if (not transfers.empty()
+                and transfers.back().remote + transfers.back().size
+                      == region.address + offset)
+            {
+                transfers.back().size += page_size;
+            }
+            else
+            {
+                transfers.push_back(
+                  { .local  = _storage + region.offset + offset,
+                    .remote = region.address + offset,
+                    .size   = page_size });
+            }
+        }
+    }
+
+    close(pagemap_fd);
+#endif
+
+    return transfers;
+}
@@ -0,0 +1,146 @@
+#ifndef ASURA_SNAPSHOT_H
+#define ASURA_SNAPSHOT_H
+
+#include "memoryareatable.h"
+#include "process.h"
+
+namespace Asura
+{
+    /**
+     * Copy of selected areas of a process at a given time.
+     * The copy lives in one shared memory file (memfd on GNU/Linux), so
+     * it can be handed to another process or mapped again without
+     * copying it.
+     */
+    class Snapshot
+    {
+      public:
+        enum class CaptureMode
+        {
+            /* Copy while the process keeps running */
+            Live,
+            /**
+             * Copy while the process runs, then stop every threads and
+             * copy again only the pages that were written meanwhile,
+             * so the result is consistent with a minimal pause.
+             * A process that was already stopped is left stopped.
+             */
+            Frozen
+        };
+
+        struct Region
+        {
+            std::uintptr_t address;
+            std::size_t size;
+            /* Offset inside the snapshot storage */
+            std::size_t offset;
+            mapf_t flags;
+            std::string name;
+            /* false when the area couldn't be read, data is zeroed */
+            bool captured;
+        };
+
+        struct CaptureStats
+        {
+            /* Time the process was stopped in Frozen mode */
+            std::uint64_t pause_ns;
+            std::size_t total_bytes;
+            /* Bytes copied again while the process was stopped */
+            std::size_t recopied_bytes;
+            std::size_t failed_regions;
+        };
+
+        struct ChangedRange
+        {
+            std::uintptr_t address;
+            std::size_t size;
+        };
+
+        using filter_t = std::function<bool(
+          const MemoryAreaTable::View&)>;
+        using changes_t = std::vector<ChangedRange>;
+
+        /* Bytes read at once from the process when diffing live */
+        static constexpr inline std::size_t LIVE_DIFF_BATCH_SIZE =
+          0x1000000;
+
+      public:
+        /**
+         * Takes the areas of the process memory map as they are, the
+         * map should be refreshed before if needed.
+         * By default every readable areas are captured.
+         */
+        explicit Snapshot(
+          const Process& process,
+          const CaptureMode captureMode = CaptureMode::Live,
+          const filter_t& filter        = nullptr);
+
+        ~Snapshot();
+
+        Snapshot(const Snapshot&)                    = delete;
+        auto operator=(const Snapshot&) -> Snapshot& = delete;
+
+        Snapshot(Snapshot&& snapshot) noexcept;
+        auto operator=(Snapshot&& snapshot) noexcept -> Snapshot&;
+
+      public:
+        /**
+         * Compares two buffers and appends the ranges that changed,
+         * the last range is merged with the new ones if adjacent.
+         */
+        static auto Diff(const byte_t* const previous,
+                         const byte_t* const current,
+                         const std::size_t size,
+                         const std::uintptr_t baseAddress,
+                         changes_t& changes) -> void;
+
+      public:
+        auto processID() const -> process_id_t;
+        auto regions() const -> const std::vector<Region>&;
+        auto stats() const -> const CaptureStats&;
+        auto size() const -> std::size_t;
+        auto data() const -> const byte_t*;
+        auto regionData(const Region& region) const -> const byte_t*;
+        /* Shared memory file descriptor on GNU/Linux */
+        auto fd() const -> int;
+
+        /**
+         * Ranges that changed between this snapshot and another one,
+         * only the addresses captured by both are compared.
+         */
+        auto diff(const Snapshot& snapshot) const -> changes_t;
+        /* Ranges that changed since the capture */
+        auto diffLive() const -> changes_t;
+
+      private:
+        /* Bit 55 of a pagemap entry */
+        static constexpr inline std::uint64_t SOFT_DIRTY_BIT =
+          view_as<std::uint64_t>(1) << 55;
+
+      private:
+        static auto SoftDirtySupported() -> bool;
+        static auto ClearSoftDirty(const process_id_t pid) -> bool;
+        /* From a /proc stat file, 0 when it can't be read */
+        static auto ReadState(const std::string& statPath) -> char;
+        static auto IsStopped(const char state) -> bool;
+        static auto WaitUntilStopped(const process_id_t pid) -> void;
+
+      private:
+        auto allocateStorage() -> void;
+        auto releaseStorage() -> void;
+        auto capture(const std::vector<std::size_t>& regionIndexes)
+          -> void;
+        auto captureFrozen() -> void;
+        auto dirtyTransfers() -> MemoryUtils::transfers_t;
+
+      private:
+        process_id_t _pid;
+        std::vector<Region> _regions;
+        CaptureStats _stats {};
+        std::size_t _size {};
+        byte_t* _storage {};
+        int _fd { -1 };
+    };
+}
+
+#endif
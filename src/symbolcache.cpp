@@ -0,0 +1,387 @@
+#include "pch.h"
+
+#include "elf.h"
+#include "exception.h"
+#include "memoryutils.h"
+#include "symbolcache.h"
+
+using namespace Asura;
+
+struct CacheLayout
+{
+    std::size_t symbols_offset;
+    std::size_t by_value_offset;
+    std::size_t names_offset;
+    std::size_t size;
+};
+
+static auto LayoutOf(const SymbolCache::Header& header) -> CacheLayout
+{
+    CacheLayout layout;
+
+    layout.symbols_offset  = sizeof(SymbolCache::Header);
+    layout.by_value_offset = layout.symbols_offset
+                             + header.symbol_count
+                                 * sizeof(SymbolTable::Symbol);
+    layout.names_offset    = layout.by_value_offset
+                          + header.by_value_count
+                              * sizeof(std::uint32_t);
+    layout.size            = layout.names_offset + header.names_size;
+
+    return layout;
+}
+
+template <ELF::IntType T>
+static auto FindBuildID(const MappedFile& mappedFile,
+                        SymbolCache::Key& key) -> void
+{
+    const auto elf_header = mappedFile.at<ELF::Elf_Ehdr<T>>(0);
+
+    if (not elf_header)
+    {
+        return;
+    }
+
+    const auto program_headers = mappedFile.at<ELF::Elf_Phdr<T>>(
+      elf_header->e_phoff,
+      elf_header->e_phnum);
+
+    if (not program_headers)
+    {
+        return;
+    }
+
+    for (std::uint16_t i = 0; i < elf_header->e_phnum; i++)
+    {
+        const auto& program_header = program_headers[i];
+
+        if (program_header.p_type != ELF::PT_NOTE)
+        {
+            continue;
+        }
+
+        const auto notes = mappedFile.at<byte_t>(program_header.p_offset,
+                                                 program_header.p_filesz);
+
+        if (not notes)
+        {
+            continue;
+        }
+
+        /* The words of the notes are 32 bits for both classes */
+        using note_t = ELF::Elf_Nhdr<std::uint32_t>;
+
+        for (std::size_t offset = 0;
+             offset + sizeof(note_t) <= program_header.p_filesz;)
+        {
+            const auto note = view_as<const note_t*>(notes + offset);
+
+            const auto name_offset = offset + sizeof(note_t);
+            const auto desc_offset = name_offset
+                                     + MemoryUtils::AlignToPageSize(
+                                       view_as<std::size_t>(
+                                         note->n_namesz),
+                                       std::size_t(4));
+
+            offset = desc_offset
+                     + MemoryUtils::AlignToPageSize(
+                       view_as<std::size_t>(note->n_descsz),
+                       std::size_t(4));
+
+            if (offset > program_header.p_filesz)
+            {
+                break;
+            }
+
+            if (note->n_type == ELF::NT_GNU_BUILD_ID
+                and note->n_namesz == 4
+                and std::memcmp(notes + name_offset, "GNU", 4) == 0)
+            {
+                key.build_id_size = std::min(
+                  view_as<std::size_t>(note->n_descsz),
+                  SymbolCache::BUILD_ID_MAX_SIZE);
+
+                std::memcpy(key.build_id.data(),
+                            notes + desc_offset,
+                            key.build_id_size);
+
+                return;
+            }
+        }
+    }
+}
+
+auto SymbolCache::DefaultDirectory() -> std::filesystem::path
+{
+    std::filesystem::path directory;
+
+#ifndef WINDOWS
+    if (const auto cache_home = std::getenv("XDG_CACHE_HOME"))
+    {
+        directory = cache_home;
+    }
+    else if (const auto home = std::getenv("HOME"))
+    {
+        directory = std::filesystem::path(home) / ".cache";
+    }
+#else
+    if (const auto local_app_data = std::getenv("LOCALAPPDATA"))
+    {
+        directory = local_app_data;
+    }
+#endif
+
+    if (directory.empty())
+    {
+        directory = std::filesystem::temp_directory_path();
+    }
+
+    return directory / "asura" / "symbols";
+}
+
+auto SymbolCache::KeyOf(const MappedFile& mappedFile) -> Key
+{
+    Key key { .build_id          = {},
+              .build_id_size     = 0,
+              .file_size         = mappedFile.size(),
+              .modification_time = mappedFile.modificationTime(),
+              .inode             = mappedFile.inode() };
+
+    const auto elf_parent_header = mappedFile.at<ELF::Elf_Parent_Ehdr>(0);
+
+    if (not elf_parent_header
+        or std::memcmp(elf_parent_header,
+                       &ELF::MAGIC_NUMBER,
+                       sizeof(ELF::MAGIC_NUMBER))
+             != 0)
+    {
+        return key;
+    }
+
+    switch (elf_parent_header->e_ident[ELF::EI_CLASS])
+    {
+        case ELF::ELFCLASS32:
+        {
+            FindBuildID<std::uint32_t>(mappedFile, key);
+            break;
+        }
+
+        case ELF::ELFCLASS64:
+        {
+            FindBuildID<std::uint64_t>(mappedFile, key);
+            break;
+        }
+    }
+
+    /**
+     * The same build stays valid wherever the file is, the size tells
+     * a stripped copy from the original.
+     */
+    if (key.build_id_size)
+    {
+        key.modification_time = 0;
+        key.inode             = 0;
+    }
+
+    return key;
+}
+
+SymbolCache::SymbolCache(const std::filesystem::path& directory)
+ : _directory(directory)
+{
+}
+
+auto SymbolCache::directory() const -> const std::filesystem::path&
+{
+    return _directory;
+}
+
+auto SymbolCache::get(const std::string& path) const -> SymbolTable
+{
+    const MappedFile mapped_file(path);
+    const auto key = KeyOf(mapped_file);
+
+    if (auto symbol_table = load(key))
+    {
+        return std::move(*symbol_table);
+    }
+
+    auto symbol_table = SymbolTable::FromData(mapped_file.data(),
+                                              mapped_file.size());
+
+    /* Still usable without cache, read only home for example */
+    try
+    {
+        store(key, symbol_table);
+    }
+    catch (Exception&)
+    {
+    }
+
+    return symbol_table;
+}
+
+auto SymbolCache::load(const Key& key) const -> std::optional<SymbolTable>
+{
+    std::shared_ptr<const MappedFile> mapped_file;
+
+    try
+    {
+        mapped_file = std::make_shared<const MappedFile>(
+          cachePath(key).string());
+    }
+    catch (Exception&)
+    {
+        return std::nullopt;
+    }
+
+    const auto header = mapped_file->at<Header>(0);
+
+    if (not header or header->magic != MAGIC
+        or header->version != VERSION
+        or header->symbol_size != sizeof(SymbolTable::Symbol)
+        or header->key != key)
+    {
+        return std::nullopt;
+    }
+
+    const auto layout = LayoutOf(*header);
+
+    if (layout.size != mapped_file->size())
+    {
+        return std::nullopt;
+    }
+
+    const auto symbols = mapped_file->at<SymbolTable::Symbol>(
+      layout.symbols_offset,
+      header->symbol_count);
+    const auto by_value = mapped_file->at<std::uint32_t>(
+      layout.by_value_offset,
+      header->by_value_count);
+    const auto names = mapped_file->at<char>(layout.names_offset,
+                                             header->names_size);
+
+    if (not symbols or not by_value or not names
+        or (header->names_size and names[header->names_size - 1] != '\0'))
+    {
+        return std::nullopt;
+    }
+
+    /**
+     * Everything the lookups index with must stay inside the file, a
+     * truncated or edited one is parsed again instead.
+     */
+    const auto is_outside = std::any_of(
+                              by_value,
+                              by_value + header->by_value_count,
+                              [&](const std::uint32_t index)
+                              {
+                                  return index >= header->symbol_count;
+                              })
+                            or std::any_of(
+                              symbols,
+                              symbols + header->symbol_count,
+                              [&](const SymbolTable::Symbol& symbol)
+                              {
+                                  return symbol.name_offset
+                                         >= header->names_size;
+                              });
+
+    if (is_outside)
+    {
+        return std::nullopt;
+    }
+
+    return SymbolTable::FromViews(
+      mapped_file,
+      header->load_address,
+      std::span(symbols, header->symbol_count),
+      std::span(by_value, header->by_value_count),
+      std::string_view(names, header->names_size));
+}
+
+auto SymbolCache::store(const Key& key,
+                        const SymbolTable& symbolTable) const -> void
+{
+    std::error_code error_code;
+    std::filesystem::create_directories(_directory, error_code);
+
+    const auto cache_path = cachePath(key);
+
+    /* Readers never see a file being written */
+    auto temporary_path = cache_path;
+    temporary_path += ".tmp"
+                      + std::to_string(std::chrono::steady_clock::now()
+                                         .time_since_epoch()
+                                         .count());
+
+    const auto symbols  = symbolTable.symbols();
+    const auto by_value = symbolTable.symbolsByValue();
+    const auto names    = symbolTable.names();
+
+    const Header header { .magic          = MAGIC,
+                          .version        = VERSION,
+                          .symbol_size    = sizeof(SymbolTable::Symbol),
+                          .key            = key,
+                          .load_address   = symbolTable.loadAddress(),
+                          .symbol_count   = symbols.size(),
+                          .by_value_count = by_value.size(),
+                          .names_size     = names.size() };
+
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::out);
+
+    if (not file.is_open())
+    {
+        ASURA_EXCEPTION("Couldn't create file "
+                        + temporary_path.string());
+    }
+
+    file.write(view_as<const char*>(&header), sizeof(header));
+    file.write(view_as<const char*>(symbols.data()),
+               view_as<std::streamsize>(symbols.size_bytes()));
+    file.write(view_as<const char*>(by_value.data()),
+               view_as<std::streamsize>(by_value.size_bytes()));
+    file.write(names.data(), view_as<std::streamsize>(names.size()));
+    file.close();
+
+    if (not file)
+    {
+        std::filesystem::remove(temporary_path, error_code);
+        ASURA_EXCEPTION("Couldn't write file " + temporary_path.string());
+    }
+
+    std::filesystem::rename(temporary_path, cache_path, error_code);
+
+    if (error_code)
+    {
+        std::filesystem::remove(temporary_path, error_code);
+        ASURA_EXCEPTION("Couldn't rename file "
+                        + temporary_path.string());
+    }
+}
+
+auto SymbolCache::cachePath(const Key& key) const
+  -> std::filesystem::path
+{
+    constexpr std::string_view hex_digits = "0123456789abcdef";
+
+    std::stringstream file_name;
+    file_name << std::hex;
+
+    if (key.build_id_size)
+    {
+        for (std::size_t i = 0; i < key.build_id_size; i++)
+        {
+            file_name << hex_digits[key.build_id[i] >> 4]
+                      << hex_digits[key.build_id[i] & 0xf];
+        }
+    }
+    else
+    {
+        file_name << "inode-" << key.inode << "-" << key.modification_time;
+    }
+
+    file_name << "-" << key.file_size << ".sym";
+
+    return _directory / file_name.str();
+}
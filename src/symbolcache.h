@@ -0,0 +1,80 @@
+#ifndef ASURA_SYMBOLCACHE_H
+#define ASURA_SYMBOLCACHE_H
+
+#include "symboltable.h"
+
+namespace Asura
+{
+    /**
+     * Symbol tables kept on the disk between runs, one file per module
+     * file, keyed by its GNU build-id, or by its size, modification time
+     * and inode when it has none.
+     * A cache file is the table's arrays as they are in memory behind a
+     * header, it's mapped and used as is, nothing is parsed.
+     * The key is read again from the module's headers each time, a
+     * cache file that doesn't match anymore is rebuilt, as is one whose
+     * indexes or name offsets point outside of it.
+     */
+    class SymbolCache
+    {
+      public:
+        /* "ASURASYM" */
+        static constexpr inline std::uint64_t MAGIC = 0x4d59534152555341;
+        static constexpr inline std::uint32_t VERSION = 3;
+        static constexpr inline std::size_t BUILD_ID_MAX_SIZE = 0x40;
+
+        struct Key
+        {
+            std::array<byte_t, BUILD_ID_MAX_SIZE> build_id;
+            /* Zero when there's no build-id */
+            std::uint64_t build_id_size;
+            std::uint64_t file_size;
+            std::uint64_t modification_time;
+            std::uint64_t inode;
+
+            auto operator==(const Key& key) const -> bool = default;
+        };
+
+        struct Header
+        {
+            std::uint64_t magic;
+            std::uint32_t version;
+            /* Catches a different layout of the symbols */
+            std::uint32_t symbol_size;
+            Key key;
+            std::uint64_t load_address;
+            std::uint64_t symbol_count;
+            std::uint64_t by_value_count;
+            std::uint64_t names_size;
+        };
+
+      public:
+        /* $XDG_CACHE_HOME/asura/symbols or alike */
+        static auto DefaultDirectory() -> std::filesystem::path;
+
+        /* Only the headers and the build-id note get read */
+        static auto KeyOf(const MappedFile& mappedFile) -> Key;
+
+      public:
+        explicit SymbolCache(
+          const std::filesystem::path& directory = DefaultDirectory());
+
+      public:
+        auto directory() const -> const std::filesystem::path&;
+
+        /* Parsed then stored when there's no valid cache file */
+        auto get(const std::string& path) const -> SymbolTable;
+
+        auto load(const Key& key) const -> std::optional<SymbolTable>;
+        auto store(const Key& key, const SymbolTable& symbolTable) const
+          -> void;
+
+      private:
+        auto cachePath(const Key& key) const -> std::filesystem::path;
+
+      private:
+        std::filesystem::path _directory;
+    };
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "symbolresolver.h"
+
+using namespace Asura;
+
+static constexpr SymbolResolver::Resolved NOT_RESOLVED {
+    .module_id = ModuleIndex::INVALID_ID,
+    .address   = 0,
+    .size      = 0,
+    .type      = SymbolTable::Type::Other
+};
+
+auto SymbolResolver::useCache(
+  std::shared_ptr<const SymbolCache> symbolCache) -> void
+{
+    _symbol_cache = std::move(symbolCache);
+}
+
+auto SymbolResolver::table(const ModuleIndex::Module& module)
+  -> const SymbolTable&
+{
+    auto& symbol_table = _tables[module.path + '\0'
+                                 + std::to_string(module.inode)];
+
+    if (not symbol_table)
+    {
+        try
+        {
+            symbol_table = std::make_shared<const SymbolTable>(
+              _symbol_cache ? _symbol_cache->get(module.path) :
+                              SymbolTable::FromFile(module.path));
+        }
+        catch (Exception&)
+        {
+            symbol_table = std::make_shared<const SymbolTable>();
+        }
+    }
+
+    return *symbol_table;
+}
+
+auto SymbolResolver::resolve(const ModuleIndex& moduleIndex,
+                             const std::string_view moduleName,
+                             const std::vector<std::string>& names)
+  -> std::vector<Resolved>
+{
+    std::vector<Resolved> resolved(names.size(), NOT_RESOLVED);
+
+    const auto module_id = moduleIndex.find(moduleName);
+
+    if (module_id == ModuleIndex::INVALID_ID)
+    {
+        return resolved;
+    }
+
+    const auto& module       = moduleIndex.module(module_id);
+    const auto& symbol_table = table(module);
+    const auto load_bias     = LoadBias(module, symbol_table);
+
+    for (std::size_t i = 0; i < names.size(); i++)
+    {
+        const auto symbol = symbol_table.find(names[i]);
+
+        if (symbol)
+        {
+            resolved[i] = { .module_id = module_id,
+                            .address   = load_bias + symbol->value,
+                            .size      = symbol->size,
+                            .type      = symbol->type };
+        }
+    }
+
+    return resolved;
+}
+
+auto SymbolResolver::resolve(const ModuleIndex& moduleIndex,
+                             const std::vector<std::string>& names)
+  -> std::vector<Resolved>
+{
+    std::vector<Resolved> resolved(names.size(), NOT_RESOLVED);
+
+    std::size_t found_count = 0;
+
+    for (const auto module_id : moduleIndex.loadOrder())
+    {
+        if (found_count == names.size())
+        {
+            break;
+        }
+
+        const auto& module       = moduleIndex.module(module_id);
+        const auto& symbol_table = table(module);
+        const auto load_bias     = LoadBias(module, symbol_table);
+
+        for (std::size_t i = 0; i < names.size(); i++)
+        {
+            if (resolved[i].module_id != ModuleIndex::INVALID_ID)
+            {
+                continue;
+            }
+
+            const auto symbol = symbol_table.find(names[i]);
+
+            /* Locals aren't visible to the other modules */
+            if (symbol and symbol->binding != SymbolTable::Binding::Local)
+            {
+                resolved[i] = { .module_id = module_id,
+                                .address   = load_bias + symbol->value,
+                                .size      = symbol->size,
+                                .type      = symbol->type };
+                found_count++;
+            }
+        }
+    }
+
+    return resolved;
+}
+
+auto SymbolResolver::nearest(const ModuleIndex& moduleIndex,
+                             const std::uintptr_t address)
+  -> std::optional<Nearest>
+{
+    const auto module_id = moduleIndex.search(address);
+
+    if (module_id == ModuleIndex::INVALID_ID)
+    {
+        return std::nullopt;
+    }
+
+    const auto& module       = moduleIndex.module(module_id);
+    const auto& symbol_table = table(module);
+    const auto load_bias     = LoadBias(module, symbol_table);
+
+    const auto symbol = symbol_table.nearest(address - load_bias);
+
+    if (not symbol)
+    {
+        return std::nullopt;
+    }
+
+    const auto symbol_address = load_bias + symbol->value;
+
+    return Nearest { .module_id = module_id,
+                     .name      = std::string(symbol_table.name(*symbol)),
+                     .address   = symbol_address,
+                     .offset    = address - symbol_address };
+}
+
+auto SymbolResolver::clear() -> void
+{
+    _tables.clear();
+}
+
+auto SymbolResolver::LoadBias(const ModuleIndex::Module& module,
+                              const SymbolTable& symbolTable)
+  -> std::uintptr_t
+{
+    return module.begin
+           - view_as<std::uintptr_t>(symbolTable.loadAddress());
+}
@@ -0,0 +1,84 @@
+#ifndef ASURA_SYMBOLRESOLVER_H
+#define ASURA_SYMBOLRESOLVER_H
+
+#include "moduleindex.h"
+#include "symbolcache.h"
+
+namespace Asura
+{
+    /**
+     * Symbols of the modules of a process, each module's file parsed
+     * once into a SymbolTable the first time it's needed, then kept for
+     * as long as the module stays the same file.
+     * Names are resolved by batches, addresses can be resolved back to
+     * the symbol they're in.
+     */
+    class SymbolResolver
+    {
+      public:
+        struct Resolved
+        {
+            /* ModuleIndex::INVALID_ID when not found */
+            ModuleIndex::module_id_t module_id;
+            std::uintptr_t address;
+            std::uint64_t size;
+            SymbolTable::Type type;
+        };
+
+        struct Nearest
+        {
+            ModuleIndex::module_id_t module_id;
+            std::string name;
+            std::uintptr_t address;
+            /* From the symbol, can be past its size */
+            std::uintptr_t offset;
+        };
+
+      public:
+        /**
+         * Tables not parsed yet are then looked for on the disk first,
+         * and stored there once parsed.
+         */
+        auto useCache(std::shared_ptr<const SymbolCache> symbolCache)
+          -> void;
+
+        /**
+         * Modules whose file can't be read or parsed get an empty
+         * table.
+         */
+        auto table(const ModuleIndex::Module& module)
+          -> const SymbolTable&;
+
+        auto resolve(const ModuleIndex& moduleIndex,
+                     const std::string_view moduleName,
+                     const std::vector<std::string>& names)
+          -> std::vector<Resolved>;
+
+        /**
+         * Every module in ModuleIndex::loadOrder(), the first one
+         * having it wins like for the dynamic linker.
+         */
+        auto resolve(const ModuleIndex& moduleIndex,
+                     const std::vector<std::string>& names)
+          -> std::vector<Resolved>;
+
+        auto nearest(const ModuleIndex& moduleIndex,
+                     const std::uintptr_t address)
+          -> std::optional<Nearest>;
+
+        auto clear() -> void;
+
+      private:
+        static auto LoadBias(const ModuleIndex::Module& module,
+                             const SymbolTable& symbolTable)
+          -> std::uintptr_t;
+
+      private:
+        std::shared_ptr<const SymbolCache> _symbol_cache;
+        /* By path and inode, shared with the copies of the process */
+        std::unordered_map<std::string, std::shared_ptr<const SymbolTable>>
+          _tables;
+    };
+}
+
+#endif
@@ -0,0 +1,543 @@
+#include "pch.h"
+
+#include "elf.h"
+#include "exception.h"
+#include "memoryutils.h"
+#include "pe.h"
+#include "symboltable.h"
+
+using namespace Asura;
+
+template <ELF::IntType T>
+static auto ParseELF(const byte_t* const data,
+                     const std::size_t size,
+                     SymbolTable& symbolTable) -> void
+{
+    const auto elf_header = view_as<const ELF::Elf_Ehdr<T>*>(data);
+
+    const auto in_file = [&](const auto offset, const auto length)
+    {
+        return offset <= size and length <= size - offset;
+    };
+
+    if (not in_file(elf_header->e_phoff,
+                    elf_header->e_phnum * sizeof(ELF::Elf_Phdr<T>))
+        or not in_file(elf_header->e_shoff,
+                       elf_header->e_shnum * sizeof(ELF::Elf_Shdr<T>)))
+    {
+        ASURA_EXCEPTION("ELF headers out of the file");
+    }
+
+    const auto program_headers = view_as<const ELF::Elf_Phdr<T>*>(
+      data + elf_header->e_phoff);
+
+    auto load_address = std::numeric_limits<std::uint64_t>::max();
+
+    for (std::uint16_t i = 0; i < elf_header->e_phnum; i++)
+    {
+        if (program_headers[i].p_type == ELF::PT_LOAD)
+        {
+            load_address = std::min(
+              load_address,
+              view_as<std::uint64_t>(program_headers[i].p_vaddr));
+        }
+    }
+
+    if (load_address == std::numeric_limits<std::uint64_t>::max())
+    {
+        load_address = 0;
+    }
+
+    /* The mappings are page aligned */
+    symbolTable.setLoadAddress(
+      MemoryUtils::Align(load_address,
+                         view_as<std::uint64_t>(
+                           MemoryUtils::GetPageSize())));
+
+    const auto sections = view_as<const ELF::Elf_Shdr<T>*>(
+      data + elf_header->e_shoff);
+
+    /* .symtab when not stripped, .dynsym has what's exported */
+    for (std::uint16_t i = 0; i < elf_header->e_shnum; i++)
+    {
+        const auto& section = sections[i];
+
+        if (section.sh_type != ELF::SHT_SYMTAB
+            and section.sh_type != ELF::SHT_DYNSYM)
+        {
+            continue;
+        }
+
+        if (section.sh_link >= elf_header->e_shnum)
+        {
+            continue;
+        }
+
+        const auto& string_section = sections[section.sh_link];
+
+        if (not in_file(section.sh_offset, section.sh_size)
+            or not in_file(string_section.sh_offset,
+                           string_section.sh_size))
+        {
+            continue;
+        }
+
+        const auto symbols = view_as<const ELF::Elf_Sym<T>*>(
+          data + section.sh_offset);
+        const auto symbol_count = section.sh_size
+                                  / sizeof(ELF::Elf_Sym<T>);
+        const auto strings = view_as<const char*>(
+          data + string_section.sh_offset);
+
+        /**
+         * .dynsym has every versions of a name, only the default one is
+         * what the dynamic linker binds to when none is asked for.
+         */
+        const std::uint16_t* versions = nullptr;
+
+        for (std::uint16_t k = 0; k < elf_header->e_shnum; k++)
+        {
+            if (sections[k].sh_type == ELF::SHT_GNU_VERSYM
+                and sections[k].sh_link == i
+                and in_file(sections[k].sh_offset, sections[k].sh_size)
+                and sections[k].sh_size / sizeof(std::uint16_t)
+                      >= symbol_count)
+            {
+                versions = view_as<const std::uint16_t*>(
+                  data + sections[k].sh_offset);
+                break;
+            }
+        }
+
+        for (std::size_t j = 0; j < symbol_count; j++)
+        {
+            const auto& symbol = symbols[j];
+
+            if (symbol.st_shndx == ELF::SHN_UNDEF or symbol.st_name == 0
+                or symbol.st_name >= string_section.sh_size
+                or (versions and (versions[j] & ELF::VERSYM_HIDDEN)))
+            {
+                continue;
+            }
+
+            const auto type = SymbolTable::TypeFromELF(symbol.st_info);
+
+            if (not type)
+            {
+                continue;
+            }
+
+            SymbolTable::Binding binding;
+
+            switch (symbol.st_info >> 4)
+            {
+                case ELF::STB_GLOBAL:
+                {
+                    binding = SymbolTable::Binding::Global;
+                    break;
+                }
+
+                case ELF::STB_WEAK:
+                {
+                    binding = SymbolTable::Binding::Weak;
+                    break;
+                }
+
+                default:
+                {
+                    binding = SymbolTable::Binding::Local;
+                    break;
+                }
+            }
+
+            /* The string table may not be null terminated at its end */
+            const std::string_view name(
+              strings + symbol.st_name,
+              strnlen(strings + symbol.st_name,
+                      string_section.sh_size - symbol.st_name));
+
+            symbolTable.add(name,
+                            symbol.st_value,
+                            symbol.st_size,
+                            *type,
+                            binding);
+        }
+    }
+}
+
+template <PE::IMAGE::IntType T>
+static auto ParsePE(const PE::IMAGE::DOS_HEADER* const dosHeader,
+                    const PE::IMAGE::NT_HEADERS<T>* const ntHeaders,
+                    SymbolTable& symbolTable) -> void
+{
+    /* Relative virtual addresses */
+    symbolTable.setLoadAddress(0);
+
+    const auto export_index = ntHeaders->template build_export_index<
+      false>(dosHeader);
+
+    for (auto&& [name, export_id] : export_index.names())
+    {
+        const auto& exported = export_index.exports()[export_id];
+
+        /* Belongs to another module */
+        if (not exported.rva or not exported.forwarded_name.empty())
+        {
+            continue;
+        }
+
+        symbolTable.add(name,
+                        exported.rva,
+                        0,
+                        SymbolTable::Type::Function,
+                        SymbolTable::Binding::Global);
+    }
+}
+
+auto SymbolTable::FromFile(const std::string& path) -> SymbolTable
+{
+    /* Only the headers and symbol tables are read from the disk */
+    const MappedFile mapped_file(path);
+
+    return FromData(mapped_file.data(), mapped_file.size());
+}
+
+auto SymbolTable::FromData(const byte_t* const data,
+                           const std::size_t size) -> SymbolTable
+{
+    SymbolTable symbol_table;
+
+    if (size >= sizeof(ELF::Elf_Ehdr<std::uint64_t>)
+        and std::memcmp(data,
+                        &ELF::MAGIC_NUMBER,
+                        sizeof(ELF::MAGIC_NUMBER))
+              == 0)
+    {
+        const auto elf_parent_header = view_as<
+          const ELF::Elf_Parent_Ehdr*>(data);
+
+        switch (elf_parent_header->e_ident[ELF::EI_CLASS])
+        {
+            case ELF::ELFCLASS32:
+            {
+                ParseELF<std::uint32_t>(data, size, symbol_table);
+                break;
+            }
+
+            case ELF::ELFCLASS64:
+            {
+                ParseELF<std::uint64_t>(data, size, symbol_table);
+                break;
+            }
+
+            default:
+            {
+                ASURA_EXCEPTION(
+                  "Unknown ELF Class: "
+                  + std::to_string(
+                    elf_parent_header->e_ident[ELF::EI_CLASS]));
+            }
+        }
+    }
+    else if (size >= sizeof(PE::IMAGE::DOS_HEADER)
+             and std::memcmp(data,
+                             &PE::MAGIC_NUMBER,
+                             sizeof(PE::MAGIC_NUMBER))
+                   == 0)
+    {
+        const auto dos_header = view_as<const PE::IMAGE::DOS_HEADER*>(
+          data);
+
+        if (dos_header->e_lfanew
+              + sizeof(PE::IMAGE::NT_HEADERS<std::uint64_t>)
+            > size)
+        {
+            ASURA_EXCEPTION("PE headers out of the file");
+        }
+
+        const auto nt_parent_headers = view_as<
+          const PE::IMAGE::PARENT_NT_HEADERS*>(data
+                                               + dos_header->e_lfanew);
+
+        switch (nt_parent_headers->FileHeader.Machine)
+        {
+            case PE::IMAGE::FILE_MACHINE_I386:
+            {
+                ParsePE(dos_header,
+                        view_as<const PE::IMAGE::NT_HEADERS<
+                          std::uint32_t>*>(nt_parent_headers),
+                        symbol_table);
+                break;
+            }
+
+            case PE::IMAGE::FILE_MACHINE_IA64:
+            case PE::IMAGE::FILE_MACHINE_AMD64:
+            {
+                ParsePE(dos_header,
+                        view_as<const PE::IMAGE::NT_HEADERS<
+                          std::uint64_t>*>(nt_parent_headers),
+                        symbol_table);
+                break;
+            }
+
+            default:
+            {
+                ASURA_EXCEPTION(
+                  "Unknown PE Machine: "
+                  + std::to_string(
+                    nt_parent_headers->FileHeader.Machine));
+            }
+        }
+    }
+
+    symbol_table.finalize();
+
+    return symbol_table;
+}
+
+auto SymbolTable::TypeFromELF(const std::uint8_t info)
+  -> std::optional<Type>
+{
+    switch (info & 0xf)
+    {
+        case ELF::STT_FUNC:
+        {
+            return Type::Function;
+        }
+
+        case ELF::STT_GNU_IFUNC:
+        {
+            return Type::IndirectFunction;
+        }
+
+        case ELF::STT_OBJECT:
+        case ELF::STT_COMMON:
+        {
+            return Type::Object;
+        }
+
+        case ELF::STT_TLS:
+        {
+            return Type::TLS;
+        }
+
+        case ELF::STT_SECTION:
+        case ELF::STT_FILE:
+        {
+            return std::nullopt;
+        }
+
+        default:
+        {
+            return Type::Other;
+        }
+    }
+}
+
+auto SymbolTable::FromViews(std::shared_ptr<const void> storage,
+                            const std::uint64_t loadAddress,
+                            const std::span<const Symbol> symbols,
+                            const std::span<const std::uint32_t> byValue,
+                            const std::string_view names) -> SymbolTable
+{
+    SymbolTable symbol_table;
+
+    symbol_table._load_address = loadAddress;
+    symbol_table._storage      = std::move(storage);
+    symbol_table._symbols      = symbols;
+    symbol_table._by_value     = byValue;
+    symbol_table._names        = names;
+
+    return symbol_table;
+}
+
+auto SymbolTable::loadAddress() const -> std::uint64_t
+{
+    return _load_address;
+}
+
+auto SymbolTable::symbols() const -> std::span<const Symbol>
+{
+    return _symbols;
+}
+
+auto SymbolTable::symbolsByValue() const -> std::span<const std::uint32_t>
+{
+    return _by_value;
+}
+
+auto SymbolTable::names() const -> std::string_view
+{
+    return _names;
+}
+
+auto SymbolTable::name(const Symbol& symbol) const -> std::string_view
+{
+    return _names.data() + symbol.name_offset;
+}
+
+auto SymbolTable::empty() const -> bool
+{
+    return _symbols.empty();
+}
+
+auto SymbolTable::find(const std::string_view name) const
+  -> const Symbol*
+{
+    const auto name_hash = ELF::GNUHash(name);
+
+    auto it = std::lower_bound(_symbols.begin(),
+                               _symbols.end(),
+                               name_hash,
+                               [](const Symbol& symbol,
+                                  const std::uint32_t value)
+                               {
+                                   return symbol.name_hash < value;
+                               });
+
+    for (; it != _symbols.end() and it->name_hash == name_hash; it++)
+    {
+        if (this->name(*it) == name)
+        {
+            return &*it;
+        }
+    }
+
+    return nullptr;
+}
+
+auto SymbolTable::nearest(const std::uint64_t value) const
+  -> const Symbol*
+{
+    /* First symbol after the value */
+    const auto it = std::upper_bound(
+      _by_value.begin(),
+      _by_value.end(),
+      value,
+      [&](const std::uint64_t wanted_value, const std::uint32_t index)
+      {
+          return wanted_value < _symbols[index].value;
+      });
+
+    if (it == _by_value.begin())
+    {
+        return nullptr;
+    }
+
+    /* The first of its aliases is the preferred one */
+    const auto found_value = _symbols[*std::prev(it)].value;
+
+    const auto first = std::lower_bound(
+      _by_value.begin(),
+      it,
+      found_value,
+      [&](const std::uint32_t index, const std::uint64_t wanted_value)
+      {
+          return _symbols[index].value < wanted_value;
+      });
+
+    return &_symbols[*first];
+}
+
+auto SymbolTable::setLoadAddress(const std::uint64_t loadAddress) -> void
+{
+    _load_address = loadAddress;
+}
+
+auto SymbolTable::add(const std::string_view name,
+                      const std::uint64_t value,
+                      const std::uint64_t size,
+                      const Type type,
+                      const Binding binding) -> void
+{
+    if (not _building)
+    {
+        _building = std::make_shared<Storage>();
+    }
+
+    auto& names = _building->names;
+
+    _building->symbols.push_back(
+      { .name_hash   = ELF::GNUHash(name),
+        .name_offset = view_as<std::uint32_t>(names.size()),
+        .value       = value,
+        .size        = size,
+        .type        = type,
+        .binding     = binding });
+
+    names.insert(names.end(), name.begin(), name.end());
+    names.push_back('\0');
+}
+
+auto SymbolTable::finalize() -> void
+{
+    if (not _building)
+    {
+        return;
+    }
+
+    auto& symbols  = _building->symbols;
+    auto& by_value = _building->by_value;
+
+    _names = std::string_view(_building->names.data(),
+                              _building->names.size());
+
+    /**
+     * Same names are then next to each other, the preferred first.
+     * Stable so the ones left equal stay in the order of the file,
+     * finding a name always gives the same symbol.
+     */
+    std::stable_sort(symbols.begin(),
+                     symbols.end(),
+                     [&](const Symbol& lhs, const Symbol& rhs)
+                     {
+                         if (lhs.name_hash != rhs.name_hash)
+                         {
+                             return lhs.name_hash < rhs.name_hash;
+                         }
+
+                         if (lhs.binding != rhs.binding)
+                         {
+                             return lhs.binding < rhs.binding;
+                         }
+
+                         return name(lhs) < name(rhs);
+                     });
+
+    for (std::uint32_t i = 0; i < symbols.size(); i++)
+    {
+        if (symbols[i].type != Type::TLS)
+        {
+            by_value.push_back(i);
+        }
+    }
+
+    /**
+     * Aliases share a value, the preferred binding, then the one with
+     * a size, comes first.
+     */
+    std::stable_sort(by_value.begin(),
+                     by_value.end(),
+                     [&](const std::uint32_t lhs, const std::uint32_t rhs)
+                     {
+                         const auto& lhs_symbol = symbols[lhs];
+                         const auto& rhs_symbol = symbols[rhs];
+
+                         if (lhs_symbol.value != rhs_symbol.value)
+                         {
+                             return lhs_symbol.value < rhs_symbol.value;
+                         }
+
+                         if (lhs_symbol.binding != rhs_symbol.binding)
+                         {
+                             return lhs_symbol.binding
+                                    < rhs_symbol.binding;
+                         }
+
+                         return lhs_symbol.size > rhs_symbol.size;
+                     });
+
+    _symbols  = symbols;
+    _by_value = by_value;
+    _storage  = std::move(_building);
+}
@@ -0,0 +1,119 @@
+#ifndef ASURA_SYMBOLTABLE_H
+#define ASURA_SYMBOLTABLE_H
+
+#include "mappedfile.h"
+
+namespace Asura
+{
+    /**
+     * Symbols of one ELF or PE file, parsed once into flat arrays:
+     * fixed size entries sorted by name hash, their names packed in one
+     * string, and their indexes sorted by value for reverse lookups.
+     * The arrays are only viewed, so they can as well be the ones built
+     * here as the ones of a cache file mapped as is (see SymbolCache).
+     * Values are the ones of the file, the module's load bias has to
+     * be added, see loadAddress().
+     */
+    class SymbolTable
+    {
+      public:
+        enum class Type : std::uint8_t
+        {
+            Other,
+            Object,
+            Function,
+            TLS,
+            /* Its value is a resolver returning the function to use */
+            IndirectFunction
+        };
+
+        /* In order of preference when a name is there more than once */
+        enum class Binding : std::uint8_t
+        {
+            Global,
+            Weak,
+            Local
+        };
+
+        struct Symbol
+        {
+            std::uint32_t name_hash;
+            std::uint32_t name_offset;
+            std::uint64_t value;
+            std::uint64_t size;
+            Type type;
+            Binding binding;
+        };
+
+      public:
+        /* An empty table when the format isn't known */
+        static auto FromFile(const std::string& path) -> SymbolTable;
+        static auto FromData(const byte_t* const data,
+                             const std::size_t size) -> SymbolTable;
+
+        /**
+         * Arrays already sorted like finalize() does, kept alive by the
+         * storage.
+         */
+        static auto FromViews(std::shared_ptr<const void> storage,
+                              const std::uint64_t loadAddress,
+                              const std::span<const Symbol> symbols,
+                              const std::span<const std::uint32_t> byValue,
+                              const std::string_view names)
+          -> SymbolTable;
+
+        /* From an ELF symbol's st_info, none for sections and files */
+        static auto TypeFromELF(const std::uint8_t info)
+          -> std::optional<Type>;
+
+      public:
+        /**
+         * Lowest virtual address the file asks for, the module's lowest
+         * address minus that is what's added to the values.
+         */
+        auto loadAddress() const -> std::uint64_t;
+        auto symbols() const -> std::span<const Symbol>;
+        auto symbolsByValue() const -> std::span<const std::uint32_t>;
+        /* Each name is null terminated */
+        auto names() const -> std::string_view;
+        auto name(const Symbol& symbol) const -> std::string_view;
+        auto empty() const -> bool;
+
+        /* Exact name, globals first */
+        auto find(const std::string_view name) const -> const Symbol*;
+
+        /* Symbol with the highest value below or equal to the one given */
+        auto nearest(const std::uint64_t value) const -> const Symbol*;
+
+      public:
+        auto setLoadAddress(const std::uint64_t loadAddress) -> void;
+        auto add(const std::string_view name,
+                 const std::uint64_t value,
+                 const std::uint64_t size,
+                 const Type type,
+                 const Binding binding) -> void;
+        /* Sorts what was added, before any lookup */
+        auto finalize() -> void;
+
+      private:
+        struct Storage
+        {
+            std::vector<Symbol> symbols;
+            std::vector<std::uint32_t> by_value;
+            std::vector<char> names;
+        };
+
+      private:
+        std::uint64_t _load_address {};
+        /* Filled by add() until finalize() */
+        std::shared_ptr<Storage> _building;
+        /* What the views point to, shared between the copies */
+        std::shared_ptr<const void> _storage;
+        std::span<const Symbol> _symbols;
+        /* Indexes of _symbols by value, without TLS offsets */
+        std::span<const std::uint32_t> _by_value;
+        std::string_view _names;
+    };
+}
+
+#endif
@@ -24,6 +24,149 @@ auto rogue() -> void
     std::cout << "Hehe" << std::endl;
 }
 
+using shared_values_t = SharedCircularBuffer<std::uint64_t, 0x10>;
+
+/* Called by the agent inside the child, on its side of the region */
+auto shared_sum(const shared_values_t* values) -> std::uint64_t
+{
+    std::uint64_t cursor = 0, value, sum = 0;
+
+    while (values->read(cursor, value))
+    {
+        sum += value;
+    }
+
+    return sum;
+}
+
+/**
+ * A 64 bits PE file made of its headers and an export directory, laid
+ * out like once mapped so RVAs are file offsets.
+ * Exports are given sorted by name, with where they're forwarded to,
+ * the ones that aren't are functions at 0x1000 + 0x10 * their index.
+ */
+auto write_pe_exports(
+  const std::string& path,
+  const std::vector<std::pair<std::string, std::string>>& exports) -> void
+{
+    using namespace PE::IMAGE;
+
+    constexpr std::uint32_t export_rva = 0x200;
+
+    const auto count        = view_as<std::uint32_t>(exports.size());
+    const auto funcs_rva    = view_as<std::uint32_t>(
+      export_rva + sizeof(EXPORT_DIRECTORY));
+    const auto names_rva    = funcs_rva + count * 4;
+    const auto ordinals_rva = names_rva + count * 4;
+    const auto strings_rva  = ordinals_rva + count * 2;
+
+    std::vector<std::uint32_t> funcs, names;
+    std::vector<std::uint16_t> ordinals;
+    std::string strings;
+
+    const auto add_string = [&](const std::string& string)
+    {
+        const auto rva = view_as<std::uint32_t>(strings_rva
+                                                + strings.size());
+        strings += string;
+        strings += '\0';
+
+        return rva;
+    };
+
+    for (std::uint32_t i = 0; i < count; i++)
+    {
+        const auto& [name, forwarded_name] = exports[i];
+
+        names.push_back(add_string(name));
+        ordinals.push_back(view_as<std::uint16_t>(i));
+        funcs.push_back(forwarded_name.empty() ?
+                          0x1000 + 0x10 * i :
+                          add_string(forwarded_name));
+    }
+
+    DOS_HEADER dos_header {};
+    dos_header.e_magic  = PE::MAGIC_NUMBER;
+    dos_header.e_lfanew = sizeof(DOS_HEADER);
+
+    NT_HEADERS<std::uint64_t> nt_headers {};
+    nt_headers.Signature                    = 0x4550;
+    nt_headers.FileHeader.Machine           = FILE_MACHINE_AMD64;
+    nt_headers.FileHeader.SizeOfOptionalHeader = sizeof(
+      OPTIONAL_HEADER<std::uint64_t>);
+    nt_headers.OptionalHeader.Magic = 0x20b;
+    nt_headers.OptionalHeader.DataDirectory[DIRECTORY_ENTRY_EXPORT] = {
+        export_rva,
+        view_as<std::uint32_t>(strings_rva + strings.size() - export_rva)
+    };
+
+    EXPORT_DIRECTORY export_directory {};
+    export_directory.Base                  = 1;
+    export_directory.NumberOfFunctions     = count;
+    export_directory.NumberOfNames         = count;
+    export_directory.AddressOfFunctions    = funcs_rva;
+    export_directory.AddressOfNames        = names_rva;
+    export_directory.AddressOfNameOrdinals = ordinals_rva;
+
+    bytes_t image(strings_rva + strings.size());
+
+    const auto write_at = [&](const std::size_t offset,
+                              const void* data,
+                              const std::size_t size)
+    {
+        std::memcpy(image.data() + offset, data, size);
+    };
+
+    write_at(0, &dos_header, sizeof(dos_header));
+    write_at(dos_header.e_lfanew, &nt_headers, sizeof(nt_headers));
+    write_at(export_rva, &export_directory, sizeof(export_directory));
+    write_at(funcs_rva, funcs.data(), count * 4);
+    write_at(names_rva, names.data(), count * 4);
+    write_at(ordinals_rva, ordinals.data(), count * 2);
+    write_at(strings_rva, strings.data(), strings.size());
+
+    std::ofstream(path, std::ios::binary)
+      .write(view_as<const char*>(image.data()),
+             view_as<std::streamsize>(image.size()));
+}
+
+#ifndef WINDOWS
+/**
+ * The whole file mapped readable and executable, like a loader maps the
+ * code of a module, unmapped with the last copy of the pointer.
+ */
+auto map_executable(const std::string& path) -> std::shared_ptr<byte_t>
+{
+    const auto size = std::filesystem::file_size(path);
+    const auto fd   = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        ASURA_EXCEPTION("Couldn't open " + path);
+    }
+
+    const auto data = ::mmap(nullptr,
+                             size,
+                             PROT_READ | PROT_EXEC,
+                             MAP_PRIVATE,
+                             fd,
+                             0);
+
+    close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        ASURA_EXCEPTION("Couldn't map " + path);
+    }
+
+    return std::shared_ptr<byte_t>(view_as<byte_t*>(data),
+                                   [size](byte_t* mapped)
+                                   {
+                                       ::munmap(mapped, size);
+                                   });
+}
+#endif
+
 auto Asura::Test::run() -> void
 {
     ConsoleOutput("Starting test") << std::endl;
@@ -442,6 +585,231 @@ auto Asura::Test::run() -> void
           << std::endl;
     }
 
+    {
+        auto changed_bytes = random_bytes;
+        changed_bytes[0x10]++;
+        changed_bytes[0x11]++;
+        changed_bytes[0x1337]++;
+        changed_bytes.back()++;
+
+        Snapshot::changes_t changes;
+        Snapshot::Diff(random_bytes.data(),
+                       changed_bytes.data(),
+                       random_bytes.size(),
+                       0x0,
+                       changes);
+
+        if (changes.size() == 3 and changes[0].address == 0x10
+            and changes[0].size == 2 and changes[1].address == 0x1337
+            and changes[2].address == random_bytes.size() - 1)
+        {
+            ConsoleOutput("Passed snapshot diff") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass snapshot diff test") << std::endl;
+        }
+    }
+
+#if not defined(WINDOWS) and defined(__x86_64__)
+    try
+    {
+        Agent agent;
+
+        const auto child_pid = fork();
+
+        if (child_pid == 0)
+        {
+            agent.serve();
+            _exit(0);
+        }
+
+        const auto alloc_ticket = agent.allocArea(
+          0,
+          0x2000,
+          MemoryArea::ProtectionFlags::RW);
+
+        const auto area = agent.result(alloc_ticket);
+
+        /* Pipelined, only waiting for the last one */
+        const auto protect_ticket = agent.protectMemoryArea(
+          area,
+          0x1000,
+          MemoryArea::ProtectionFlags::R);
+        const auto getpid_ticket = agent.pushSyscall(SYS_getpid);
+        const auto free_ticket   = agent.freeArea(area, 0x2000);
+
+        const auto freed = agent.result(free_ticket);
+
+        agent.stop();
+        waitpid(child_pid, nullptr, 0);
+
+        if (freed == 0 and agent.result(protect_ticket) == 0
+            and agent.result(getpid_ticket)
+                  == view_as<std::uint64_t>(child_pid))
+        {
+            ConsoleOutput("Passed agent") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass agent test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        ConsoleOutput(e.msg()) << std::endl;
+    }
+
+    try
+    {
+        Agent agent;
+        SharedRegion region(sizeof(shared_values_t));
+
+        const auto child_pid = fork();
+
+        if (child_pid == 0)
+        {
+            agent.serve();
+            _exit(0);
+        }
+
+        const auto remote_values = region.mapInto(agent,
+                                                  ProcessBase(child_pid));
+
+        /* Overwrites the first ones, only the last 0x10 are summed */
+        std::uint64_t expected_sum = 0;
+
+        for (std::uint64_t i = 0; i < 0x20; i++)
+        {
+            region.as<shared_values_t>()->push(i);
+
+            if (i >= 0x10)
+            {
+                expected_sum += i;
+            }
+        }
+
+        const auto sum = agent.result(
+          agent.pushCall(view_as<std::uintptr_t>(&shared_sum),
+                         { remote_values, 0, 0, 0, 0, 0 }));
+
+        region.unmapFrom(agent);
+        agent.stop();
+        waitpid(child_pid, nullptr, 0);
+
+        if (sum == expected_sum)
+        {
+            ConsoleOutput("Passed shared region") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass shared region test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        ConsoleOutput(e.msg()) << std::endl;
+    }
+
+    {
+        const auto process      = Process::self();
+        const auto& index       = process.moduleIndex();
+        const auto libc_address = view_as<std::uintptr_t>(&std::printf);
+
+        ModuleIndex self_index;
+        self_index.updateSelf();
+
+        const auto module_id      = index.search(libc_address);
+        const auto self_module_id = self_index.search(libc_address);
+
+        /* A copy must still find its modules once the original is gone */
+        auto original_index = std::make_unique<ModuleIndex>(self_index);
+        const auto copied_index = *original_index;
+        original_index.reset();
+
+        if (module_id != ModuleIndex::INVALID_ID
+            and self_module_id != ModuleIndex::INVALID_ID
+            and index.find(index.module(module_id).name) == module_id
+            and index.module(module_id).name
+                  == self_index.module(self_module_id).name
+            and copied_index.find(self_index.module(self_module_id).name)
+                  == self_module_id
+            and not self_index.updateSelf())
+        {
+            ConsoleOutput("Passed module index") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass module index test") << std::endl;
+        }
+    }
+
+    try
+    {
+        ModuleIndex self_index;
+        self_index.updateSelf();
+
+        const auto child_pid = fork();
+
+        if (child_pid == 0)
+        {
+            pause();
+            _exit(0);
+        }
+
+        Process child(child_pid);
+        child.refreshModules();
+
+        const auto& child_index = child.moduleIndex();
+
+        /* Only the modules both know, the vdso isn't a file mapping */
+        const auto names_in_order = [](const ModuleIndex& moduleIndex,
+                                       const ModuleIndex& otherIndex)
+        {
+            std::vector<std::string> names;
+
+            for (const auto module_id : moduleIndex.loadOrder())
+            {
+                const auto& name = moduleIndex.module(module_id).name;
+
+                if (otherIndex.findByName(name) != ModuleIndex::INVALID_ID)
+                {
+                    names.push_back(name);
+                }
+            }
+
+            return names;
+        };
+
+        const auto child_names = names_in_order(child_index, self_index);
+        const auto resolved    = child.symbolResolver().resolve(
+          child_index,
+          std::vector<std::string> { "printf" });
+
+        kill(child_pid, SIGKILL);
+        waitpid(child_pid, nullptr, 0);
+
+        if (not child_names.empty()
+            and child_names == names_in_order(self_index, child_index)
+            and child_index.module(child_index.loadOrder().front()).path
+                  == std::filesystem::read_symlink("/proc/self/exe")
+            and resolved[0].address
+                  == view_as<std::uintptr_t>(dlsym(RTLD_DEFAULT, "printf")))
+        {
+            ConsoleOutput("Passed module load order") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass module load order test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
     Timer timer {};
 
     auto aligned_memory = align_alloc<data_t>(size_of_random * 8,
@@ -775,6 +1143,2149 @@ auto Asura::Test::run() -> void
         std::cout << e.msg() << std::endl;
     }
 
+    try
+    {
+        /* "print" is only a part of many names, it mustn't match */
+        const auto [mod_addr, symbol_addr] = OSUtils::
+          FindExportedFunctionRunTime<true>("libc.so.6", "printf");
+        const auto [mod_addr2, symbol_addr2] = OSUtils::
+          FindExportedFunctionRunTime<false>("libc.so.6", "printf");
+        const auto [mod_addr3, symbol_addr3] = OSUtils::
+          FindExportedFunctionRunTime<true>("libc.so.6", "print");
+
+        if (symbol_addr == view_as<std::uintptr_t>(&printf)
+            and symbol_addr2 == symbol_addr and symbol_addr3 == 0)
+        {
+            ConsoleOutput("Passed symbol hash lookup") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass symbol hash lookup test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+
+#ifndef WINDOWS
+    try
+    {
+        auto process = Process::self();
+        process.refreshModules();
+
+        const auto libc_path = process.moduleIndex()
+                                 .module(process.moduleIndex().find(
+                                   "libc.so.6"))
+                                 .path;
+
+        const auto libc_area_count = [&]()
+        {
+            process.mmap().refresh();
+
+            std::size_t area_count = 0;
+
+            for (const auto area : process.mmap().areaTable())
+            {
+                if (area.name() == libc_path)
+                {
+                    area_count++;
+                }
+            }
+
+            return area_count;
+        };
+
+        const auto area_count_before = libc_area_count();
+
+        /* Shared while held, unmapped after */
+        bool is_shared;
+
+        {
+            const auto mapped_file = OSUtils::MapFile(libc_path);
+            is_shared = OSUtils::MapFile(libc_path) == mapped_file
+                        and libc_area_count() == area_count_before + 1;
+        }
+
+        const auto [mod_addr, symbol_addr] = OSUtils::
+          FindExportedFunctionRunTime<false>("libc.so.6", "printf");
+
+        const auto area_count_after = libc_area_count();
+
+        process.refreshModules();
+
+        const auto resolved = process.resolveSymbols("libc.so.6",
+                                                     { "printf" });
+
+        if (is_shared and area_count_after == area_count_before
+            and symbol_addr == view_as<std::uintptr_t>(&printf)
+            and resolved[0].address == view_as<std::uintptr_t>(&printf))
+        {
+            ConsoleOutput("Passed mapped files") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass mapped files test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        /**
+         * Mapped by hand like Wine maps its PE modules, the dynamic
+         * linker doesn't know about it.
+         */
+        const std::string mapped_module_path = "/tmp/asura_mapped_module";
+
+        std::filesystem::copy_file(
+          "/proc/self/exe",
+          mapped_module_path,
+          std::filesystem::copy_options::overwrite_existing);
+
+        const auto mapped_module = map_executable(mapped_module_path);
+
+        const auto found_module = OSUtils::FindSelfModule(
+          "asura_mapped_module");
+
+        if (found_module
+            and found_module->begin
+                  == view_as<std::uintptr_t>(mapped_module.get()))
+        {
+            ConsoleOutput("Passed mapped self module") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass mapped self module test")
+              << std::endl;
+        }
+
+        std::filesystem::remove(mapped_module_path);
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+    try
+    {
+        auto process = Process::self();
+        process.refreshModules();
+
+        /* Only mapped to be read, it mustn't be taken for libc */
+        const MappedFile libc_data(
+          process.moduleIndex()
+            .module(process.moduleIndex().find("libc.so.6"))
+            .path);
+
+        process.mmap().refresh();
+        process.refreshModules();
+
+        /**
+         * realpath and glob are there twice, the default version must
+         * be the one the dynamic linker gives.
+         */
+        const auto resolved = process.resolveSymbols(
+          "libc.so.6",
+          { "printf", "malloc", "asura_does_not_exist", "realpath", "glob" });
+
+        const auto nearest = process.nearestSymbol(
+          view_as<std::uintptr_t>(&malloc) + 1);
+
+        if (resolved[0].address == view_as<std::uintptr_t>(&printf)
+            and resolved[1].address == view_as<std::uintptr_t>(&malloc)
+            and resolved[2].module_id == ModuleIndex::INVALID_ID
+            and resolved[3].address
+                  == view_as<std::uintptr_t>(dlsym(RTLD_DEFAULT, "realpath"))
+            and resolved[4].address
+                  == view_as<std::uintptr_t>(dlsym(RTLD_DEFAULT, "glob"))
+            and nearest
+            and nearest->address == view_as<std::uintptr_t>(&malloc)
+            and nearest->offset == 1)
+        {
+            ConsoleOutput("Passed symbol resolver") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass symbol resolver test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+
+    try
+    {
+        const auto cache_directory = std::filesystem::temp_directory_path()
+                                     / "asura_test_symbols";
+
+        std::filesystem::remove_all(cache_directory);
+
+        auto process = Process::self();
+        process.refreshModules();
+
+        const auto& libc = process.moduleIndex().module(
+          process.moduleIndex().find("libc.so.6"));
+
+        const SymbolCache symbol_cache(cache_directory);
+
+        const auto key = SymbolCache::KeyOf(MappedFile(libc.path));
+
+        /* Parsed and stored, then mapped back */
+        const auto parsed_table = symbol_cache.get(libc.path);
+        const auto cached_table = symbol_cache.load(key);
+
+        const auto is_cached = cached_table
+                               and cached_table->symbols().size()
+                                     == parsed_table.symbols().size()
+                               and cached_table->find("printf")
+                               and cached_table->find("printf")->value
+                                     == parsed_table.find("printf")->value;
+
+        const auto cache_path = std::filesystem::directory_iterator(
+                                  cache_directory)
+                                  ->path();
+
+        /* Rejected once edited, then parsed and stored again */
+        const auto is_rebuilt_after = [&](const std::size_t offset)
+        {
+            {
+                std::fstream cache_file(cache_path,
+                                        std::ios::binary | std::ios::in
+                                          | std::ios::out);
+
+                const std::uint32_t value = 0xFFFFFFFF;
+
+                cache_file.seekp(view_as<std::streamoff>(offset));
+                cache_file.write(view_as<const char*>(&value),
+                                 sizeof(value));
+            }
+
+            const auto is_rejected = not symbol_cache.load(key);
+            symbol_cache.get(libc.path);
+
+            return is_rejected and symbol_cache.load(key).has_value();
+        };
+
+        /* An index past the symbols, then a name past the names */
+        const auto is_rebuilt =
+          is_rebuilt_after(sizeof(SymbolCache::Header)
+                           + parsed_table.symbols().size_bytes())
+          and is_rebuilt_after(sizeof(SymbolCache::Header)
+                               + offsetof(SymbolTable::Symbol,
+                                          name_offset));
+
+        if (is_cached and is_rebuilt)
+        {
+            ConsoleOutput("Passed symbol cache") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass symbol cache test") << std::endl;
+        }
+
+        std::filesystem::remove_all(cache_directory);
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+
+    try
+    {
+        auto process = Process::self();
+        process.refreshModules();
+
+        const auto resolved = process.resolveSymbolsFromMemory(
+          "libc.so.6",
+          { "printf", "malloc", "asura_does_not_exist" });
+
+        if (resolved[0].address == view_as<std::uintptr_t>(&printf)
+            and resolved[1].address == view_as<std::uintptr_t>(&malloc)
+            and resolved[2].address == 0)
+        {
+            ConsoleOutput("Passed remote symbol resolver") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass remote symbol resolver test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+
+#if not defined(WINDOWS) and defined(__x86_64__)
+    try
+    {
+        /**
+         * From a child this time, sharing our mappings: a library with
+         * only a SysV hash table and an indirect function, and two PE
+         * files mapped like Wine would, one forwarding to the other.
+         */
+        const std::string library_path = "/tmp/asura_sysv_library";
+
+        std::ofstream(library_path + ".c")
+          << "int asura_sysv_value(void) { return 1; }\n"
+             "int asura_indirect_target(void) { return 2; }\n"
+             "void* asura_indirect_resolver(void)\n"
+             "{ return (void*)&asura_indirect_target; }\n"
+             "int asura_indirect(void)\n"
+             "  __attribute__((ifunc(\"asura_indirect_resolver\")));\n";
+
+        if (std::system(("cc -shared -fPIC -Wl,--hash-style=sysv -o "
+                         + library_path + ".so " + library_path
+                         + ".c 2>/dev/null")
+                          .c_str())
+            != 0)
+        {
+            ASURA_EXCEPTION("Couldn't build the SysV hash library");
+        }
+
+        const auto library = dlopen((library_path + ".so").c_str(),
+                                    RTLD_NOW);
+
+        if (not library)
+        {
+            ASURA_EXCEPTION("Couldn't load the SysV hash library");
+        }
+
+        write_pe_exports("/tmp/asura_exports.dll",
+                         { { "Direct", "" },
+                           { "Forwarded", "ASURA_TARGET.Target" } });
+        write_pe_exports("/tmp/asura_target.dll",
+                         { { "Other", "" }, { "Target", "" } });
+
+        const auto exports_file = map_executable("/tmp/asura_exports.dll");
+        const auto target_file  = map_executable("/tmp/asura_target.dll");
+
+        const auto child_pid = fork();
+
+        if (child_pid == 0)
+        {
+            pause();
+            _exit(0);
+        }
+
+        Process child(child_pid);
+        child.refreshModules();
+
+        const auto libc_resolved = child.resolveSymbolsFromMemory(
+          "libc.so.6",
+          { "printf", "strlen" });
+
+        const auto library_resolved = child.resolveSymbolsFromMemory(
+          "asura_sysv_library.so",
+          { "asura_sysv_value",
+            "asura_indirect",
+            "asura_indirect_resolver",
+            "asura_does_not_exist" });
+
+        const auto pe_resolved = child.resolveSymbolsFromMemory(
+          "asura_exports.dll",
+          { "Direct", "Forwarded", "2" });
+
+        kill(child_pid, SIGKILL);
+        waitpid(child_pid, nullptr, 0);
+
+        const auto exports_base = view_as<std::uintptr_t>(
+          exports_file.get());
+        const auto target_base = view_as<std::uintptr_t>(
+          target_file.get());
+
+        const auto is_libc_resolved =
+          libc_resolved[0].address == view_as<std::uintptr_t>(&printf)
+          and libc_resolved[0].type == SymbolTable::Type::Function
+          and libc_resolved[1].type
+                == SymbolTable::Type::IndirectFunction;
+
+        /* The resolver, not what dlsym gives after calling it */
+        const auto is_library_resolved =
+          library_resolved[0].address
+            == view_as<std::uintptr_t>(dlsym(library, "asura_sysv_value"))
+          and library_resolved[1].type
+                == SymbolTable::Type::IndirectFunction
+          and library_resolved[1].address == library_resolved[2].address
+          and library_resolved[1].address
+                != view_as<std::uintptr_t>(dlsym(library, "asura_indirect"))
+          and library_resolved[3].address == 0;
+
+        const auto is_pe_resolved = pe_resolved[0].address
+                                      == exports_base + 0x1000
+                                    and pe_resolved[1].address
+                                          == target_base + 0x1010
+                                    and pe_resolved[2].address
+                                          == pe_resolved[1].address;
+
+        dlclose(library);
+
+        if (is_libc_resolved and is_library_resolved and is_pe_resolved)
+        {
+            ConsoleOutput("Passed remote symbol resolver from a child")
+              << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass remote symbol resolver from a "
+                          "child test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        const auto page_size = MemoryUtils::GetPageSize();
+
+        /**
+         * Inaccessible pages keep our areas apart so the kernel never
+         * merges them together:
+         * [-][a a][-][b b][- -][c][-][d][-]
+         */
+        const auto pages = view_as<byte_t*>(::mmap(nullptr,
+                                                   page_size * 12,
+                                                   PROT_NONE,
+                                                   MAP_PRIVATE
+                                                     | MAP_ANONYMOUS,
+                                                   -1,
+                                                   0));
+
+        if (pages == MAP_FAILED)
+        {
+            ASURA_EXCEPTION("Couldn't map the pages");
+        }
+
+        const auto page = [&](const std::size_t index)
+        {
+            return pages + page_size * index;
+        };
+
+        ::mprotect(page(1), page_size * 2, PROT_READ | PROT_WRITE);
+        ::mprotect(page(4), page_size * 2, PROT_READ | PROT_WRITE);
+        ::mprotect(page(8), page_size, PROT_READ | PROT_WRITE);
+        ::mprotect(page(10), page_size, PROT_READ | PROT_WRITE);
+
+        ProcessMemoryMap memory_map(ProcessBase::self());
+
+        const auto area_a = memory_map.search(page(1));
+        const auto area_b = memory_map.search(page(4));
+        const auto area_c = memory_map.search(page(8));
+        const auto area_d = memory_map.search(page(10));
+
+        std::size_t notified_count = 0;
+        std::size_t once_count     = 0;
+        ProcessMemoryMap::ChangeSet notified;
+
+        memory_map.subscribe(
+          [&](const ProcessMemoryMap&,
+              const ProcessMemoryMap::ChangeSet& changes)
+          {
+              notified_count++;
+              notified = changes;
+          });
+
+        std::size_t once_id = 0;
+
+        once_id = memory_map.subscribe(
+          [&](const ProcessMemoryMap&, const ProcessMemoryMap::ChangeSet&)
+          {
+              once_count++;
+              memory_map.unsubscribe(once_id);
+          });
+
+        /**
+         * Map e, protect a, grow b over the page after it and unmap d.
+         * e first, otherwise it could land where d was.
+         */
+        const auto page_e = view_as<byte_t*>(::mmap(nullptr,
+                                                    page_size,
+                                                    PROT_READ | PROT_EXEC,
+                                                    MAP_PRIVATE
+                                                      | MAP_ANONYMOUS,
+                                                    -1,
+                                                    0));
+
+        ::mprotect(page(1), page_size * 2, PROT_READ);
+        ::mprotect(page(6), page_size, PROT_READ | PROT_WRITE);
+        ::munmap(page(10), page_size);
+
+        memory_map.refresh();
+
+        const auto contains = [](const auto& areas, const auto& area)
+        {
+            return std::ranges::find(areas, area) != areas.end();
+        };
+
+        const auto area_e = memory_map.search(page_e);
+
+        const auto is_protected = contains(notified.protection_changed,
+                                           area_a)
+                                  and area_a->protectionFlags()
+                                          .cachedValue()
+                                        == MemoryArea::ProtectionFlags::R;
+
+        const auto is_resized = contains(notified.resized, area_b)
+                                and area_b->size() == page_size * 3;
+
+        const auto is_removed = contains(notified.removed, area_d)
+                                and not memory_map.search(page(10));
+
+        const auto is_added = area_e and contains(notified.added, area_e);
+
+        /* Same objects for the areas still there, c didn't change */
+        const auto is_kept = memory_map.search(page(1)) == area_a
+                             and memory_map.search(page(4)) == area_b
+                             and memory_map.search(page(8)) == area_c
+                             and not contains(notified.resized, area_c)
+                             and not contains(notified.protection_changed,
+                                              area_c);
+
+        const auto is_notified = notified_count == 1 and once_count == 1
+                                 and notified.added
+                                       == memory_map.lastChanges().added;
+
+        ::munmap(page_e, page_size);
+        memory_map.refresh();
+
+        const auto is_unsubscribed = notified_count == 2 and once_count == 1
+                                     and contains(notified.removed, area_e);
+
+        ::munmap(pages, page_size * 12);
+
+        if (is_protected and is_resized and is_removed and is_added
+            and is_kept and is_notified and is_unsubscribed)
+        {
+            ConsoleOutput("Passed memory map changes") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass memory map changes test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        using range_t = std::pair<std::uintptr_t, std::uintptr_t>;
+
+        ProcessMemoryMap memory_map;
+        std::vector<range_t> ranges;
+
+        /**
+         * Reading the maps can itself grow the heap, retry until our
+         * copy and the one of the memory map agree.
+         */
+        for (int attempt = 0; attempt < 10; attempt++)
+        {
+            memory_map = ProcessMemoryMap(ProcessBase::self());
+
+            std::ifstream maps_file("/proc/self/maps");
+            std::string line;
+
+            ranges.clear();
+
+            while (std::getline(maps_file, line))
+            {
+                range_t range;
+                char dash {};
+
+                std::istringstream(line) >> std::hex >> range.first >> dash
+                  >> range.second;
+
+                ranges.push_back(range);
+            }
+
+            const auto& table = memory_map.areaTable();
+
+            bool is_same = table.size() == ranges.size();
+
+            for (std::size_t i = 0; is_same and i < ranges.size(); i++)
+            {
+                is_same = table.begins()[i] == ranges[i].first
+                          and table.ends()[i] == ranges[i].second;
+            }
+
+            if (is_same)
+            {
+                break;
+            }
+        }
+
+        std::vector<range_t> merged_ranges;
+
+        for (const auto& range : ranges)
+        {
+            if (not merged_ranges.empty()
+                and merged_ranges.back().second == range.first)
+            {
+                merged_ranges.back().second = range.second;
+            }
+            else
+            {
+                merged_ranges.push_back(range);
+            }
+        }
+
+        const auto linear_search = [](const std::vector<range_t>& ranges,
+                                      const std::uintptr_t address)
+        {
+            for (std::size_t i = 0; i < ranges.size(); i++)
+            {
+                if (address >= ranges[i].first
+                    and address < ranges[i].second)
+                {
+                    return i;
+                }
+            }
+
+            return ProcessMemoryMap::INVALID_INDEX;
+        };
+
+        /* Boundaries, middle, last byte and the gaps around each area */
+        std::vector<std::uintptr_t> addresses {
+            0,
+            std::numeric_limits<std::uintptr_t>::max()
+        };
+
+        for (const auto& [begin, end] : ranges)
+        {
+            addresses.insert(addresses.end(),
+                             { begin - 1,
+                               begin,
+                               begin + (end - begin) / 2,
+                               end - 1,
+                               end });
+        }
+
+        bool is_found = true;
+
+        for (const auto address : addresses)
+        {
+            is_found = is_found
+                       and memory_map.searchIndex(address)
+                             == linear_search(ranges, address)
+                       and memory_map.searchMergedIndex(address)
+                             == linear_search(merged_ranges, address);
+        }
+
+        const auto& merged_areas = memory_map.mergedAreas();
+
+        bool is_merged = merged_areas.size() == merged_ranges.size();
+
+        for (std::size_t i = 0; is_merged and i < merged_ranges.size(); i++)
+        {
+            is_merged = merged_areas[i].begin == merged_ranges[i].first
+                        and merged_areas[i].end == merged_ranges[i].second;
+        }
+
+        if (is_found and is_merged)
+        {
+            ConsoleOutput("Passed memory map search") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass memory map search test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+    try
+    {
+        const auto self_pid = Process::self().id();
+        const auto [self_proc_name, result] = Process::name(self_pid);
+
+        ProcessIndex process_index;
+
+        const auto found = process_index.find(
+          std::vector<std::string> { self_proc_name,
+                                     "asura_does_not_exist" });
+
+        if (result and found[0] != ProcessIndex::INVALID_PID
+            and process_index.exe(found[0]) == self_proc_name
+            and found[1] == ProcessIndex::INVALID_PID
+            and process_index.isAlive(self_pid))
+        {
+            ConsoleOutput("Passed process index") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass process index test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+
+    try
+    {
+        auto& fragment_manager = DetourX86::FragmentManager::get();
+
+        std::vector<DetourX86::HandleFragment_t> fragments;
+        auto in_reach = true;
+
+        for (std::size_t i = 0; i < 2000; i++)
+        {
+            const auto fragment = fragment_manager.newFragment(
+              { 0x90, 0xC3 },
+              view_as<ptr_t>(&printf));
+
+            in_reach = in_reach
+                       and DetourX86::IsInRel32Reach(
+                         view_as<std::uintptr_t>(&printf),
+                         fragment->address,
+                         fragment->address
+                           + DetourX86::FragmentManager::FRAGMENT_SIZE);
+
+            fragments.push_back(fragment);
+        }
+
+        const auto area_count = fragment_manager.areaCount();
+
+        for (const auto& fragment : fragments)
+        {
+            fragment_manager.wipeFragment(fragment);
+        }
+
+        const auto fragment = fragment_manager.newFragment(
+          { 0xC3 },
+          view_as<ptr_t>(&printf));
+
+        view_as<void (*)()>(fragment->address)();
+
+        if (in_reach and area_count == 2
+            and fragment_manager.areaCount() == area_count)
+        {
+            ConsoleOutput("Passed fragment manager") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass fragment manager test") << std::endl;
+        }
+
+        fragment_manager.wipeFragment(fragment);
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+
+#ifndef WINDOWS
+    try
+    {
+        auto process = Process::self();
+
+        std::string libc_path;
+
+        for (const auto& area : process.mmap().areas())
+        {
+            if (area->name().find("libc.so") != std::string::npos)
+            {
+                libc_path = area->name();
+                break;
+            }
+        }
+
+        /**
+         * objdump's linear sweep of libc's .text, every instruction is
+         * decoded again and compared with it, its length and what's
+         * relative to its address.
+         */
+        const auto pipe = popen(("objdump -d -z -w --section=.text "
+                                 + libc_path + " 2>/dev/null")
+                                  .c_str(),
+                                "r");
+
+        if (not pipe)
+        {
+            ASURA_EXCEPTION("Couldn't run objdump");
+        }
+
+        struct ListedInstruction
+        {
+            std::uintptr_t address;
+            std::size_t offset;
+            std::size_t length;
+            std::string text;
+        };
+
+        bytes_t text_section;
+        std::vector<ListedInstruction> listed_instructions;
+        char line_buffer[4096];
+
+        while (std::fgets(line_buffer, sizeof(line_buffer), pipe))
+        {
+            const std::string line(line_buffer);
+
+            /* "  2a3f0:\t66 2e 0f 1f 84 00 \tcs nopw ..." */
+            const auto bytes_begin = line.find(":\t");
+            const auto bytes_end   = line.find('\t', bytes_begin + 2);
+
+            if (line.empty() or line[0] != ' '
+                or bytes_begin == std::string::npos
+                or bytes_end == std::string::npos)
+            {
+                continue;
+            }
+
+            ListedInstruction listed_instruction {
+                std::stoull(line.substr(0, bytes_begin), nullptr, 16),
+                text_section.size(),
+                0,
+                line.substr(bytes_end + 1)
+            };
+
+            std::istringstream bytes_stream(
+              line.substr(bytes_begin + 2, bytes_end - bytes_begin - 2));
+            std::string byte_string;
+
+            while (bytes_stream >> byte_string)
+            {
+                text_section.push_back(
+                  view_as<byte_t>(std::stoul(byte_string, nullptr, 16)));
+            }
+
+            listed_instruction.length = text_section.size()
+                                        - listed_instruction.offset;
+
+            listed_instructions.push_back(listed_instruction);
+        }
+
+        pclose(pipe);
+
+#ifdef ENVIRONMENT32
+        constexpr auto decoder_mode = DecoderX86::Mode::BITS32;
+#else
+        constexpr auto decoder_mode = DecoderX86::Mode::BITS64;
+#endif
+        std::size_t mismatches = 0;
+
+        for (const auto& listed_instruction : listed_instructions)
+        {
+            if (listed_instruction.text.find("(bad)") != std::string::npos)
+            {
+                continue;
+            }
+
+            const auto code = text_section.data()
+                              + listed_instruction.offset;
+
+            const auto instruction = DecoderX86::Decode(
+              code,
+              text_section.size() - listed_instruction.offset,
+              decoder_mode);
+
+            /* objdump prints the target right after the operand */
+            const auto target_position = listed_instruction.text.find(
+              (instruction.flags
+               & DecoderX86::Instruction::RIP_RELATIVE) ?
+                "# " :
+                " ");
+
+            const auto is_relative_listed = listed_instruction.text.find(
+                                              "(%rip)")
+                                            != std::string::npos;
+
+            if (not instruction.isValid()
+                or instruction.length != listed_instruction.length
+                or DecoderX86::Length(code,
+                                      text_section.size()
+                                        - listed_instruction.offset,
+                                      decoder_mode)
+                     != instruction.length
+                or view_as<bool>(instruction.flags
+                                 & DecoderX86::Instruction::RIP_RELATIVE)
+                     != is_relative_listed)
+            {
+                mismatches++;
+                continue;
+            }
+
+            if (instruction.isRelative())
+            {
+                const auto target_string = listed_instruction.text.substr(
+                  listed_instruction.text.find_first_not_of(
+                    "# ",
+                    target_position));
+
+                if (std::stoull(target_string, nullptr, 16)
+                    != instruction.relativeTarget(
+                      code,
+                      listed_instruction.address))
+                {
+                    mismatches++;
+                }
+            }
+        }
+
+        std::size_t decoded_instructions = 0;
+
+        timer.start();
+
+        for (std::size_t offset = 0; offset < text_section.size();
+             decoded_instructions++)
+        {
+            offset += DecoderX86::Decode(text_section.data() + offset,
+                                         text_section.size() - offset,
+                                         decoder_mode)
+                        .length;
+        }
+
+        timer.end();
+
+        ConsoleOutput("x86 decoder: ")
+          << std::dec << decoded_instructions << " instructions in "
+          << timer.difference() << " nanoseconds" << std::endl;
+
+        std::size_t length_instructions = 0;
+
+        timer.start();
+
+        for (std::size_t offset = 0; offset < text_section.size();
+             length_instructions++)
+        {
+            offset += std::max(
+              DecoderX86::Length(text_section.data() + offset,
+                                 text_section.size() - offset,
+                                 decoder_mode),
+              std::size_t(1));
+        }
+
+        timer.end();
+
+        ConsoleOutput("x86 decoder (length only): ")
+          << std::dec << length_instructions << " instructions in "
+          << timer.difference() << " nanoseconds" << std::endl;
+
+        /* 0x0F right before a page that can't be read */
+        const auto page_size = view_as<std::size_t>(sysconf(_SC_PAGESIZE));
+        const auto pages     = view_as<byte_t*>(::mmap(nullptr,
+                                                   page_size * 2,
+                                                   PROT_READ | PROT_WRITE,
+                                                   MAP_PRIVATE
+                                                     | MAP_ANONYMOUS,
+                                                   -1,
+                                                   0));
+
+        if (pages == MAP_FAILED)
+        {
+            ASURA_EXCEPTION("Couldn't map pages");
+        }
+
+        ::mprotect(pages + page_size, page_size, PROT_NONE);
+        pages[page_size - 1] = 0x0F;
+
+        const auto is_truncated_invalid = not DecoderX86::Decode(
+                                                pages + page_size - 1,
+                                                1,
+                                                decoder_mode)
+                                                .isValid()
+                                          and DecoderX86::Length(
+                                                pages + page_size - 1,
+                                                1,
+                                                decoder_mode)
+                                                == 0;
+
+        ::munmap(pages, page_size * 2);
+
+        if (not listed_instructions.empty() and mismatches == 0
+            and is_truncated_invalid and length_instructions
+                                           == decoded_instructions)
+        {
+            ConsoleOutput("Passed x86 decoder") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass x86 decoder test, ")
+              << mismatches << " mismatches" << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        const auto page_size = MemoryUtils::GetPageSize();
+
+        /**
+         * A read only page of code jumping to one of two functions,
+         * and a few read only pages of virtual tables.
+         */
+        const auto code = view_as<byte_t*>(
+          ::mmap(nullptr,
+                 page_size,
+                 PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1,
+                 0));
+
+        const auto vtables_size = page_size * 4;
+        const auto vtables      = view_as<ptr_t*>(
+          ::mmap(nullptr,
+                 vtables_size,
+                 PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1,
+                 0));
+
+        if (code == MAP_FAILED or vtables == MAP_FAILED)
+        {
+            ASURA_EXCEPTION("Couldn't map hook batch test pages");
+        }
+
+        /* jmp 0x10, 0x10: mov eax, 1; ret, 0x20: mov eax, 2; ret */
+        std::fill_n(code, page_size, 0xCC);
+
+        constexpr byte_t jmp_rel32[] = { 0xE9, 0x0B, 0x00, 0x00, 0x00 };
+        constexpr byte_t return_one[] = {
+            0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3
+        };
+        constexpr byte_t return_two[] = {
+            0xB8, 0x02, 0x00, 0x00, 0x00, 0xC3
+        };
+
+        std::copy(std::begin(jmp_rel32), std::end(jmp_rel32), code);
+        std::copy(std::begin(return_one),
+                  std::end(return_one),
+                  code + 0x10);
+        std::copy(std::begin(return_two),
+                  std::end(return_two),
+                  code + 0x20);
+
+        const auto vfuncs_count = vtables_size / sizeof(ptr_t);
+
+        for (std::size_t i = 0; i < vfuncs_count; i++)
+        {
+            vtables[i] = view_as<ptr_t>(i);
+        }
+
+        mprotect(code, page_size, PROT_READ | PROT_EXEC);
+        mprotect(vtables, vtables_size, PROT_READ);
+
+        HookBatch hook_batch;
+
+        const auto jmp_hook = hook_batch.hookRel32(code, code + 0x20);
+
+        for (std::size_t i = 0; i < vfuncs_count; i++)
+        {
+            hook_batch.hookVFunc(vtables, i, i + page_size);
+        }
+
+        timer.start();
+        hook_batch.apply();
+        timer.end();
+
+        ConsoleOutput("Hook batch applying ")
+          << std::dec << hook_batch.hooks().size() << " hooks took: "
+          << timer.difference() << " nanoseconds" << std::endl;
+
+        const auto call_code = view_as<int (*)()>(code);
+
+        bool hooked = call_code() == 2
+                      and hook_batch.originalTarget(jmp_hook)
+                            == view_as<std::uintptr_t>(code + 0x10);
+
+        for (std::size_t i = 0; i < vfuncs_count; i++)
+        {
+            hooked = hooked
+                     and vtables[i] == view_as<ptr_t>(i + page_size);
+        }
+
+        hook_batch.revert();
+
+        bool reverted = call_code() == 1;
+
+        for (std::size_t i = 0; i < vfuncs_count; i++)
+        {
+            reverted = reverted and vtables[i] == view_as<ptr_t>(i);
+        }
+
+        /* The protections must be the ones from before */
+        const ProcessMemoryMap process_memory_map(ProcessBase::self());
+        const auto& table = process_memory_map.areaTable();
+
+        const auto flags_at = [&table](const auto address)
+        {
+            return table.view(table.search(view_as<std::uintptr_t>(address)))
+              .flags();
+        };
+
+        const auto protected_back = flags_at(code)
+                                      == MemoryArea::ProtectionFlags::RX
+                                    and flags_at(vtables)
+                                          == MemoryArea::ProtectionFlags::R;
+
+        munmap(code, page_size);
+        munmap(vtables, vtables_size);
+
+        if (hooked and reverted and protected_back)
+        {
+            ConsoleOutput("Passed hook batch") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass hook batch test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        /**
+         * A payload importing realpath twice, its default version and
+         * the one kept hidden for older programs, mapped like the
+         * dynamic linker would.
+         */
+        const std::string payload_path = "/tmp/asura_versioned_payload";
+
+        std::ofstream(payload_path + ".c")
+          << "#include <glob.h>\n"
+             "#include <stdlib.h>\n"
+             "__asm__(\".symver realpath_compat, "
+             "realpath@GLIBC_2.2.5\");\n"
+             "extern char* realpath_compat(const char*, char*);\n"
+             "void* asura_realpath(void) { return (void*)&realpath; }\n"
+             "void* asura_realpath_compat(void)\n"
+             "{ return (void*)&realpath_compat; }\n"
+             "void* asura_glob(void) { return (void*)&glob; }\n";
+
+        if (std::system(("cc -shared -fPIC -nostartfiles -o "
+                         + payload_path + ".so " + payload_path
+                         + ".c 2>/dev/null")
+                          .c_str())
+            != 0)
+        {
+            ASURA_EXCEPTION("Couldn't build the versioned payload");
+        }
+
+        const Kokabiel kokabiel(payload_path + ".so");
+        Kokabiel::LocalMapping local_mapping;
+        kokabiel.mapLocal(local_mapping);
+
+        const auto payload_symbols = SymbolTable::FromFile(payload_path
+                                                           + ".so");
+
+        const auto call_payload = [&](const std::string_view name)
+        {
+            return view_as<std::uintptr_t>(
+              view_as<ptr_t (*)()>(payload_symbols.find(name)->value
+                                   + local_mapping.offset_image)());
+        };
+
+        const auto realpath_address = call_payload("asura_realpath");
+        const auto realpath_compat_address = call_payload(
+          "asura_realpath_compat");
+        const auto glob_address = call_payload("asura_glob");
+
+        kokabiel.unmapLocal(local_mapping);
+
+        if (realpath_address
+              == view_as<std::uintptr_t>(dlsym(RTLD_DEFAULT, "realpath"))
+            and realpath_compat_address
+                  == view_as<std::uintptr_t>(
+                    dlvsym(RTLD_DEFAULT, "realpath", "GLIBC_2.2.5"))
+            and realpath_address != realpath_compat_address
+            and glob_address
+                  == view_as<std::uintptr_t>(dlsym(RTLD_DEFAULT, "glob")))
+        {
+            ConsoleOutput("Passed versioned imports") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass versioned imports test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        auto process         = Process::self();
+        const auto page_size = view_as<std::size_t>(sysconf(_SC_PAGESIZE));
+
+        /**
+         * A writable page, a read only one, then a read only shared
+         * file mapping that can never be made writable.
+         */
+        const auto pages = view_as<byte_t*>(::mmap(nullptr,
+                                                   page_size * 3,
+                                                   PROT_READ | PROT_WRITE,
+                                                   MAP_PRIVATE
+                                                     | MAP_ANONYMOUS,
+                                                   -1,
+                                                   0));
+
+        if (pages == MAP_FAILED)
+        {
+            ASURA_EXCEPTION("Couldn't map pages");
+        }
+
+        const std::string file_path = "/tmp/asura_patch_set";
+
+        std::ofstream(file_path, std::ios::binary)
+          .write(std::string(page_size, '\0').data(),
+                 view_as<std::streamsize>(page_size));
+
+        const auto fd = open(file_path.c_str(), O_RDONLY);
+
+        if (fd < 0
+            or ::mmap(pages + page_size * 2,
+                      page_size,
+                      PROT_READ,
+                      MAP_SHARED | MAP_FIXED,
+                      fd,
+                      0)
+                 == MAP_FAILED)
+        {
+            ASURA_EXCEPTION("Couldn't map " + file_path);
+        }
+
+        close(fd);
+        ::mprotect(pages + page_size, page_size, PROT_READ);
+
+        const std::array<byte_t, 4> bytes { 1, 2, 3, 4 };
+
+        PatchSet patch_set(process);
+
+        /* Overlapping patches are refused as a whole */
+        patch_set.add(pages, bytes.data(), bytes.size());
+        patch_set.add(pages + 2, bytes.data(), bytes.size());
+
+        auto is_overlap_rejected = false;
+
+        try
+        {
+            patch_set.apply();
+        }
+        catch (Exception&)
+        {
+            is_overlap_rejected = not patch_set.isApplied()
+                                  and pages[0] == 0;
+        }
+
+        patch_set.clear();
+        patch_set.add(pages + 0x10, bytes.data(), bytes.size());
+        patch_set.add(pages + 0x20, bytes.data(), bytes.size());
+        patch_set.apply();
+
+        const auto is_applied = patch_set.isApplied()
+                                and std::memcmp(pages + 0x10,
+                                                bytes.data(),
+                                                bytes.size())
+                                      == 0
+                                and std::memcmp(pages + 0x20,
+                                                bytes.data(),
+                                                bytes.size())
+                                      == 0;
+
+        patch_set.revert();
+
+        const auto is_reverted = not patch_set.isApplied()
+                                 and pages[0x10] == 0 and pages[0x20] == 0;
+
+        const auto is_read_only = [&](const byte_t* const address)
+        {
+            process.mmap().refresh();
+
+            const auto& table     = process.mmap().areaTable();
+            const auto area_index = table.search(
+              view_as<std::uintptr_t>(address));
+
+            return area_index != MemoryAreaTable::INVALID_INDEX
+                   and table.view(area_index).flags()
+                         == MemoryArea::ProtectionFlags::R;
+        };
+
+        /* Made writable for the patch only */
+        patch_set.clear();
+        patch_set.add(pages + page_size, bytes.data(), bytes.size());
+        patch_set.apply();
+
+        const auto is_read_only_applied = std::memcmp(pages + page_size,
+                                                      bytes.data(),
+                                                      bytes.size())
+                                            == 0
+                                          and is_read_only(pages
+                                                           + page_size);
+
+        patch_set.revert();
+
+        const auto is_read_only_reverted = pages[page_size] == 0
+                                           and is_read_only(pages
+                                                            + page_size);
+
+        /**
+         * The read only page can be made writable but not the file, the
+         * read only page must be read only again afterwards.
+         */
+        patch_set.clear();
+        patch_set.add(pages + page_size, bytes.data(), bytes.size());
+        patch_set.add(pages + page_size * 2, bytes.data(), bytes.size());
+
+        auto is_failure_rolled_back = false;
+
+        try
+        {
+            patch_set.apply();
+        }
+        catch (Exception&)
+        {
+            is_failure_rolled_back = not patch_set.isApplied()
+                                     and is_read_only(pages + page_size)
+                                     and pages[page_size] == 0;
+        }
+
+        ::munmap(pages, page_size * 3);
+        std::filesystem::remove(file_path);
+
+        if (is_overlap_rejected and is_applied and is_reverted
+            and is_read_only_applied and is_read_only_reverted
+            and is_failure_rolled_back)
+        {
+            ConsoleOutput("Passed patch set") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass patch set test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        auto process         = Process::self();
+        const auto page_size = view_as<std::size_t>(sysconf(_SC_PAGESIZE));
+
+        /* Only the first and third pages are ever touched */
+        const auto pages = view_as<byte_t*>(::mmap(nullptr,
+                                                   page_size * 4,
+                                                   PROT_READ | PROT_WRITE,
+                                                   MAP_PRIVATE
+                                                     | MAP_ANONYMOUS,
+                                                   -1,
+                                                   0));
+
+        if (pages == MAP_FAILED)
+        {
+            ASURA_EXCEPTION("Couldn't map pages");
+        }
+
+        std::vector<PatternByte::Value> values;
+
+        for (int i = 0; i < 16; i++)
+        {
+            values.emplace_back(0xA0 + i);
+        }
+
+        for (int i = 0; i < 16; i++)
+        {
+            pages[0x100 + i]                 = view_as<byte_t>(0xA0 + i);
+            pages[page_size * 2 + 0x100 + i] = view_as<byte_t>(0xA0 + i);
+        }
+
+        /**
+         * Its last half is in the fourth page, zeroes that were never
+         * touched.
+         */
+        std::vector<PatternByte::Value> crossing_values;
+
+        for (int i = 0; i < 16; i++)
+        {
+            crossing_values.emplace_back(i < 8 ? 0xB0 + i : 0);
+
+            if (i < 8)
+            {
+                pages[page_size * 3 - 8 + i] = view_as<byte_t>(0xB0 + i);
+            }
+        }
+
+        PatternByte pattern(values);
+        PatternByte crossing_pattern(crossing_values);
+
+        process.mmap().refresh();
+
+        PatternScanning::ResidencyStats residency_stats {};
+        PatternScanning::searchInProcessResident(pattern,
+                                                 process,
+                                                 residency_stats);
+        PatternScanning::searchInProcessResident(crossing_pattern,
+                                                 process,
+                                                 residency_stats);
+
+        const auto matches_inside = [&](PatternByte& patternByte)
+        {
+            std::vector<byte_t*> matches;
+
+            for (const auto match : patternByte.matches())
+            {
+                if (view_as<byte_t*>(match) >= pages
+                    and view_as<byte_t*>(match) < pages + page_size * 4)
+                {
+                    matches.push_back(view_as<byte_t*>(match));
+                }
+            }
+
+            std::sort(matches.begin(), matches.end());
+
+            return matches;
+        };
+
+        const auto found          = matches_inside(pattern);
+        const auto found_crossing = matches_inside(crossing_pattern);
+
+        ::munmap(pages, page_size * 4);
+
+        /* The crossing one is missed, see searchInProcessResident */
+        if (found.size() == 2 and found[0] == pages + 0x100
+            and found[1] == pages + page_size * 2 + 0x100
+            and found_crossing.empty()
+            and residency_stats.skipped_bytes >= page_size * 2)
+        {
+            ConsoleOutput("Passed resident pattern scanning")
+              << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass resident pattern scanning test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        auto process         = Process::self();
+        const auto page_size = view_as<std::size_t>(sysconf(_SC_PAGESIZE));
+        const auto directory = std::filesystem::temp_directory_path()
+                               / "asura_memory_dump";
+
+        /* Data, zeroes, data */
+        const auto pages = view_as<byte_t*>(::mmap(nullptr,
+                                                   page_size * 3,
+                                                   PROT_READ | PROT_WRITE,
+                                                   MAP_PRIVATE
+                                                     | MAP_ANONYMOUS,
+                                                   -1,
+                                                   0));
+
+        if (pages == MAP_FAILED)
+        {
+            ASURA_EXCEPTION("Couldn't map pages");
+        }
+
+        for (std::size_t i = 0; i < page_size; i++)
+        {
+            pages[i] = view_as<byte_t>(i % 7 + 1);
+        }
+
+        std::memset(pages + page_size * 2, 0x41, 0x100);
+
+        const auto pages_address = view_as<std::uintptr_t>(pages);
+
+        process.mmap().refresh();
+
+        /* The pages may have been merged with an area next to them */
+        MemoryDumper::Options options {
+            .thread_count = 2,
+            .chunk_size   = page_size,
+            .filter       = [&](const MemoryAreaTable::View& area)
+            {
+                return area.begin() <= pages_address
+                       and area.end() >= pages_address + page_size * 3;
+            }
+        };
+
+        /* Reads the pages back from a dump */
+        const auto dumped_pages = [&](const bool compress)
+        {
+            options.compress = compress;
+
+            MemoryDumper memory_dumper(process, options);
+            memory_dumper.dump(directory.string());
+
+            if (memory_dumper.entries().size() != 1
+                or memory_dumper.stats().failed_areas != 0
+                or memory_dumper.stats().zero_bytes < page_size
+                or not std::filesystem::exists(
+                  directory / MemoryDumper::INDEX_FILE_NAME))
+            {
+                return bytes_t {};
+            }
+
+            const auto& entry = memory_dumper.entries()[0];
+            const MappedFile data_file(
+              (directory / MemoryDumper::DATA_FILE_NAME).string());
+
+            bytes_t area;
+
+            if (not compress)
+            {
+                const auto data = data_file.at<byte_t>(entry.file_offset,
+                                                       entry.size);
+
+                if (data)
+                {
+                    area.assign(data, data + entry.size);
+                }
+            }
+            else
+            {
+                auto offset = entry.file_offset;
+
+                while (area.size() < entry.size)
+                {
+                    const auto header = data_file.at<
+                      MemoryDumper::ChunkHeader>(offset);
+
+                    if (not header)
+                    {
+                        return bytes_t {};
+                    }
+
+                    offset += sizeof(MemoryDumper::ChunkHeader);
+
+                    const auto stored = data_file.at<byte_t>(
+                      offset,
+                      header->stored_size);
+
+                    if (header->stored_size == 0)
+                    {
+                        area.resize(area.size() + header->raw_size);
+                    }
+                    else if (header->stored_size == header->raw_size)
+                    {
+                        area.insert(area.end(),
+                                    stored,
+                                    stored + header->raw_size);
+                    }
+                    else
+                    {
+                        const auto decoded = XKC<byte_t>::decode(
+                          bytes_t(stored, stored + header->stored_size));
+
+                        area.insert(area.end(),
+                                    decoded.begin(),
+                                    decoded.begin() + header->raw_size);
+                    }
+
+                    offset += header->stored_size;
+                }
+            }
+
+            const auto pages_offset = pages_address - entry.address;
+
+            if (area.size() < pages_offset + page_size * 3)
+            {
+                return bytes_t {};
+            }
+
+            return bytes_t(area.begin()
+                             + view_as<std::ptrdiff_t>(pages_offset),
+                           area.begin()
+                             + view_as<std::ptrdiff_t>(pages_offset
+                                                       + page_size * 3));
+        };
+
+        const auto sparse_pages     = dumped_pages(false);
+        const auto compressed_pages = dumped_pages(true);
+        const bytes_t expected_pages(pages, pages + page_size * 3);
+
+        ::munmap(pages, page_size * 3);
+        std::filesystem::remove_all(directory);
+
+        if (sparse_pages == expected_pages
+            and compressed_pages == expected_pages)
+        {
+            ConsoleOutput("Passed memory dumper") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass memory dumper test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+    try
+    {
+        /* One producer, one consumer, through a queue smaller than them */
+        constexpr std::size_t element_count = 100000;
+        LockFreeQueue<std::size_t, 0x10> queue;
+
+        bool is_bounded = true;
+
+        for (std::size_t i = 0; i < 0x10; i++)
+        {
+            is_bounded = is_bounded and queue.push(i);
+        }
+
+        std::size_t element;
+        is_bounded = is_bounded and not queue.push(0x10)
+                     and queue.size() == 0x10;
+
+        while (queue.pop(element))
+        {
+        }
+
+        std::thread producer(
+          [&]()
+          {
+              for (std::size_t i = 0; i < element_count;)
+              {
+                  if (queue.push(i))
+                  {
+                      i++;
+                  }
+              }
+          });
+
+        bool is_ordered = true;
+
+        for (std::size_t i = 0; i < element_count;)
+        {
+            if (queue.pop(element))
+            {
+                is_ordered = is_ordered and element == i;
+                i++;
+            }
+        }
+
+        producer.join();
+
+        std::array<std::uint64_t, 0x20> values {};
+        std::atomic_uint64_t far_value {};
+
+        WatchList watch_list(Process::self());
+
+        watch_list.add<std::uint64_t>(&values[0]);
+        const auto second_id = watch_list.add<std::uint64_t>(&values[2]);
+        const auto far_id    = watch_list.add<std::uint64_t>(&far_value);
+
+        WatchList::Event event;
+
+        const auto polled = [&]()
+        {
+            std::vector<std::pair<WatchList::watch_id_t, std::uint64_t>>
+              events;
+
+            while (watch_list.poll(event))
+            {
+                events.emplace_back(event.id, event.as<std::uint64_t>());
+            }
+
+            return events;
+        };
+
+        /* Everything is sent the first time, then only what changed */
+        watch_list.tick();
+        const auto primed_events = polled();
+
+        values[2] = 0x1337;
+        watch_list.tick();
+        const auto changed_events = polled();
+
+        watch_list.tick();
+        const auto unchanged_events = polled();
+
+        watch_list.start(std::chrono::milliseconds(1));
+        far_value = 0xDEAD;
+
+        bool is_far_seen = false;
+
+        for (int i = 0; i < 1000 and not is_far_seen; i++)
+        {
+            while (watch_list.poll(event))
+            {
+                is_far_seen = is_far_seen
+                              or (event.id == far_id
+                                  and event.as<std::uint64_t>() == 0xDEAD);
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        watch_list.stop();
+
+        if (is_bounded and is_ordered and primed_events.size() == 3
+            and changed_events.size() == 1
+            and changed_events[0].first == second_id
+            and changed_events[0].second == 0x1337
+            and unchanged_events.empty() and is_far_seen
+            and watch_list.stats().ticks >= 3)
+        {
+            ConsoleOutput("Passed watch list") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass watch list test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+
+    try
+    {
+        MemoryAreaTable table;
+        std::size_t max_names = 0;
+        bool is_named         = true;
+
+        /* Every refresh maps new files, only the stack stays */
+        for (std::size_t refresh = 0; refresh < 100; refresh++)
+        {
+            table.clear();
+
+            for (std::size_t i = 0; i < 10; i++)
+            {
+                table.push(0x10000 * (i + 1),
+                           0x10000 * (i + 1) + 0x1000,
+                           MemoryArea::ProtectionFlags::R,
+                           "/tmp/churn_" + std::to_string(refresh * 10 + i));
+            }
+
+            table.push(0x10000000,
+                       0x10001000,
+                       MemoryArea::ProtectionFlags::R,
+                       "[stack]");
+
+            table.compactNames();
+
+            max_names = std::max(max_names, table.names().size());
+
+            for (const auto area : table)
+            {
+                const auto expected_name = area.index() < 10 ?
+                                             "/tmp/churn_"
+                                               + std::to_string(
+                                                 refresh * 10
+                                                 + area.index()) :
+                                             std::string("[stack]");
+
+                is_named = is_named and area.name() == expected_name
+                           and table.names().find(expected_name)
+                                 == area.nameID();
+            }
+        }
+
+        if (max_names <= 2 * 11 and is_named)
+        {
+            ConsoleOutput("Passed area table names") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass area table names test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+
+#ifndef WINDOWS
+    try
+    {
+        using namespace PE::IMAGE;
+
+        write_pe_exports("/tmp/asura_export_index.dll",
+                         { { "Alpha", "" },
+                           { "Beta", "ASURA_TARGET.Target" },
+                           { "Gamma", "" },
+                           { "Zeta", "" } });
+
+        const MappedFile exports_file("/tmp/asura_export_index.dll");
+
+        const auto dos_header = view_as<const DOS_HEADER*>(
+          exports_file.data());
+        const auto nt_headers = view_as<const NT_HEADERS<std::uint64_t>*>(
+          exports_file.data() + dos_header->e_lfanew);
+
+        std::size_t forwarded_count = 0;
+
+        const PE::forwarded_handler_t handle_forwarded =
+          [&](const std::string& moduleName, const std::string& funcName)
+        {
+            forwarded_count++;
+
+            return moduleName == "ASURA_TARGET." and funcName == "Target" ?
+                     module_sym_t { 0x7000, 0x7123 } :
+                     module_sym_t { 0, 0 };
+        };
+
+        auto export_index = nt_headers->build_export_index<true>(
+          dos_header);
+
+        const std::vector<std::string> func_names {
+            "Alpha", "Beta", "Gamma", "Zeta", "1", "2", "4", "5", "Delta"
+        };
+
+        /* Same answers as going through the export directory */
+        bool is_same = export_index.size() == 4
+                       and export_index.names().size() == 4
+                       and export_index.ordinalBase() == 1;
+
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (const auto& func_name : func_names)
+            {
+                is_same = is_same
+                          and export_index.find(func_name,
+                                                0x10000,
+                                                handle_forwarded)
+                                == nt_headers->find_exported_function<true>(
+                                  dos_header,
+                                  func_name,
+                                  std::uintptr_t { 0x10000 },
+                                  handle_forwarded);
+            }
+        }
+
+        /* Twice by name and ordinal for each pass, the index only once */
+        const auto is_forward_kept = forwarded_count == 4 + 1;
+
+        const auto is_found = export_index.find("Gamma",
+                                                0x10000,
+                                                handle_forwarded)
+                                == module_sym_t { 0x10000, 0x11020 }
+                              and export_index.find("2",
+                                                    0x10000,
+                                                    handle_forwarded)
+                                    == module_sym_t { 0x7000, 0x7123 };
+
+        std::filesystem::remove("/tmp/asura_export_index.dll");
+
+        if (is_same and is_forward_kept and is_found)
+        {
+            ConsoleOutput("Passed export index") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass export index test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        const auto state_of = [](const process_id_t pid)
+        {
+            std::ifstream stat_file("/proc/" + std::to_string(pid)
+                                    + "/stat");
+            std::string stat;
+            std::getline(stat_file, stat);
+
+            const auto name_end = stat.rfind(')');
+
+            return name_end == std::string::npos
+                       or name_end + 2 >= stat.size() ?
+                     '\0' :
+                     stat[name_end + 2];
+        };
+
+        /* One already stopped by someone else, one running */
+        std::array<process_id_t, 2> child_pids {};
+
+        for (auto&& child_pid : child_pids)
+        {
+            child_pid = fork();
+
+            if (child_pid == 0)
+            {
+                while (true)
+                {
+                    pause();
+                }
+            }
+        }
+
+        kill(child_pids[0], SIGSTOP);
+        waitpid(child_pids[0], nullptr, WUNTRACED);
+
+        std::array<char, 2> states {};
+
+        for (std::size_t i = 0; i < child_pids.size(); i++)
+        {
+            Process child(child_pids[i]);
+            child.mmap().refresh();
+
+            const Snapshot snapshot(child, Snapshot::CaptureMode::Frozen);
+
+            states[i] = state_of(child_pids[i]);
+        }
+
+        for (const auto child_pid : child_pids)
+        {
+            kill(child_pid, SIGKILL);
+            waitpid(child_pid, nullptr, 0);
+        }
+
+        if (states[0] == 'T' and states[1] != 'T' and states[1] != '\0')
+        {
+            ConsoleOutput("Passed frozen snapshot") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass frozen snapshot test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        const auto page_size = MemoryUtils::GetPageSize();
+        const auto pages     = view_as<byte_t*>(::mmap(nullptr,
+                                                   page_size * 4,
+                                                   PROT_READ | PROT_WRITE,
+                                                   MAP_PRIVATE
+                                                     | MAP_ANONYMOUS,
+                                                   -1,
+                                                   0));
+
+        if (pages == MAP_FAILED)
+        {
+            ASURA_EXCEPTION("Couldn't map the pages");
+        }
+
+        for (std::size_t i = 0; i < page_size * 4; i++)
+        {
+            pages[i] = view_as<byte_t>(i);
+        }
+
+        auto process = Process::self();
+        process.mmap().refresh();
+
+        const auto only_pages = [&](const MemoryAreaTable::View& area)
+        {
+            return area.begin() == view_as<std::uintptr_t>(pages);
+        };
+
+        const Snapshot snapshot(process,
+                                Snapshot::CaptureMode::Live,
+                                only_pages);
+
+        /* Two bytes next to each other, one page after and the last */
+        pages[0x10]++;
+        pages[0x11]++;
+        pages[page_size * 2 + 5]++;
+        pages[page_size * 4 - 1]++;
+
+        const auto changes = snapshot.diffLive();
+
+        const Snapshot later_snapshot(process,
+                                      Snapshot::CaptureMode::Live,
+                                      only_pages);
+
+        const auto address = [&](const std::size_t offset)
+        {
+            return view_as<std::uintptr_t>(pages) + offset;
+        };
+
+        const auto later_changes = snapshot.diff(later_snapshot);
+
+        const auto is_diffed = changes.size() == 3
+                               and changes[0].address == address(0x10)
+                               and changes[0].size == 2
+                               and changes[1].address
+                                     == address(page_size * 2 + 5)
+                               and changes[1].size == 1
+                               and changes[2].address
+                                     == address(page_size * 4 - 1)
+                               and changes[2].size == 1
+                               and later_changes.size() == 3;
+
+        const auto is_captured = snapshot.regions().size() == 1
+                                 and snapshot.regions()[0].captured
+                                 and snapshot.regionData(
+                                       snapshot.regions()[0])[0x10]
+                                       == 0x10;
+
+        ::munmap(pages, page_size * 4);
+
+        if (is_diffed and is_captured)
+        {
+            ConsoleOutput("Passed live snapshot") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass live snapshot test") << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
+#ifndef WINDOWS
+    try
+    {
+        const auto page_size = MemoryUtils::GetPageSize();
+        const auto pages     = view_as<byte_t*>(::mmap(nullptr,
+                                                   page_size * 8,
+                                                   PROT_READ | PROT_WRITE,
+                                                   MAP_PRIVATE
+                                                     | MAP_ANONYMOUS,
+                                                   -1,
+                                                   0));
+
+        if (pages == MAP_FAILED)
+        {
+            ASURA_EXCEPTION("Couldn't map the pages");
+        }
+
+        /* Freshly written pages are soft-dirty if the kernel tracks it */
+        bool is_soft_dirty = false;
+
+        pages[0] = 1;
+
+        const auto pagemap_fd = ::open("/proc/self/pagemap", O_RDONLY);
+
+        if (pagemap_fd >= 0)
+        {
+            std::uint64_t entry = 0;
+
+            is_soft_dirty = ::pread(pagemap_fd,
+                                    &entry,
+                                    sizeof(entry),
+                                    view_as<off_t>(
+                                      view_as<std::uintptr_t>(pages)
+                                      / page_size * sizeof(entry)))
+                              == sizeof(entry)
+                            and (entry & (std::uint64_t { 1 } << 55));
+
+            ::close(pagemap_fd);
+        }
+
+        const auto counter1 = view_as<volatile std::uint64_t*>(pages);
+        const auto counter2 = view_as<volatile std::uint64_t*>(
+          pages + page_size * 4);
+
+        /* Keeps writing two pages, the second lagging one step behind */
+        const auto child_pid = fork();
+
+        if (child_pid == 0)
+        {
+            while (true)
+            {
+                const auto value = *counter1 + 1;
+                *counter1        = value;
+                *counter2        = value;
+            }
+        }
+
+        Process child(child_pid);
+        child.mmap().refresh();
+
+        const Snapshot snapshot(
+          child,
+          Snapshot::CaptureMode::Frozen,
+          [&](const MemoryAreaTable::View& area)
+          {
+              return area.begin() == view_as<std::uintptr_t>(pages);
+          });
+
+        kill(child_pid, SIGKILL);
+        waitpid(child_pid, nullptr, 0);
+
+        const auto& stats = snapshot.stats();
+        const auto data   = snapshot.regionData(snapshot.regions()[0]);
+
+        std::uint64_t value1 {}, value2 {};
+        std::memcpy(&value1, data, sizeof(value1));
+        std::memcpy(&value2, data + page_size * 4, sizeof(value2));
+
+        /* Both counters copied at the same time, while it was stopped */
+        const auto is_consistent = value1 == value2
+                                   or value1 == value2 + 1;
+
+        /* Only the two written pages are copied again */
+        const auto is_recopied = is_soft_dirty ?
+                                   stats.recopied_bytes <= page_size * 2 :
+                                   stats.recopied_bytes
+                                     == stats.total_bytes;
+
+        ::munmap(pages, page_size * 8);
+
+        if (is_consistent and is_recopied)
+        {
+            ConsoleOutput("Passed soft-dirty snapshot") << std::endl;
+        }
+        else
+        {
+            ConsoleOutput("Didn't pass soft-dirty snapshot test")
+              << std::endl;
+        }
+    }
+    catch (Exception& e)
+    {
+        std::cout << e.msg() << std::endl;
+    }
+#endif
+
     // std::getchar();
 }
 
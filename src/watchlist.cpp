@@ -0,0 +1,348 @@
+#include "pch.h"
+
+#include "exception.h"
+#include "watchlist.h"
+
+using namespace Asura;
+
+WatchList::WatchList(const ProcessBase& process)
+ : _process_base(process)
+{
+    _latencies.reserve(LATENCY_HISTORY_SIZE);
+}
+
+WatchList::~WatchList()
+{
+    stop();
+}
+
+auto WatchList::isRunning() const -> bool
+{
+    return _running;
+}
+
+auto WatchList::stats() const -> Stats
+{
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+
+    auto stats = _stats;
+
+    if (not _latencies.empty())
+    {
+        auto latencies = _latencies;
+
+        const auto percentile = [&](const std::size_t percent)
+        {
+            const auto nth = latencies.begin()
+                             + view_as<std::ptrdiff_t>(
+                               (latencies.size() - 1) * percent / 100);
+
+            std::nth_element(latencies.begin(), nth, latencies.end());
+
+            return *nth;
+        };
+
+        stats.p50_ns  = percentile(50);
+        stats.p99_ns  = percentile(99);
+        stats.mean_ns = _total_ns / _stats.ticks;
+    }
+
+    return stats;
+}
+
+auto WatchList::add(const std::uintptr_t address, const std::size_t size)
+  -> watch_id_t
+{
+    if (_running)
+    {
+        ASURA_EXCEPTION("Can't add a location while running");
+    }
+
+    if (size == 0 or size > MAX_VALUE_SIZE)
+    {
+        ASURA_EXCEPTION("Invalid size for a watch: "
+                        + std::to_string(size));
+    }
+
+    _locations.push_back(
+      { .address = address, .size = size, .offset = 0 });
+    _dirty = true;
+
+    return _locations.size() - 1;
+}
+
+auto WatchList::clear() -> void
+{
+    if (_running)
+    {
+        ASURA_EXCEPTION("Can't clear locations while running");
+    }
+
+    _locations.clear();
+    _dirty = true;
+}
+
+auto WatchList::start(const std::chrono::nanoseconds interval) -> void
+{
+    if (_running)
+    {
+        ASURA_EXCEPTION("Watch list is already running");
+    }
+
+    if (_dirty)
+    {
+        rebuild();
+    }
+
+    _running = true;
+
+    _thread = std::thread(
+      [this, interval]()
+      {
+          auto next_tick = std::chrono::steady_clock::now();
+
+          while (_running)
+          {
+              update();
+
+              next_tick += interval;
+
+              const auto now = std::chrono::steady_clock::now();
+
+              /* Don't try to catch up when we're late */
+              if (next_tick < now)
+              {
+                  next_tick = now;
+              }
+
+              std::this_thread::sleep_until(next_tick);
+          }
+      });
+}
+
+auto WatchList::stop() -> void
+{
+    _running = false;
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+auto WatchList::tick() -> void
+{
+    if (_running)
+    {
+        ASURA_EXCEPTION("Watch list is already polled by its thread");
+    }
+
+    if (_dirty)
+    {
+        rebuild();
+    }
+
+    update();
+}
+
+auto WatchList::poll(Event& event) -> bool
+{
+    return _events.pop(event);
+}
+
+auto WatchList::rebuild() -> void
+{
+    _sorted_ids.resize(_locations.size());
+    std::iota(_sorted_ids.begin(), _sorted_ids.end(), 0);
+
+    std::sort(_sorted_ids.begin(),
+              _sorted_ids.end(),
+              [&](const watch_id_t lhs, const watch_id_t rhs)
+              {
+                  return _locations[lhs].address
+                         < _locations[rhs].address;
+              });
+
+    struct Span
+    {
+        std::uintptr_t begin;
+        std::uintptr_t end;
+        std::size_t offset;
+    };
+
+    std::vector<Span> spans;
+    std::size_t buffer_size = 0;
+
+    /* Merge the locations close enough, they may also overlap */
+    for (const auto id : _sorted_ids)
+    {
+        auto& location     = _locations[id];
+        const auto loc_end = location.address + location.size;
+
+        if (spans.empty()
+            or location.address > spans.back().end + COALESCE_GAP)
+        {
+            spans.push_back({ .begin  = location.address,
+                              .end    = loc_end,
+                              .offset = buffer_size });
+        }
+        else if (loc_end > spans.back().end)
+        {
+            spans.back().end = loc_end;
+        }
+
+        buffer_size = spans.back().offset + spans.back().end
+                      - spans.back().begin;
+
+        location.offset = spans.back().offset
+                          + (location.address - spans.back().begin);
+    }
+
+    for (std::size_t i = 0; i < _buffers.size(); i++)
+    {
+        _buffers[i].assign(buffer_size, 0);
+        _transfers[i].clear();
+
+        for (const auto& span : spans)
+        {
+            _transfers[i].push_back(
+              { .local  = _buffers[i].data() + span.offset,
+                .remote = span.begin,
+                .size   = span.end - span.begin });
+        }
+    }
+
+    _current = 0;
+    _primed  = false;
+    _dirty   = false;
+}
+
+auto WatchList::update() -> void
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto& current  = _buffers[_current];
+    const auto& previous = _buffers[_current ^ 1];
+
+    try
+    {
+        MemoryUtils::ReadProcessMemoryAreas(_process_base.id(),
+                                            _transfers[_current]);
+    }
+    catch (Exception&)
+    {
+        std::lock_guard<std::mutex> lock(_stats_mutex);
+        _stats.failed_ticks++;
+
+        return;
+    }
+
+    _tick++;
+
+    const auto send = [&](const watch_id_t id)
+    {
+        const auto& location = _locations[id];
+
+        Event event { .id    = id,
+                      .tick  = _tick,
+                      .size  = location.size,
+                      .value = {} };
+
+        std::memcpy(event.value.data(),
+                    current.data() + location.offset,
+                    location.size);
+
+        if (not _events.push(event))
+        {
+            std::lock_guard<std::mutex> lock(_stats_mutex);
+            _stats.dropped_events++;
+        }
+    };
+
+    if (not _primed)
+    {
+        /* Nothing to compare to, everything is new */
+        for (const auto id : _sorted_ids)
+        {
+            send(id);
+        }
+
+        _primed = true;
+    }
+    else
+    {
+        _changes.clear();
+
+        Snapshot::Diff(previous.data(),
+                       current.data(),
+                       current.size(),
+                       0,
+                       _changes);
+
+        /**
+         * Both are sorted by offset, a change that ends before a
+         * location ends before all the next ones.
+         */
+        std::size_t change_index = 0;
+
+        for (const auto id : _sorted_ids)
+        {
+            const auto& location = _locations[id];
+
+            while (change_index < _changes.size()
+                   and _changes[change_index].address
+                           + _changes[change_index].size
+                         <= location.offset)
+            {
+                change_index++;
+            }
+
+            if (change_index == _changes.size())
+            {
+                break;
+            }
+
+            if (_changes[change_index].address
+                < location.offset + location.size)
+            {
+                send(id);
+            }
+        }
+    }
+
+    _current ^= 1;
+
+    recordLatency(view_as<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start)
+        .count()));
+}
+
+auto WatchList::recordLatency(const std::uint64_t latency) -> void
+{
+    std::lock_guard<std::mutex> lock(_stats_mutex);
+
+    if (_stats.ticks == 0 or latency < _stats.min_ns)
+    {
+        _stats.min_ns = latency;
+    }
+
+    if (latency > _stats.max_ns)
+    {
+        _stats.max_ns = latency;
+    }
+
+    _stats.last_ns = latency;
+    _total_ns += latency;
+
+    if (_latencies.size() < LATENCY_HISTORY_SIZE)
+    {
+        _latencies.push_back(latency);
+    }
+    else
+    {
+        _latencies[_stats.ticks % LATENCY_HISTORY_SIZE] = latency;
+    }
+
+    _stats.ticks++;
+}
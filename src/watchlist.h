@@ -0,0 +1,144 @@
+#ifndef ASURA_WATCHLIST_H
+#define ASURA_WATCHLIST_H
+
+#include "lockfreequeue.h"
+#include "memoryutils.h"
+#include "processbase.h"
+#include "snapshot.h"
+
+namespace Asura
+{
+    /**
+     * Watches locations of a process memory at a fixed rate.
+     * Close locations are read together, each tick is one vectored read
+     * and only the locations that changed are sent to the consumer.
+     */
+    class WatchList
+    {
+      public:
+        using watch_id_t = std::size_t;
+
+        static constexpr inline std::size_t MAX_VALUE_SIZE = 0x40;
+        static constexpr inline std::size_t EVENTS_QUEUE_SIZE = 0x1000;
+        static constexpr inline std::size_t LATENCY_HISTORY_SIZE = 0x400;
+        /* Locations closer than this are read with the same iovec */
+        static constexpr inline std::size_t COALESCE_GAP = 0x40;
+
+        struct Event
+        {
+            template <typename T>
+            auto as() const -> T
+            {
+                static_assert(sizeof(T) <= MAX_VALUE_SIZE,
+                              "Type too big for a watch");
+
+                T value;
+                std::memcpy(&value, this->value.data(), sizeof(T));
+
+                return value;
+            }
+
+            watch_id_t id;
+            std::uint64_t tick;
+            std::size_t size;
+            std::array<byte_t, MAX_VALUE_SIZE> value;
+        };
+
+        struct Stats
+        {
+            std::uint64_t ticks;
+            std::uint64_t failed_ticks;
+            std::uint64_t dropped_events;
+            /* Read and compare time of the ticks */
+            std::uint64_t last_ns;
+            std::uint64_t min_ns;
+            std::uint64_t max_ns;
+            std::uint64_t mean_ns;
+            /* Over the last LATENCY_HISTORY_SIZE ticks */
+            std::uint64_t p50_ns;
+            std::uint64_t p99_ns;
+        };
+
+      private:
+        struct Location
+        {
+            std::uintptr_t address;
+            std::size_t size;
+            /* Offset inside the read buffers */
+            std::size_t offset;
+        };
+
+      public:
+        explicit WatchList(const ProcessBase& process);
+        ~WatchList();
+
+        WatchList(const WatchList&)                    = delete;
+        auto operator=(const WatchList&) -> WatchList& = delete;
+
+      public:
+        auto isRunning() const -> bool;
+        auto stats() const -> Stats;
+
+      public:
+        /**
+         * Locations can only be changed while the watch list isn't
+         * running.
+         */
+        auto add(const std::uintptr_t address, const std::size_t size)
+          -> watch_id_t;
+        auto clear() -> void;
+
+        /* Polls at a fixed interval on a dedicated thread */
+        auto start(const std::chrono::nanoseconds interval) -> void;
+        auto stop() -> void;
+
+        /* Polls once on the calling thread, when not running */
+        auto tick() -> void;
+
+        /* Consumer side, returns false when there's no changes left */
+        auto poll(Event& event) -> bool;
+
+        template <typename T>
+        auto add(const auto address) -> watch_id_t
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "Type must be trivially copyable");
+            static_assert(sizeof(T) <= MAX_VALUE_SIZE,
+                          "Type too big for a watch");
+
+            return add(view_as<std::uintptr_t>(address), sizeof(T));
+        }
+
+      private:
+        auto rebuild() -> void;
+        auto update() -> void;
+        auto recordLatency(const std::uint64_t latency) -> void;
+
+      private:
+        ProcessBase _process_base;
+        std::vector<Location> _locations;
+        /* Locations ids sorted by their offsets */
+        std::vector<watch_id_t> _sorted_ids;
+        bool _dirty {};
+        bool _primed {};
+        std::uint64_t _tick {};
+
+        /* Two buffers, the current one and the previous one */
+        std::array<bytes_t, 2> _buffers;
+        std::array<MemoryUtils::transfers_t, 2> _transfers;
+        std::size_t _current {};
+        Snapshot::changes_t _changes;
+
+        std::thread _thread;
+        std::atomic_bool _running {};
+
+        LockFreeQueue<Event, EVENTS_QUEUE_SIZE> _events;
+
+        mutable std::mutex _stats_mutex;
+        Stats _stats {};
+        std::uint64_t _total_ns {};
+        std::vector<std::uint64_t> _latencies;
+    };
+}
+
+#endif